@@ -246,6 +246,10 @@ struct rtgui_blit_info
     rt_uint8_t src_fmt;
     rt_uint8_t dst_fmt;
     rt_uint8_t r, g, b, a;
+
+    /* dithering mode and the device position of the first dst pixel */
+    rt_uint8_t dither;
+    int dither_x, dither_y;
 };
 
 struct rtgui_image_info
@@ -258,6 +262,8 @@ struct rtgui_image_info
 };
 
 extern const rt_uint8_t* rtgui_blit_expand_byte[9];
+/* the thresholds of ordered dithering, 0 ~ 15 */
+extern const rt_uint8_t rtgui_blit_dither_bayer[4][4];
 
 typedef void (*rtgui_blit_line_func)(rt_uint8_t *dst, rt_uint8_t *src, int line);
 rtgui_blit_line_func rtgui_blit_line_get(int dst_bpp, int src_bpp);
@@ -265,6 +271,8 @@ rtgui_blit_line_func rtgui_blit_line_get_inv(int dst_bpp, int src_bpp);
 
 void rtgui_blit(struct rtgui_blit_info * info);
 void rtgui_image_info_blit(struct rtgui_image_info* image, struct rtgui_dc* dc, struct rtgui_rect *dc_rect);
+/* blit to the buffer dc at (x, y), the dst of @info except the size is filled from the dc */
+void rtgui_dc_buffer_blit_info(struct rtgui_dc *dc, int x, int y, struct rtgui_blit_info *info);
 
 #ifdef __cplusplus
 }
@@ -184,6 +184,12 @@ rt_inline rtgui_color_t rtgui_color_from_888(rt_uint32_t pixel)
     return color;
 }
 
+/*
+ * The 8 bits paletted format. It's not a format of graphic device, only the
+ * buffer dc uses it, as well as the MONO (1 bit) and GRAY16 (4 bits) format.
+ */
+#define RTGUI_PIXEL_FORMAT_PAL8     0x80
+
 /* get the bits of specified pixle format */
 rt_uint8_t rtgui_color_get_bits(rt_uint8_t pixel_format) RTGUI_PURE;
 /* get the bytes of specified pixle format */
@@ -78,6 +78,25 @@ struct rtgui_dc
 
     /* dc engine */
     const struct rtgui_dc_engine *engine;
+
+    /* the top scissor, RT_NULL if there is no scissor */
+    struct rtgui_dc_scissor *scissor;
+};
+
+/*
+ * The scissor of dc
+ *
+ * A scissor limits the drawing on dc to a rect in logic coordinates, besides
+ * the clip of dc. The rect of a pushed scissor is intersected with the outer
+ * scissor, so the engines only check the rect on top before the clip region.
+ *
+ * The scissor is owned by the caller, normally on the stack of the drawing
+ * code, and it should be popped before the drawing is ended.
+ */
+struct rtgui_dc_scissor
+{
+    rtgui_rect_t rect;
+    struct rtgui_dc_scissor *next;
 };
 
 /*
@@ -95,6 +114,29 @@ struct rtgui_dc_hw
     const struct rtgui_graphic_driver *hw_driver;
 };
 
+/*
+ * The palette of indexed buffer dc (MONO, GRAY16 and PAL8 format).
+ *
+ * The pixels of MONO and GRAY16 are packed from the most significant bits
+ * of a byte. The palette keeps a lookup table of the colors converted to the
+ * pixel format of the blit destination, it's rebuilt only when the palette or
+ * the destination format changes.
+ */
+struct rtgui_dc_palette
+{
+    rt_uint16_t ncolors;
+    rtgui_color_t *colors;
+
+    /* colors in the pixel format of blit destination */
+    rt_uint8_t lut_format;
+    rt_bool_t lut_valid;
+    rt_uint32_t *lut;
+
+    /* the last drawing color and its index */
+    rtgui_color_t last_color;
+    rt_uint8_t last_index;
+};
+
 /**
  * The buffer dc is a device context with memory buffer.
  *
@@ -111,6 +153,9 @@ struct rtgui_dc_buffer
     rt_uint8_t pixel_format;
     rt_uint8_t blend_mode;		/* RTGUI_BLENDMODE: None/Blend/Add/Mod */
 
+    /* palette of indexed format, RT_NULL for the others */
+    struct rtgui_dc_palette *palette;
+
     /* width and height */
     rt_uint16_t width, height;
     /* pitch */
@@ -131,10 +176,16 @@ struct rtgui_dc_buffer
 #define RTGUI_DC_BC(dc)         (rtgui_dc_get_gc(RTGUI_DC(dc))->background)
 #define RTGUI_DC_FONT(dc)       (rtgui_dc_get_gc(RTGUI_DC(dc))->font)
 #define RTGUI_DC_TEXTALIGN(dc)  (rtgui_dc_get_gc(RTGUI_DC(dc))->textalign)
+#define RTGUI_DC_DITHER(dc)     (rtgui_dc_get_gc(RTGUI_DC(dc))->dither)
 
 /* create a buffer dc */
 struct rtgui_dc *rtgui_dc_buffer_create(int width, int height);
 struct rtgui_dc *rtgui_dc_buffer_create_pixformat(rt_uint8_t pixel_format, int w, int h);
+/* set the colors of indexed buffer dc from the @first entry */
+rt_err_t rtgui_dc_buffer_set_palette(struct rtgui_dc *dc, const rtgui_color_t *colors,
+                                     int first, int count);
+/* get the palette color of a pixel of indexed buffer dc */
+rtgui_color_t rtgui_dc_buffer_get_color(struct rtgui_dc *dc, int x, int y);
 #ifdef GUIENGINE_IMAGE_CONTAINER
 struct rtgui_dc *rtgui_img_dc_create_pixformat(rt_uint8_t pixel_format, rt_uint8_t *pixel, 
     struct rtgui_image_item *image_item);
@@ -170,6 +221,7 @@ void rtgui_dc_fill_round_rect(struct rtgui_dc *dc, struct rtgui_rect *rect, int
 void rtgui_dc_fill_gradient_rectv(struct rtgui_dc *dc, rtgui_rect_t *rect,
                                   rtgui_color_t c1, rtgui_color_t c2);
 void rtgui_dc_draw_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end);
+void rtgui_dc_fill_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end);
 void rtgui_dc_draw_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end);
 void rtgui_dc_fill_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end);
 
@@ -211,7 +263,41 @@ void rtgui_dc_blend_fill_rects(struct rtgui_dc * dst,const rtgui_rect_t * rects,
 
 void rtgui_dc_draw_aa_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r);
 void rtgui_dc_draw_aa_ellipse(struct rtgui_dc *dc, rt_int16_t  x, rt_int16_t y, rt_int16_t rx, rt_int16_t ry);
+void rtgui_dc_draw_aa_arc(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end);
+void rtgui_dc_fill_aa_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end);
+void rtgui_dc_fill_aa_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end);
+
+/* stroke functions */
+enum rtgui_line_join
+{
+    RTGUI_JOIN_MITER,
+    RTGUI_JOIN_ROUND,
+    RTGUI_JOIN_BEVEL,
+};
+
+enum rtgui_line_cap
+{
+    RTGUI_CAP_BUTT,
+    RTGUI_CAP_ROUND,
+    RTGUI_CAP_SQUARE,
+};
+
+struct rtgui_stroke
+{
+    rt_uint8_t width;
+    rt_uint8_t join;            /* RTGUI_JOIN_* */
+    rt_uint8_t cap;             /* RTGUI_CAP_* */
+    rt_uint8_t aa;              /* anti-aliased edges */
+
+    /* on/off length of dash in pixels, RT_NULL for solid line */
+    const rt_uint16_t *dash;
+    rt_uint16_t dash_count;
+    rt_uint16_t dash_offset;
+};
 
+void rtgui_stroke_init(struct rtgui_stroke *stroke, rt_uint8_t width);
+int rtgui_dc_draw_stroke(struct rtgui_dc *dc, const struct rtgui_point *points, int count,
+                         const struct rtgui_stroke *stroke);
 int rtgui_dc_draw_thick_line(struct rtgui_dc * dst, rt_int16_t x1, rt_int16_t y1, rt_int16_t x2, rt_int16_t y2, rt_uint8_t width);
 
 /*
@@ -269,6 +355,18 @@ rt_inline void rtgui_dc_blit(struct rtgui_dc *dc, struct rtgui_point *dc_point,
     dc->engine->blit(dc, dc_point, dest, rect);
 }
 
+/*
+ * get the rect of the top scissor, RT_NULL if there is no scissor
+ */
+rt_inline rtgui_rect_t *rtgui_dc_get_scissor(struct rtgui_dc *dc)
+{
+    return dc->scissor != RT_NULL ? &(dc->scissor->rect) : RT_NULL;
+}
+
+/* push and pop the scissor of dc */
+void rtgui_dc_push_scissor(struct rtgui_dc *dc, struct rtgui_dc_scissor *scissor, const rtgui_rect_t *rect);
+void rtgui_dc_pop_scissor(struct rtgui_dc *dc);
+
 /* set gc of dc */
 void rtgui_dc_set_gc(struct rtgui_dc *dc, rtgui_gc_t *gc);
 /* get gc of dc */
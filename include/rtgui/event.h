@@ -93,6 +93,10 @@ enum _rtgui_event_type
 
     WBUS_NOTIFY_EVENT,
 
+    RTGUI_EVENT_REF,                   /* reference to a pooled event */
+    RTGUI_EVENT_FRAME,                 /* vsync of the frame clock */
+    RTGUI_EVENT_INPUT_REQUEST,         /* requests queued by the input stage */
+
     /* user command event. It should always be the last command type. */
     RTGUI_EVENT_COMMAND = 0x0100,      /* user command          */
 };
@@ -105,6 +109,7 @@ enum
     RTGUI_STATUS_NRC,           /* no resource       */
 };
 
+struct rtgui_future;
 struct rtgui_event
 {
     /* the event type */
@@ -115,8 +120,13 @@ struct rtgui_event
     /* the event sender */
     struct rtgui_app *sender;
 
-    /* mailbox to acknowledge request */
-    rt_mailbox_t ack;
+    /* the future to acknowledge request */
+    struct rtgui_future *ack;
+
+#ifdef GUIENGIN_USING_TRACE
+    /* the time queued, see rtgui_trace_recv */
+    rt_uint32_t stamp;
+#endif
 };
 typedef struct rtgui_event rtgui_event_t;
 #define RTGUI_EVENT(e)  ((struct rtgui_event*)(e))
@@ -245,6 +255,10 @@ struct rtgui_event_monitor
     rtgui_rect_t rect;
 };
 
+/* the user field of paint event: only the damage region in wid->damage_pending
+ * need to be painted, otherwise it's the whole window */
+#define RTGUI_PAINT_DAMAGE                  0x01
+
 struct rtgui_event_paint
 {
     _RTGUI_EVENT_WIN_ELEMENTS
@@ -253,15 +267,18 @@ struct rtgui_event_paint
 };
 
 struct rtgui_timer;
+/* the timer wheel of app is due, all the expired timers are run on it */
 struct rtgui_event_timer
 {
     struct rtgui_event parent;
 
+    /* RT_NULL, kept for compatibility */
     struct rtgui_timer *timer;
 };
 typedef struct rtgui_event_timer rtgui_event_timer_t;
 
 
+/* the new clip is published in wid->clip_pending before the event is sent */
 struct rtgui_event_clip_info
 {
     _RTGUI_EVENT_WIN_ELEMENTS
@@ -364,6 +381,14 @@ struct rtgui_event_mouse
 
     rt_uint32_t	win_acti_cnt;		/* window activate count */
 };
+/* the user field of mouse motion event: the motion is coalesced by server,
+ * the latest position is taken from app->motion when the event is received */
+#define RTGUI_MOUSE_COALESCED           0x01
+/* the state of app->motion: a coalesced motion event is in the queue of app,
+ * and a button event is queued after it so the new motions are not merged */
+#define RTGUI_MOUSE_MOTION_PENDING      0x01
+#define RTGUI_MOUSE_MOTION_SEALED       0x02
+
 #define RTGUI_MOUSE_BUTTON_LEFT         0x01
 #define RTGUI_MOUSE_BUTTON_RIGHT        0x02
 #define RTGUI_MOUSE_BUTTON_MIDDLE       0x03
@@ -436,6 +461,29 @@ struct rtgui_event_command
 };
 #define RTGUI_EVENT_COMMAND_INIT(e) RTGUI_EVENT_INIT(&((e)->parent), RTGUI_EVENT_COMMAND)
 
+/*
+ * The event in the queue of app for a pooled event, see rtgui_event_alloc.
+ * The queue holds a reference of the pooled event, which is handled without
+ * copying it again and released after handling.
+ */
+struct rtgui_event_ref
+{
+    struct rtgui_event parent;
+
+    struct rtgui_event *event;
+};
+#define RTGUI_EVENT_REF_INIT(e)     RTGUI_EVENT_INIT(&((e)->parent), RTGUI_EVENT_REF)
+
+/* the frame clock of app is due, see rtgui_frame_request */
+struct rtgui_event_frame
+{
+    struct rtgui_event parent;
+
+    /* the tick of the vsync */
+    rt_tick_t tick;
+};
+#define RTGUI_EVENT_FRAME_INIT(e)   RTGUI_EVENT_INIT(&((e)->parent), RTGUI_EVENT_FRAME)
+
 #define RTGUI_CMD_UNKNOWN       0x00
 #define RTGUI_CMD_WM_CLOSE      0x10
 
@@ -574,6 +622,8 @@ union rtgui_event_generic
     struct rtgui_event_resize resize;
     struct rtgui_event_mv_model model;
     struct rtgui_event_command command;
+    struct rtgui_event_ref ref;
+    struct rtgui_event_frame frame;
 };
 
 #ifdef __cplusplus
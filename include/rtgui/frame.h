@@ -0,0 +1,116 @@
+/*
+ * File      : frame.h
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+
+#ifndef __RTGUI_FRAME_H__
+#define __RTGUI_FRAME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtgui/rtgui.h>
+#include <rtgui/list.h>
+
+struct rtgui_app;
+struct rtgui_widget;
+struct rtgui_event_frame;
+
+struct rtgui_frame_callback;
+typedef void (*rtgui_frame_func_t)(struct rtgui_frame_callback *callback, rt_tick_t tick, void *parameter);
+
+/* a callback run once per frame while it is started */
+struct rtgui_frame_callback
+{
+    rtgui_list_t list;
+
+    /* the rtgui application it runs on */
+    struct rtgui_app *app;
+    rt_bool_t running;
+
+    rtgui_frame_func_t func;
+    void *user_data;
+};
+
+/*
+ * The frame clock of an app. On each vsync the apps that requested a frame
+ * get a RTGUI_EVENT_FRAME, then run all of their frame callbacks, paint the
+ * widgets invalidated by them and update the screen once.
+ */
+struct rtgui_frame_clock
+{
+    /* on the list of clocks waiting for vsync */
+    rtgui_list_t list;
+    rt_bool_t requested;
+    /* the vsync is sending to it, and it's finalized so never sent again */
+    rt_bool_t sending;
+    rt_bool_t detached;
+
+    /* the started frame callbacks, and the next one to run in dispatching */
+    rtgui_list_t callbacks;
+    rtgui_list_t *cursor;
+    rt_uint32_t frame;
+
+    /* the widgets to paint at the end of the frame */
+    struct rtgui_widget *paint[GUIENGIN_FRAME_PAINT_MAX];
+    rt_uint16_t paint_num;
+};
+
+void rtgui_frame_clock_init(struct rtgui_frame_clock *clock);
+void rtgui_frame_clock_fini(struct rtgui_frame_clock *clock);
+
+struct rtgui_frame_callback *rtgui_frame_callback_create(rtgui_frame_func_t func, void *parameter);
+void rtgui_frame_callback_destroy(struct rtgui_frame_callback *callback);
+void rtgui_frame_callback_start(struct rtgui_frame_callback *callback);
+void rtgui_frame_callback_stop(struct rtgui_frame_callback *callback);
+
+/* get a RTGUI_EVENT_FRAME on the next vsync */
+void rtgui_frame_request(struct rtgui_app *app);
+/* paint the widget at the end of current or next frame */
+void rtgui_frame_invalidate(struct rtgui_widget *widget);
+void rtgui_frame_cancel(struct rtgui_widget *widget);
+
+/* run the frame callbacks and paint, called on RTGUI_EVENT_FRAME */
+void rtgui_frame_dispatch(struct rtgui_app *app, struct rtgui_event_frame *event);
+
+/*
+ * The display driver which has a vsync interrupt calls rtgui_frame_set_vsync
+ * with RT_TRUE, then calls rtgui_frame_vsync in the interrupt. Otherwise a
+ * timer of GUIENGIN_FRAME_MS stands in, which runs only if there is a frame
+ * requested.
+ *
+ * Only rtgui_frame_request, rtgui_frame_set_vsync and rtgui_frame_vsync can
+ * be called in interrupt. The vsync takes the waiting clocks with interrupt
+ * disabled and sends the frame events after enabling it again, so the event
+ * queue is never touched with interrupt disabled.
+ */
+void rtgui_frame_set_vsync(rt_bool_t driver);
+void rtgui_frame_vsync(void);
+
+void rtgui_system_frame_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,6 +37,8 @@ struct rtgui_region_data
 {
     rt_uint32_t size;
     rt_uint32_t numRects;
+    /* the last rect hit by point lookup, it's checked before using */
+    rt_uint32_t hint;
     /* XXX: And why, exactly, do we have this bogus struct definition? */
     /* rtgui_rect_t rects[size]; in memory but not explicitly declared */
 };
@@ -45,8 +47,40 @@ typedef struct rtgui_region
 {
     rtgui_rect_t          extents;
     rtgui_region_data_t  *data;
+
+    /* the small regions use this storage instead of heap. A region refers
+     * to itself, so don't copy it by assignment, use rtgui_region_copy. */
+    struct
+    {
+        rtgui_region_data_t head;
+        rtgui_rect_t rects[GUIENGIN_REGION_INLINE_RECTS];
+    } inline_data;
 } rtgui_region_t;
 
+/*
+ * The scratch storage of region operators. Each gui thread has one, the
+ * result of an operation is built in it and then copied to the destination,
+ * so the temporary rects don't go through the heap on every operation.
+ */
+struct rtgui_region_arena
+{
+    rtgui_region_data_t *data;
+};
+
+/*
+ * A region published by one thread and adopted by the others. It's never
+ * changed after creation, so the holders can read it without locking; the
+ * last holder frees it by rtgui_region_snapshot_unref.
+ */
+struct rtgui_region_snapshot
+{
+    rt_uint32_t refcount;
+    /* a later published snapshot has a larger version */
+    rt_uint32_t version;
+
+    rtgui_region_t region;
+};
+
 typedef enum
 {
     RTGUI_REGION_STATUS_FAILURE,
@@ -85,6 +119,7 @@ int rtgui_region_contains_point(rtgui_region_t *region, int x, int y, rtgui_rect
 int rtgui_region_contains_rectangle(rtgui_region_t *rtgui_region_t, rtgui_rect_t *prect);
 
 int rtgui_region_not_empty(rtgui_region_t *region);
+int rtgui_region_is_equal(rtgui_region_t *region1, rtgui_region_t *region2);
 rtgui_rect_t *rtgui_region_extents(rtgui_region_t *region);
 
 rtgui_region_status_t rtgui_region_append(rtgui_region_t *dest, rtgui_region_t *region);
@@ -95,6 +130,28 @@ void rtgui_region_empty(rtgui_region_t *region);
 void rtgui_region_dump(rtgui_region_t *region);
 void rtgui_region_draw_clip(rtgui_region_t *region, struct rtgui_dc *dc);
 int rtgui_region_is_flat(rtgui_region_t *region);
+#ifdef GUIENGIN_REGION_SELFTEST
+/* compare the fast paths with the general algorithm, returns the error count */
+int rtgui_region_selftest(int count);
+#endif
+
+/* the region is copied, the snapshot is returned with one reference */
+struct rtgui_region_snapshot *rtgui_region_snapshot_create(rtgui_region_t *region, rt_uint32_t version);
+struct rtgui_region_snapshot *rtgui_region_snapshot_ref(struct rtgui_region_snapshot *snapshot);
+void rtgui_region_snapshot_unref(struct rtgui_region_snapshot *snapshot);
+/* atomically store @snapshot into @slot and return the one replaced */
+struct rtgui_region_snapshot *rtgui_region_snapshot_exchange(struct rtgui_region_snapshot **slot,
+        struct rtgui_region_snapshot *snapshot);
+/* return the snapshot in @slot with a reference taken, it's left in @slot */
+struct rtgui_region_snapshot *rtgui_region_snapshot_peek(struct rtgui_region_snapshot **slot);
+/* store @snapshot into @slot only if it still holds @expected, the reference
+ * of @slot to @expected is handed over to the caller on success */
+rt_bool_t rtgui_region_snapshot_compare_exchange(struct rtgui_region_snapshot **slot,
+        struct rtgui_region_snapshot *expected, struct rtgui_region_snapshot *snapshot);
+
+/* trim the region arena of current thread, called after clip updating */
+void rtgui_region_arena_reset(void);
+void rtgui_region_arena_fini(struct rtgui_region_arena *arena);
 
 /* rect functions */
 extern rtgui_rect_t rtgui_empty_rect;
@@ -101,6 +101,8 @@ struct rtgui_gc
     rt_uint16_t textstyle;
     /* text align */
     rt_uint16_t textalign;
+    /* dithering on the low bit depth target */
+    rt_uint16_t dither;
 
     /* font */
     struct rtgui_font *font;
@@ -178,6 +180,13 @@ enum RTGUI_TEXTSTYLE
     RTGUI_TEXTSTYLE_OUTLINE         = 0x04,
 };
 
+enum RTGUI_DITHER
+{
+    RTGUI_DITHER_NONE       = 0x00,
+    RTGUI_DITHER_ORDERED    = 0x01,     /* 4x4 Bayer matrix */
+    RTGUI_DITHER_DIFFUSION  = 0x02,     /* Floyd-Steinberg error diffusion */
+};
+
 enum RTGUI_MODAL_CODE
 {
     RTGUI_MODAL_OK,
@@ -28,6 +28,8 @@
 #include <rtthread.h>
 #include <rtgui/rtgui.h>
 #include <rtgui/event.h>
+#include <rtgui/frame.h>
+#include <rtgui/region.h>
 #include <rtgui/rtgui_system.h>
 
 #ifdef __cplusplus
@@ -50,7 +52,42 @@ enum rtgui_app_flag
     RTGUI_APP_FLAG_KEEP    = 0x80,
 };
 
-typedef void (*rtgui_idle_func_t)(struct rtgui_object *obj, struct rtgui_event *event);
+/* the lanes of the event queue of app, received in this order */
+enum rtgui_event_lane_id
+{
+    RTGUI_EVENT_LANE_INPUT = 0,        /* mouse, keyboard and touch */
+    RTGUI_EVENT_LANE_TIMER,            /* timeout of rtgui timers */
+    RTGUI_EVENT_LANE_PAINT,            /* clip and paint, damage is coalesced by server */
+    RTGUI_EVENT_LANE_COMMAND,          /* window management and user commands */
+
+    RTGUI_EVENT_LANE_MAX,
+};
+
+struct rtgui_event_lane
+{
+    rt_mq_t mq;
+
+    /* statistics */
+    rt_uint32_t sent;
+    rt_uint32_t dropped;
+    rt_uint16_t peak;
+};
+
+struct rtgui_event_lane_stat
+{
+    rt_uint32_t sent;
+    rt_uint32_t dropped;
+    rt_uint16_t depth;
+    rt_uint16_t peak;
+    rt_uint16_t limit;
+};
+
+/* the return value of on_idle is the number of ticks until it wants to be
+ * called again, or one of the following */
+#define RTGUI_IDLE_DONE         (-1)    /* no more work until the next event */
+#define RTGUI_IDLE_FRAME        (-2)    /* call again on the next frame clock */
+
+typedef rt_int32_t (*rtgui_idle_func_t)(struct rtgui_object *obj, struct rtgui_event *event);
 
 struct rtgui_app
 {
@@ -67,8 +104,12 @@ struct rtgui_app
 
     /* the thread id */
     rt_thread_t tid;
-    /* the message queue of thread */
-    rt_mq_t mq;
+    /* the message queues of thread, one for each lane */
+    struct rtgui_event_lane lane[RTGUI_EVENT_LANE_MAX];
+    /* the number of events in all lanes */
+    struct rt_semaphore pending;
+    /* the notification of the futures waited on this thread */
+    struct rt_event ack;
     /* event buffer */
     rt_uint8_t event_buffer[sizeof(union rtgui_event_generic)];
 
@@ -79,12 +120,38 @@ struct rtgui_app
 
     /* on idle event handler */
     rtgui_idle_func_t on_idle;
+    /* the tick on_idle is due, unless it has returned RTGUI_IDLE_DONE */
+    rt_tick_t idle_tick;
+    rt_uint8_t idle_done;
+    /* on_idle is waiting for the next frame */
+    rt_uint8_t idle_frame;
+
+    /* the frame clock of animations */
+    struct rtgui_frame_clock frame;
+    /* the rtgui timers of app */
+    struct rtgui_timer_wheel timer_wheel;
 
     unsigned int window_cnt;
     /* window activate count */
     unsigned int win_acti_cnt;
 
     void *user_data;
+
+    /* scratch storage of the region operators on this thread */
+    struct rtgui_region_arena region_arena;
+    /* the error lines of dithering blit on this thread, and the size in bytes */
+    rt_int16_t *dither_err;
+    rt_uint32_t dither_err_size;
+
+    /* the latest mouse motion coalesced by server, see RTGUI_MOUSE_COALESCED */
+    rt_uint8_t motion_state;
+    struct rtgui_event_mouse motion;
+
+    /* the button events held back by server while the input lane is full,
+     * moved into the lane in order as the app takes the input events */
+    rt_uint8_t button_head;
+    rt_uint8_t button_num;
+    struct rtgui_event_mouse button[GUIENGIN_INPUT_BUTTON_PENDING];
 };
 
 /**
@@ -117,6 +184,16 @@ rt_err_t rtgui_app_set_as_wm(struct rtgui_app *app);
 void rtgui_app_set_main_win(struct rtgui_app *app, struct rtgui_win *win);
 struct rtgui_win* rtgui_app_get_main_win(struct rtgui_app *app);
 
+/* whether there are events queued for app */
+rt_inline rt_bool_t rtgui_app_has_pending(struct rtgui_app *app)
+{
+    return app->pending.value != 0 ? RT_TRUE : RT_FALSE;
+}
+
+/* get the statistics of an event lane of app */
+void rtgui_app_get_lane_stat(struct rtgui_app *app, enum rtgui_event_lane_id id,
+                             struct rtgui_event_lane_stat *stat);
+
 /* get the topwin belong app window activate count */
 unsigned int rtgui_app_get_win_acti_cnt(void);
 
@@ -50,6 +50,34 @@
 #endif
 #endif
 
+/* the input stage of server routes the input events ahead of the server */
+#ifndef GUIENGIN_INPUT_THREAD_PRIORITY
+#define GUIENGIN_INPUT_THREAD_PRIORITY     (GUIENGINE_SVR_THREAD_PRIORITY - 1)
+#endif
+#ifndef GUIENGIN_INPUT_THREAD_STACK_SIZE
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_INPUT_THREAD_STACK_SIZE   512
+#else
+#define GUIENGIN_INPUT_THREAD_STACK_SIZE   1024
+#endif
+#endif
+/* the input events queued to the input stage */
+#ifndef GUIENGIN_INPUT_QUEUE_DEPTH
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_INPUT_QUEUE_DEPTH         16
+#else
+#define GUIENGIN_INPUT_QUEUE_DEPTH         32
+#endif
+#endif
+/* the requests from the input stage to server, must be a power of 2 */
+#ifndef GUIENGIN_INPUT_PIPE_SIZE
+#define GUIENGIN_INPUT_PIPE_SIZE           8
+#endif
+/* the button events held back for an app whose input lane is full */
+#ifndef GUIENGIN_INPUT_BUTTON_PENDING
+#define GUIENGIN_INPUT_BUTTON_PENDING      8
+#endif
+
 #define GUIENGIN_APP_THREAD_PRIORITY       25
 #define GUIENGIN_APP_THREAD_TIMESLICE      5
 #ifdef GUIENGIN_USING_SMALL_SIZE
@@ -67,6 +95,133 @@
 
 #define GUIENGIN_USING_VFRAMEBUFFER
 
+/* cache the rendered round corners and aa circles */
+#ifndef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_USING_SHAPE_CACHE
+#endif
+#ifndef GUIENGIN_SHAPE_CACHE_SIZE
+#define GUIENGIN_SHAPE_CACHE_SIZE           (32 * 1024)
+#endif
+
+/* the rects kept in the region itself before the heap is used, at least 1 */
+#ifndef GUIENGIN_REGION_INLINE_RECTS
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_REGION_INLINE_RECTS        2
+#else
+#define GUIENGIN_REGION_INLINE_RECTS        4
+#endif
+#endif
+/* the scratch storage of region operators is trimmed to this after clip updating */
+#ifndef GUIENGIN_REGION_ARENA_RECTS
+#define GUIENGIN_REGION_ARENA_RECTS         64
+#endif
+/* the regions with more rects than this are looked up by binary search */
+#ifndef GUIENGIN_REGION_BSEARCH_RECTS
+#define GUIENGIN_REGION_BSEARCH_RECTS       8
+#endif
+
+/* the containers with this number of children use a grid for hit testing */
+#ifndef GUIENGIN_HIT_GRID_CHILDREN
+#define GUIENGIN_HIT_GRID_CHILDREN          16
+#endif
+
+/* the message size of the queue of app, the larger events are passed through
+ * the event pool. It should hold struct rtgui_event_ref at least. By default
+ * the window, clip and paint events fit in, the input, command and model
+ * events go through the pool */
+#ifndef GUIENGIN_EVENT_SLOT_SIZE
+#define GUIENGIN_EVENT_SLOT_SIZE            (sizeof(struct rtgui_event_paint))
+#endif
+/* the number of events in the event pool, the others are allocated in heap */
+#ifndef GUIENGIN_EVENT_POOL_NUM
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_EVENT_POOL_NUM             8
+#else
+#define GUIENGIN_EVENT_POOL_NUM             16
+#endif
+#endif
+
+/* the depth of each lane of the event queue of app */
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#ifndef GUIENGIN_EVENT_LANE_INPUT_DEPTH
+#define GUIENGIN_EVENT_LANE_INPUT_DEPTH     16
+#endif
+#ifndef GUIENGIN_EVENT_LANE_TIMER_DEPTH
+#define GUIENGIN_EVENT_LANE_TIMER_DEPTH     8
+#endif
+#ifndef GUIENGIN_EVENT_LANE_PAINT_DEPTH
+#define GUIENGIN_EVENT_LANE_PAINT_DEPTH     8
+#endif
+#ifndef GUIENGIN_EVENT_LANE_COMMAND_DEPTH
+#define GUIENGIN_EVENT_LANE_COMMAND_DEPTH   32
+#endif
+#else
+#ifndef GUIENGIN_EVENT_LANE_INPUT_DEPTH
+#define GUIENGIN_EVENT_LANE_INPUT_DEPTH     64
+#endif
+#ifndef GUIENGIN_EVENT_LANE_TIMER_DEPTH
+#define GUIENGIN_EVENT_LANE_TIMER_DEPTH     32
+#endif
+#ifndef GUIENGIN_EVENT_LANE_PAINT_DEPTH
+#define GUIENGIN_EVENT_LANE_PAINT_DEPTH     32
+#endif
+#ifndef GUIENGIN_EVENT_LANE_COMMAND_DEPTH
+#define GUIENGIN_EVENT_LANE_COMMAND_DEPTH   128
+#endif
+#endif
+
+/* the most events the server handles before publishing the changes of the
+ * window tree, even if there are more in its queue */
+#ifndef GUIENGIN_SERVER_BATCH_MAX
+#define GUIENGIN_SERVER_BATCH_MAX           8
+#endif
+
+/* the period of the timer standing in for vsync if the display driver has
+ * no vsync interrupt, see rtgui_frame_vsync */
+#ifndef GUIENGIN_FRAME_MS
+#define GUIENGIN_FRAME_MS                   16
+#endif
+
+/* the most widgets painted together in one frame of an app */
+#ifndef GUIENGIN_FRAME_PAINT_MAX
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_FRAME_PAINT_MAX            8
+#else
+#define GUIENGIN_FRAME_PAINT_MAX            32
+#endif
+#endif
+
+/* the slots of each level of the timer wheel of app are 2^bits, at most 5 */
+#ifndef GUIENGIN_TIMER_WHEEL_BITS
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_TIMER_WHEEL_BITS           4
+#else
+#define GUIENGIN_TIMER_WHEEL_BITS           5
+#endif
+#endif
+
+/* the default slack of a timer is 1/2^shift of its timeout */
+#ifndef GUIENGIN_TIMER_SLACK_SHIFT
+#define GUIENGIN_TIMER_SLACK_SHIFT          5
+#endif
+
+/* trace the event loop, drawing and screen update, see gui_trace command */
+// #define GUIENGIN_USING_TRACE
+/* the records kept in the trace ring, must be a power of 2 */
+#ifndef GUIENGIN_TRACE_RECORDS
+#ifdef GUIENGIN_USING_SMALL_SIZE
+#define GUIENGIN_TRACE_RECORDS              128
+#else
+#define GUIENGIN_TRACE_RECORDS              1024
+#endif
+#endif
+
+/* check the fast paths of region operations by region_selftest command */
+// #define GUIENGIN_REGION_SELFTEST
+
+/* check the clip update of widget tree by rtgui_widget_selftest command */
+// #define GUIENGIN_WIDGET_SELFTEST
+
 //#ifndef PKG_USING_RGB888_PIXEL_BITS_32
 //#ifndef PKG_USING_RGB888_PIXEL_BITS_24
 //#define PKG_USING_RGB888_PIXEL_BITS_32
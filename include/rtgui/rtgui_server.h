@@ -30,6 +30,7 @@ extern "C" {
 
 #include <rtservice.h>
 #include <rtgui/list.h>
+#include <rtgui/region.h>
 
 /* RTGUI server definitions */
 
@@ -47,6 +48,12 @@ enum rtgui_topwin_flag
     WINTITLE_MODALING   = 0x100,
     WINTITLE_ONTOP      = 0x200,
     WINTITLE_ONBTM      = 0x400,
+    /* the whole window is repainted on the next flush */
+    WINTITLE_REPAINT    = 0x800,
+    /* moved, the window repaints itself when it's shown again */
+    WINTITLE_MOVED      = 0x1000,
+    /* the activate state is notified on the next flush */
+    WINTITLE_NOTIFY     = 0x2000,
 };
 
 struct rtgui_topwin
@@ -66,6 +73,10 @@ struct rtgui_topwin
 
     /* the extent information */
     rtgui_rect_t extent;
+    /* the last clip published to window */
+    struct rtgui_region_snapshot *clip;
+    /* the area uncovered since the last paint event */
+    rtgui_region_t damage;
 
     struct rtgui_topwin *parent;
 
@@ -78,6 +89,40 @@ struct rtgui_topwin
     rtgui_list_t monitor_list;
 };
 
+/* a shown window in the input map, see rtgui_input_map_get */
+struct rtgui_input_target
+{
+    struct rtgui_win *wid;
+    struct rtgui_app *app;
+
+    rtgui_rect_t extent;
+    /* the published clip, RT_NULL if the map is published before the clip */
+    struct rtgui_region_snapshot *clip;
+    /* the motions out of the monitor rects are dropped, if there is any */
+    rtgui_rect_t *monitor;
+    rt_uint16_t monitor_num;
+};
+
+/*
+ * The windows receiving the input events, flattened from the window tree in
+ * the order of hit testing. The modaled windows are left out. It's published
+ * by the window tree on flush and used by the input stage of server without
+ * touching the tree.
+ */
+struct rtgui_input_map
+{
+    rt_uint32_t refcount;
+
+    /* the focus window, which receives the kbd events */
+    struct rtgui_win *focus;
+    struct rtgui_app *focus_app;
+
+    struct rtgui_input_target *target;
+    rt_uint16_t target_num;
+    /* the last hit target, see rtgui_input_map_hit */
+    rt_uint16_t hit;
+};
+
 /* top win manager init */
 void rtgui_topwin_init(void);
 void rtgui_server_init(void);
@@ -88,6 +133,8 @@ void rtgui_server_install_act_win_hook(void (*hk)(void));
 /* post an event to server */
 rt_err_t rtgui_server_post_event(struct rtgui_event *event, rt_size_t size);
 rt_err_t rtgui_server_post_event_sync(struct rtgui_event *event, rt_size_t size);
+rt_err_t rtgui_server_post_event_async(struct rtgui_event *event, rt_size_t size,
+                                       struct rtgui_future *future);
 
 #ifdef __cplusplus
 }
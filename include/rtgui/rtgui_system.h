@@ -42,17 +42,22 @@ enum rtgui_timer_state
 {
     RTGUI_TIMER_ST_INIT,
     RTGUI_TIMER_ST_RUNNING,
-    RTGUI_TIMER_ST_DESTROY_PENDING,
 };
 
+/* let the timer expire up to 1/2^GUIENGIN_TIMER_SLACK_SHIFT of its timeout late */
+#define RTGUI_TIMER_SLACK_AUTO      (-1)
+
 struct rtgui_timer
 {
     /* the rtgui application it runs on */
     struct rtgui_app* app;
-    /* rt timer */
-    struct rt_timer timer;
-    /* How many events are pending on the queue. */
-    int pending_cnt;
+    /* on a slot of the timer wheel of app */
+    rt_list_t list;
+    rt_tick_t expires;
+    rt_tick_t init_tick;
+    /* how many ticks the timer may be late, to expire with the nearby ones */
+    rt_int32_t slack;
+    rt_uint8_t flag;
     enum rtgui_timer_state state;
 
     /* timeout function and user data */
@@ -61,13 +66,54 @@ struct rtgui_timer
 };
 typedef struct rtgui_timer rtgui_timer_t;
 
+#if GUIENGIN_TIMER_WHEEL_BITS > 5
+#error "the slots of a timer wheel level should fit in a 32 bits bitmap"
+#endif
+
+#define RTGUI_TIMER_WHEEL_SIZE      (1 << GUIENGIN_TIMER_WHEEL_BITS)
+#define RTGUI_TIMER_WHEEL_MASK      (RTGUI_TIMER_WHEEL_SIZE - 1)
+#define RTGUI_TIMER_WHEEL_LEVEL     4
+/* the ticks to retry when the timer event can't be queued */
+#define RTGUI_TIMER_WHEEL_RETRY     2
+
+/*
+ * The hierarchical timer wheel of an app. Level n holds the timers expire in
+ * 2^(bits * (n + 1)) ticks, which are moved to the lower level when their
+ * slot is reached. One kernel timer wakes the app on the next expiry, then
+ * all the timers due are run on a single RTGUI_EVENT_TIMER.
+ */
+struct rtgui_timer_wheel
+{
+    /* the next tick to run */
+    rt_tick_t now;
+    /* the running timers */
+    rt_uint32_t count;
+
+    /* the slots may be not empty */
+    rt_uint32_t bitmap[RTGUI_TIMER_WHEEL_LEVEL];
+    rt_list_t slot[RTGUI_TIMER_WHEEL_LEVEL][RTGUI_TIMER_WHEEL_SIZE];
+
+    struct rt_timer timer;
+    rt_tick_t armed_tick;
+    rt_bool_t armed;
+    rt_bool_t event_pending;
+};
+
+/* the timer runs on the app of the creating thread, and must be started and
+ * stopped on that thread */
 rtgui_timer_t *rtgui_timer_create(rt_int32_t time, rt_int32_t flag, rtgui_timeout_func timeout, void *parameter);
 void rtgui_timer_destory(rtgui_timer_t *timer);
 
 void rtgui_timer_set_timeout(rtgui_timer_t *timer, rt_int32_t time);
+void rtgui_timer_set_slack(rtgui_timer_t *timer, rt_int32_t slack);
 void rtgui_timer_start(rtgui_timer_t *timer);
 void rtgui_timer_stop(rtgui_timer_t *timer);
 
+void rtgui_timer_wheel_init(struct rtgui_timer_wheel *wheel, const char *name);
+void rtgui_timer_wheel_fini(struct rtgui_timer_wheel *wheel);
+/* run the expired timers, called on RTGUI_EVENT_TIMER */
+void rtgui_timer_wheel_run(struct rtgui_timer_wheel *wheel);
+
 /* rtgui system initialization function */
 int rtgui_system_server_init(void);
 
@@ -94,13 +140,43 @@ int rtgui_screen_lock_freeze(void);
 void rtgui_screen_lock_thaw(int value);
 
 struct rtgui_event;
+
+/* the result of a request, completed by rtgui_ack of the receiver. It
+ * should be kept alive until rtgui_future_wait returns. */
+struct rtgui_future
+{
+    rt_int32_t status;
+    rt_uint8_t done;
+
+    rt_event_t notify;
+    /* used when the sender is not a gui thread */
+    struct rt_event local;
+};
+#define RTGUI_FUTURE_DONE   0x01
+
 rt_err_t rtgui_send(struct rtgui_app* app, struct rtgui_event *event, rt_size_t event_size);
 rt_err_t rtgui_send_urgent(struct rtgui_app* app, struct rtgui_event *event, rt_size_t event_size);
 rt_err_t rtgui_send_sync(struct rtgui_app* app, struct rtgui_event *event, rt_size_t event_size);
+rt_err_t rtgui_send_async(struct rtgui_app* app, struct rtgui_event *event, rt_size_t event_size,
+                          struct rtgui_future *future);
+rt_int32_t rtgui_future_wait(struct rtgui_future *future);
+rt_inline rt_bool_t rtgui_future_is_done(struct rtgui_future *future)
+{
+    return future->done ? RT_TRUE : RT_FALSE;
+}
 rt_err_t rtgui_ack(struct rtgui_event *event, rt_int32_t status);
 rt_err_t rtgui_recv(struct rtgui_event *event, rt_size_t event_size, rt_int32_t timeout);
 rt_err_t rtgui_recv_filter(rt_uint32_t type, struct rtgui_event *event, rt_size_t event_size);
 
+/* refcounted events, shared by receivers without copy */
+struct rtgui_event *rtgui_event_alloc(rt_uint32_t type, rt_size_t size);
+#define RTGUI_EVENT_ALLOC(type, T)  ((T *)rtgui_event_alloc((type), sizeof(T)))
+struct rtgui_event *rtgui_event_ref(struct rtgui_event *event);
+void rtgui_event_unref(struct rtgui_event *event);
+rt_err_t rtgui_send_ref(struct rtgui_app* app, struct rtgui_event *event);
+rt_err_t rtgui_recv_ref(struct rtgui_event **event, rt_int32_t timeout);
+void rtgui_recv_done(struct rtgui_event *event);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,102 @@
+/*
+ * File      : shape_cache.h
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+
+#ifndef __RTGUI_SHAPE_CACHE_H__
+#define __RTGUI_SHAPE_CACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtgui/rtgui.h>
+#include <rtgui/dc.h>
+
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+
+enum rtgui_shape_type
+{
+    RTGUI_SHAPE_ROUND_CORNER,   /* filled disc used by the round rect corners */
+    RTGUI_SHAPE_AA_CIRCLE,      /* anti-aliased circle outline */
+};
+
+/* the key to identify a rendered shape */
+struct rtgui_shape_key
+{
+    rt_uint8_t type;
+    rt_uint8_t pixel_format;    /* pixel format of the target dc */
+    rt_uint16_t radius;
+    rt_uint16_t width, height;  /* size of the sprite */
+
+    /* the sprite is transparent out of the shape, no background color */
+    rtgui_color_t fc;
+};
+
+/* render the shape described by @key into the ARGB888 @sprite */
+typedef void (*rtgui_shape_render_t)(struct rtgui_dc *sprite, const struct rtgui_shape_key *key);
+
+/* shape item in shape cache */
+struct rtgui_shape_item
+{
+    rt_list_t list;
+
+    struct rtgui_shape_key key;
+    struct rtgui_dc *sprite;
+
+    rt_uint32_t size;
+    rt_uint32_t refcount;
+};
+
+struct rtgui_shape_cache_stat
+{
+    rt_uint32_t hit, miss, evict;
+
+    rt_uint32_t count;
+    rt_uint32_t used, budget;
+};
+
+void rtgui_system_shape_cache_init(void);
+
+/* whether the sprite of shape cache can be blit on this dc */
+rt_bool_t rtgui_shape_cache_check(struct rtgui_dc *dc);
+
+/*
+ * Get the sprite of a shape. If the shape is not in cache, it will be
+ * rendered by @render. Returns RT_NULL if the shape doesn't fit in the
+ * cache, then the caller should draw the shape directly.
+ */
+struct rtgui_shape_item *rtgui_shape_cache_get(const struct rtgui_shape_key *key,
+                                               rtgui_shape_render_t render);
+void rtgui_shape_cache_put(struct rtgui_shape_item *item);
+
+void rtgui_shape_cache_set_budget(rt_uint32_t budget);
+void rtgui_shape_cache_flush(void);
+void rtgui_shape_cache_get_stat(struct rtgui_shape_cache_stat *stat);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
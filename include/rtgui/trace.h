@@ -0,0 +1,117 @@
+/*
+ * File      : trace.h
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+
+#ifndef __RTGUI_TRACE_H__
+#define __RTGUI_TRACE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtgui/rtgui.h>
+#include <rtgui/event.h>
+
+#ifdef GUIENGIN_USING_TRACE
+
+struct rtgui_app;
+struct rtgui_win;
+
+enum rtgui_trace_kind
+{
+    RTGUI_TRACE_SEND,       /* an event is queued to app */
+    RTGUI_TRACE_DROP,       /* the queue of app is full */
+    RTGUI_TRACE_RECV,       /* waited in the queue since sent */
+    RTGUI_TRACE_DISPATCH,   /* handled by the app */
+    RTGUI_TRACE_DRAW_BEGIN,
+    RTGUI_TRACE_DRAW_END,
+    RTGUI_TRACE_UPDATE,     /* screen update of driver */
+};
+
+/*
+ * A record in the trace ring. The writers take the slots without lock, the
+ * seq is written last so the readers skip the slots being written.
+ */
+struct rtgui_trace_record
+{
+    rt_uint32_t seq;
+
+    /* in microsecond */
+    rt_uint32_t ts;
+    rt_uint32_t dur;
+
+    /* the thread recorded in, the name is the app sent to for SEND/DROP and
+     * the window title for DRAW */
+    rt_thread_t thread;
+    char name[RT_NAME_MAX];
+
+    rt_uint16_t event;
+    rt_uint8_t kind;
+};
+
+/* the event types in histograms, the last one counts the user commands */
+#define RTGUI_TRACE_EVENT_TYPES     (RTGUI_EVENT_INPUT_REQUEST + 2)
+/* the buckets of histogram, bucket n counts the time below 2^(n+1)us */
+#define RTGUI_TRACE_BUCKETS         16
+
+struct rtgui_trace_hist
+{
+    rt_uint32_t count;
+    rt_uint32_t max;
+    rt_uint32_t bucket[RTGUI_TRACE_BUCKETS];
+};
+
+/* the name of event type */
+const char *rtgui_event_name(rt_uint32_t type);
+
+/* the clock of trace in microsecond, the tick is used by default */
+typedef rt_uint32_t (*rtgui_trace_clock_t)(void);
+void rtgui_trace_set_clock(rtgui_trace_clock_t clock);
+rt_uint32_t rtgui_trace_now(void);
+
+void rtgui_trace_start(void);
+void rtgui_trace_stop(void);
+void rtgui_trace_reset(void);
+
+/* the hooks in event loop, drawing and screen update */
+void rtgui_trace_send(struct rtgui_app *app, rt_uint32_t type, rt_err_t result);
+void rtgui_trace_recv(struct rtgui_event *event);
+void rtgui_trace_dispatch(rt_uint32_t type, rt_uint32_t begin);
+void rtgui_trace_draw(struct rtgui_win *win, rt_bool_t begin);
+void rtgui_trace_update(rt_uint32_t begin);
+
+/* the queue wait and dispatch time histograms of an event type */
+void rtgui_trace_get_hist(rt_uint32_t type, struct rtgui_trace_hist *wait,
+                          struct rtgui_trace_hist *dispatch);
+
+/* write the records in chrome trace event format, to console if the
+ * filename is RT_NULL */
+rt_err_t rtgui_trace_export(const char *filename);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
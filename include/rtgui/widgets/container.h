@@ -39,6 +39,8 @@ DECLARE_CLASS_TYPE(container);
 /** Checks if the object is an rtgui_container */
 #define RTGUI_IS_CONTAINER(obj)    (RTGUI_OBJECT_CHECK_TYPE((obj), RTGUI_CONTAINER_TYPE))
 
+struct rtgui_hit_grid;
+
 /*
  * the container widget
  */
@@ -50,6 +52,13 @@ struct rtgui_container
     struct rtgui_box *layout_box;
 
     rtgui_list_t children;
+
+    /* the visible extents of opaque children, memoized for clip update */
+    rtgui_region_t cover;
+    rt_uint32_t cover_gen;
+
+    /* the index of children for hit testing, built on demand */
+    struct rtgui_hit_grid *hit_grid;
 };
 typedef struct rtgui_container rtgui_container_t;
 
@@ -71,6 +80,8 @@ rt_bool_t rtgui_container_event_handler(struct rtgui_object *widget, rtgui_event
 
 rt_bool_t rtgui_container_dispatch_event(rtgui_container_t *container, rtgui_event_t *event);
 rt_bool_t rtgui_container_dispatch_mouse_event(rtgui_container_t *container, struct rtgui_event_mouse *event);
+/* the geometry of children is changed, rebuild the hit test index on next use */
+void rtgui_container_invalidate_hit(rtgui_container_t *container);
 
 struct rtgui_object* rtgui_container_get_object(struct rtgui_container *container, rt_uint32_t id);
 #ifdef __cplusplus
@@ -41,8 +41,13 @@ typedef struct rtgui_mouse_monitor rtgui_mouse_monitor_t;
 void rtgui_mouse_init(void);
 void rtgui_mouse_fini(void);
 void rtgui_mouse_moveto(int x, int y);
+/* move cursor, but don't wait for the clients drawing */
+void rtgui_mouse_moveto_nowait(int x, int y);
 /* set cursor position */
 void rtgui_mouse_set_position(int x, int y);
+/* the lock of cursor and window move rect, it may be taken recursively */
+void rtgui_mouse_lock(void);
+void rtgui_mouse_unlock(void);
 
 void rtgui_mouse_set_cursor_enable(rt_bool_t enable);
 void rtgui_mouse_set_cursor(rtgui_image_t *cursor);
@@ -47,10 +47,21 @@ void rtgui_topwin_resize(struct rtgui_win *wid, rtgui_rect_t *r);
 /* a window is entering modal mode */
 rt_err_t rtgui_topwin_modal_enter(struct rtgui_event_win_modal_enter *event);
 
+/* publish the clip and activate state changed since the last flush */
+void rtgui_topwin_flush(void);
+
 /* get window at (x, y) */
 struct rtgui_topwin *rtgui_topwin_get_wnd(int x, int y);
 struct rtgui_topwin *rtgui_topwin_get_wnd_no_modaled(int x, int y);
 
+/* get the last published input map and release it, by the input stage */
+struct rtgui_input_map *rtgui_input_map_get(void);
+void rtgui_input_map_put(struct rtgui_input_map *map);
+/* wait for the input stage to release the old maps */
+void rtgui_input_map_sync(void);
+/* get the window receiving the mouse events at (x, y) */
+struct rtgui_input_target *rtgui_input_map_hit(struct rtgui_input_map *map, int x, int y);
+
 //void rtgui_topwin_deactivate_win(struct rtgui_topwin* win);
 
 /* window title */
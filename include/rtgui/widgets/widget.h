@@ -43,6 +43,8 @@ extern "C" {
 #define RTGUI_WIDGET_FLAG_FOCUSABLE     0x0010
 #define RTGUI_WIDGET_FLAG_DC_VISIBLE    0x0100
 #define RTGUI_WIDGET_FLAG_IN_ANIM       0x0200
+/* skipped by the paint dispatching of parent container */
+#define RTGUI_WIDGET_FLAG_CULLED        0x0400
 
 /* rtgui widget attribute */
 #define RTGUI_WIDGET_FOREGROUND(w)      (RTGUI_WIDGET(w)->gc.foreground)
@@ -104,6 +106,7 @@ struct rtgui_widget
     /* hardware device context */
     rt_ubase_t dc_type;
     const struct rtgui_dc_engine *dc_engine;
+    struct rtgui_dc_scissor *dc_scissor;
 
     /* the graphic context of widget */
     rtgui_gc_t gc;
@@ -114,6 +117,12 @@ struct rtgui_widget
     rtgui_rect_t extent_visiable;
     /* the rect clip information */
     rtgui_region_t clip;
+    /* the generation in which the clip is computed, 0 means it's dirty */
+    rt_uint32_t clip_gen;
+    /* the generation in which a descendant is invalidated */
+    rt_uint32_t tree_gen;
+    /* the opaque part of widget in logic coordinates, RT_NULL means the whole extent */
+    rtgui_region_t *opaque;
 
     /* minimal width and height of widget */
     rt_int16_t min_width, min_height;
@@ -154,6 +163,8 @@ void rtgui_widget_get_extent(rtgui_widget_t *widget, rtgui_rect_t *rect);
 void rtgui_widget_set_minsize(rtgui_widget_t *widget, int width, int height);
 void rtgui_widget_set_minwidth(rtgui_widget_t *widget, int width);
 void rtgui_widget_set_minheight(rtgui_widget_t *widget, int height);
+/* set the opaque part of widget in logic coordinates, RT_NULL for the whole extent */
+void rtgui_widget_set_opaque(rtgui_widget_t *widget, rtgui_region_t *region);
 
 void rtgui_widget_set_parent(rtgui_widget_t *widget, rtgui_widget_t *parent);
 
@@ -175,6 +186,10 @@ void rtgui_widget_move_to_logic(rtgui_widget_t *widget, int dx, int dy);
 
 /* update the clip info of widget */
 void rtgui_widget_update_clip(rtgui_widget_t *widget);
+/* mark the geometry or visibility of widget changed, recomputed in next clip update */
+void rtgui_widget_invalidate_clip(rtgui_widget_t *widget);
+/* update the children of a container widget and clip them from its clip */
+void rtgui_widget_clip_children(rtgui_widget_t *widget);
 
 /* get the toplevel widget of widget */
 struct rtgui_win *rtgui_widget_get_toplevel(rtgui_widget_t *widget);
@@ -185,6 +200,10 @@ rt_bool_t rtgui_widget_onshow(struct rtgui_object *object, struct rtgui_event *e
 void rtgui_widget_hide(rtgui_widget_t *widget);
 rt_bool_t rtgui_widget_onhide(struct rtgui_object *object, struct rtgui_event *event);
 void rtgui_widget_update(rtgui_widget_t *widget);
+/* whether the widget needs to be painted in the current paint of its window */
+rt_bool_t rtgui_widget_is_damaged(rtgui_widget_t *widget);
+/* fill the background of widget, only the damaged part if any */
+void rtgui_widget_fill_damage(rtgui_widget_t *widget, struct rtgui_dc *dc);
 rt_bool_t rtgui_widget_onpaint(struct rtgui_object *object, struct rtgui_event *event);
 
 /* get parent color */
@@ -201,6 +220,11 @@ rt_bool_t rtgui_widget_is_in_animation(rtgui_widget_t *widget);
 /* dump widget information */
 void rtgui_widget_dump(rtgui_widget_t *widget);
 
+#ifdef GUIENGIN_WIDGET_SELFTEST
+/* check the clip update of a widget tree, returns the error count */
+int rtgui_widget_selftest(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
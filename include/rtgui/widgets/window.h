@@ -102,6 +102,16 @@ struct rtgui_win
 
     struct rtgui_region outer_clip;
     struct rtgui_rect outer_extent;
+    /* the clip published by server and not adopted yet, and the one adopted
+     * in outer_clip. Only the pending one is touched by server. */
+    struct rtgui_region_snapshot *clip_pending;
+    struct rtgui_region_snapshot *clip;
+    /* the damage published by server, and the one in painting. The widgets
+     * out of the painting damage don't need to be painted. */
+    struct rtgui_region_snapshot *damage_pending;
+    struct rtgui_region_snapshot *damage;
+    /* the current generation of the widget clips in this window */
+    rt_uint32_t clip_gen;
 
     /* the widget that will grab the focus in current window */
     struct rtgui_widget *focused_widget;
@@ -50,6 +50,8 @@
 #include <rtgui/color.h>
 #include <rtgui/region.h>
 #include <rtgui/dc.h>
+#include <rtgui/rtgui_system.h>
+#include <rtgui/rtgui_app.h>
 
 #include <string.h>
 
@@ -1636,6 +1638,189 @@ static void BlitAlphaColortoARGB888PixelAlpha(struct rtgui_blit_info *info)
     }
 }
 
+/*
+ * Dithering for the conversion from 24 bits color to RGB565. The ordered
+ * dithering adds the threshold of a 4x4 Bayer matrix before truncation; the
+ * error diffusion spreads the truncation error to the neighbour pixels with
+ * Floyd-Steinberg weights. The pattern is anchored at the device position,
+ * so the adjacent blits are seamless.
+ */
+const rt_uint8_t rtgui_blit_dither_bayer[4][4] =
+{
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5},
+};
+RTM_EXPORT(rtgui_blit_dither_bayer);
+
+/* take the error lines of current thread, which are kept for the next blit */
+static rt_int16_t *_dither_err_take(rt_uint32_t size)
+{
+    struct rtgui_app *app = rtgui_app_self();
+    rt_int16_t *err = RT_NULL;
+
+    if (app != RT_NULL && app->dither_err != RT_NULL)
+    {
+        err = app->dither_err;
+        app->dither_err = RT_NULL;
+        if (app->dither_err_size < size)
+        {
+            rtgui_free(err);
+            err = RT_NULL;
+        }
+    }
+    if (err == RT_NULL)
+    {
+        err = (rt_int16_t *)rtgui_malloc(size);
+        if (err == RT_NULL)
+            return RT_NULL;
+        if (app != RT_NULL)
+            app->dither_err_size = size;
+    }
+
+    rt_memset(err, 0, size);
+    return err;
+}
+
+static void _dither_err_give(rt_int16_t *err)
+{
+    struct rtgui_app *app = rtgui_app_self();
+
+    if (app != RT_NULL && app->dither_err == RT_NULL)
+        app->dither_err = err;
+    else
+        rtgui_free(err);
+}
+
+rt_inline rt_uint32_t _dither_clamp(int value)
+{
+    if (value < 0) return 0;
+    if (value > 255) return 255;
+    return value;
+}
+
+/* RGB888/ARGB888 -> RGB565 with dithering */
+static void BlitToRGB565Dither(struct rtgui_blit_info *info)
+{
+    int x, y;
+    int src_bpp = rtgui_color_get_bpp(info->src_fmt);
+    rt_uint8_t *src = info->src;
+    rt_uint16_t *dst = (rt_uint16_t *)info->dst;
+    rt_uint32_t dst_skip = info->dst_skip >> 1;
+    rt_int16_t *err = RT_NULL, *err_next = RT_NULL;
+
+    if (info->dither == RTGUI_DITHER_DIFFUSION)
+    {
+        /* r, g, b error of current and next line, with one pixel guard on both ends */
+        err = _dither_err_take(2 * 3 * (info->dst_w + 2) * sizeof(rt_int16_t));
+        if (err != RT_NULL)
+            err_next = err + 3 * (info->dst_w + 2);
+    }
+
+    for (y = 0; y < info->dst_h; y++)
+    {
+        const rt_uint8_t *bayer = rtgui_blit_dither_bayer[(info->dither_y + y) & 0x03];
+        rt_int16_t *e = RT_NULL, *en = RT_NULL;
+
+        if (err != RT_NULL)
+        {
+            e = err + 3;
+            en = err_next + 3;
+        }
+
+        for (x = 0; x < info->dst_w; x++)
+        {
+            rt_uint32_t srcR, srcG, srcB, srcA;
+            int r, g, b;
+
+            if (info->src_fmt == RTGRAPHIC_PIXEL_FORMAT_ARGB888)
+            {
+                RGBA_FROM_ARGB8888(*(rt_uint32_t *)src, srcR, srcG, srcB, srcA);
+                if (info->a != 255)
+                    srcA = (srcA * info->a + 128) / 255;
+            }
+            else
+            {
+#ifdef PKG_USING_RGB888_PIXEL_BITS_32
+                RGB_FROM_RGB888(*(rt_uint32_t *)src, srcR, srcG, srcB);
+#else
+                RGB_FROM_RGB888(*src, srcR, srcG, srcB);
+#endif
+                srcA = info->a;
+            }
+            src += src_bpp;
+
+            if ((srcA >> 3) == 0)
+            {
+                /* keep original pixel data */
+                dst++;
+                continue;
+            }
+            else if ((srcA >> 3) != (0xFFU >> 3))
+            {
+                rt_uint32_t dstR, dstG, dstB;
+                rt_uint32_t inverse_alpha = 255 - srcA;
+
+                RGB_FROM_RGB565(*dst, dstR, dstG, dstB);
+
+                srcR = ((srcR * srcA) + (inverse_alpha * dstR)) >> 8;
+                srcG = ((srcG * srcA) + (inverse_alpha * dstG)) >> 8;
+                srcB = ((srcB * srcA) + (inverse_alpha * dstB)) >> 8;
+            }
+
+            if (err == RT_NULL)
+            {
+                int t = bayer[(info->dither_x + x) & 0x03];
+
+                /* threshold in the step of 5 and 6 bits channel */
+                r = _dither_clamp(srcR + (t >> 1));
+                g = _dither_clamp(srcG + (t >> 2));
+                b = _dither_clamp(srcB + (t >> 1));
+            }
+            else
+            {
+                int er, eg, eb;
+
+                r = _dither_clamp(srcR + e[x * 3 + 0] / 16);
+                g = _dither_clamp(srcG + e[x * 3 + 1] / 16);
+                b = _dither_clamp(srcB + e[x * 3 + 2] / 16);
+
+                er = r & 0x07;
+                eg = g & 0x03;
+                eb = b & 0x07;
+
+                /* 7/16 to right, 3/16 to bottom left, 5/16 to bottom and 1/16 to bottom right */
+                e[x * 3 + 3] += er * 7; e[x * 3 + 4] += eg * 7; e[x * 3 + 5] += eb * 7;
+                en[x * 3 - 3] += er * 3; en[x * 3 - 2] += eg * 3; en[x * 3 - 1] += eb * 3;
+                en[x * 3 + 0] += er * 5; en[x * 3 + 1] += eg * 5; en[x * 3 + 2] += eb * 5;
+                en[x * 3 + 3] += er; en[x * 3 + 4] += eg; en[x * 3 + 5] += eb;
+            }
+
+            RGB565_FROM_RGB(*dst, r, g, b);
+            dst++;
+        }
+
+        if (err != RT_NULL)
+        {
+            rt_int16_t *t = err;
+
+            err = err_next;
+            err_next = t;
+            rt_memset(err_next, 0, 3 * (info->dst_w + 2) * sizeof(rt_int16_t));
+        }
+
+        src += info->src_skip;
+        dst += dst_skip;
+    }
+
+    if (err != RT_NULL)
+    {
+        /* the buffers may be swapped, give back the lower one */
+        _dither_err_give(err < err_next ? err : err_next);
+    }
+}
+
 void rtgui_blit(struct rtgui_blit_info *info)
 {
     if (info->src_h == 0 ||
@@ -1681,7 +1866,10 @@ void rtgui_blit(struct rtgui_blit_info *info)
         switch (info->dst_fmt)
         {
         case RTGRAPHIC_PIXEL_FORMAT_RGB565:
-            BlitRGB888toRGB565PixelAlpha(info);
+            if (info->dither != RTGUI_DITHER_NONE)
+                BlitToRGB565Dither(info);
+            else
+                BlitRGB888toRGB565PixelAlpha(info);
             break;
         case RTGRAPHIC_PIXEL_FORMAT_RGB888:
             BlitRGB888toRGB888PixelAlpha(info);
@@ -1696,7 +1884,10 @@ void rtgui_blit(struct rtgui_blit_info *info)
         switch (info->dst_fmt)
         {
         case RTGRAPHIC_PIXEL_FORMAT_RGB565:
-            BlitARGB888toRGB565PixelAlpha(info);
+            if (info->dither != RTGUI_DITHER_NONE)
+                BlitToRGB565Dither(info);
+            else
+                BlitARGB888toRGB565PixelAlpha(info);
             break;
         case RTGRAPHIC_PIXEL_FORMAT_RGB888:
             BlitARGB888toRGB888PixelAlpha(info);
@@ -1741,6 +1932,7 @@ void rtgui_image_info_blit(struct rtgui_image_info *image, struct rtgui_dc *dc,
 
         /* fill common info */
         info.a = image->a;
+        info.dither = RTGUI_DC_DITHER(dc);
         info.src_fmt = image->src_fmt;
         info.src_pitch = image->src_pitch;
 
@@ -1763,6 +1955,8 @@ void rtgui_image_info_blit(struct rtgui_image_info *image, struct rtgui_dc *dc,
             info.dst_h = rtgui_rect_height(*r);
             info.dst_w = rtgui_rect_width(*r);
             info.dst_skip = info.dst_pitch - info.dst_w * hw_bpp;
+            info.dither_x = r->x1;
+            info.dither_y = r->y1;
 
             rtgui_blit(&info);
         }
@@ -1783,6 +1977,7 @@ void rtgui_image_info_blit(struct rtgui_image_info *image, struct rtgui_dc *dc,
 
         /* fill common info */
         info.a = image->a;
+        info.dither = RTGUI_DC_DITHER(dc);
         info.src_fmt = image->src_fmt;
         info.src_pitch = image->src_pitch;
 
@@ -1800,40 +1995,36 @@ void rtgui_image_info_blit(struct rtgui_image_info *image, struct rtgui_dc *dc,
         info.dst_h = rtgui_rect_height(*r);
         info.dst_w = rtgui_rect_width(*r);
         info.dst_skip = info.dst_pitch - info.dst_w * hw_bpp;
+        info.dither_x = r->x1;
+        info.dither_y = r->y1;
 
         rtgui_blit(&info);
     }
     else if (dc->type == RTGUI_DC_BUFFER)
     {
         struct rtgui_rect *r;
-        struct rtgui_dc_buffer *dc_buffer = (struct rtgui_dc_buffer*)dc;
 
         bpp = rtgui_color_get_bpp(image->src_fmt);
-        hw_bpp = rtgui_color_get_bpp(dc_buffer->pixel_format);
 
         r = &dest_extent;
 
         /* fill common info */
         info.a = image->a;
+        info.dither = RTGUI_DC_DITHER(dc);
         info.src_fmt = image->src_fmt;
         info.src_pitch = image->src_pitch;
 
-        info.dst_fmt = dc_buffer->pixel_format;
-        info.dst_pitch = dc_buffer->pitch;
-
         /* blit source */
         info.src = image->pixels;
         info.src_w = rtgui_rect_width(*r);
         info.src_h = rtgui_rect_height(*r);
         info.src_skip = info.src_pitch - info.src_w * bpp;
 
-        /* blit destination */
-        info.dst = (rt_uint8_t*)dc_buffer->pixel + r->y1 * dc_buffer->pitch + r->x1 * hw_bpp;
+        /* blit destination, the indexed buffer is drawn through its palette */
         info.dst_w = rtgui_rect_width(*r);
         info.dst_h = rtgui_rect_height(*r);
-        info.dst_skip = info.dst_pitch - info.dst_w * hw_bpp;
 
-        rtgui_blit(&info);
+        rtgui_dc_buffer_blit_info(dc, r->x1, r->y1, &info);
     }
 }
 RTM_EXPORT(rtgui_image_info_blit);
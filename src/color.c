@@ -52,6 +52,8 @@ rt_uint8_t rtgui_color_get_bits(rt_uint8_t pixel_format)
 {
     if (pixel_format <= RTGRAPHIC_PIXEL_FORMAT_ARGB888)
         return pixel_bits_table[pixel_format];
+    if (pixel_format == RTGUI_PIXEL_FORMAT_PAL8)
+        return 8;
 
     /* use 32 as the default */
     return 32;
@@ -66,6 +68,10 @@ rt_uint8_t rtgui_color_get_bpp(rt_uint8_t pixel_format)
     {
         bpp = _UI_BITBYTES(pixel_bits_table[pixel_format]);
     }
+    else if (pixel_format == RTGUI_PIXEL_FORMAT_PAL8)
+    {
+        bpp = 1;
+    }
 
     return bpp;
 }
@@ -28,6 +28,29 @@
 #include <rtgui/widgets/container.h>
 #include <rtgui/widgets/window.h>
 
+/*
+ * The hit test grid divides the container into HIT_GRID_SIZE x HIT_GRID_SIZE
+ * cells, each cell lists the children overlapping it in the order of the
+ * children list. A child is listed in each cell it overlaps.
+ */
+#define HIT_GRID_SIZE   8
+#define HIT_GRID_CELLS  (HIT_GRID_SIZE * HIT_GRID_SIZE)
+
+struct rtgui_hit_grid
+{
+    rt_bool_t valid;
+    /* the children overlap too many cells, the grid doesn't pay off */
+    rt_bool_t linear;
+
+    rtgui_rect_t extent;
+    rt_int16_t cell_w, cell_h;
+
+    /* the children of cell i are items[start[i]] ... items[start[i + 1] - 1] */
+    rt_uint16_t start[HIT_GRID_CELLS + 1];
+    rt_uint16_t capacity;
+    struct rtgui_widget **items;
+};
+
 static void _rtgui_container_constructor(rtgui_container_t *container)
 {
     /* init container */
@@ -37,6 +60,11 @@ static void _rtgui_container_constructor(rtgui_container_t *container)
     rtgui_list_init(&(container->children));
     container->layout_box = RT_NULL;
 
+    rtgui_region_init(&(container->cover));
+    container->cover_gen = 0;
+
+    container->hit_grid = RT_NULL;
+
     RTGUI_WIDGET(container)->flag |= RTGUI_WIDGET_FLAG_FOCUSABLE;
 }
 
@@ -46,6 +74,15 @@ static void _rtgui_container_destructor(rtgui_container_t *container)
 
     if (container->layout_box != RT_NULL)
         rtgui_object_destroy(RTGUI_OBJECT(container->layout_box));
+
+    rtgui_region_fini(&(container->cover));
+
+    if (container->hit_grid != RT_NULL)
+    {
+        rtgui_free(container->hit_grid->items);
+        rtgui_free(container->hit_grid);
+        container->hit_grid = RT_NULL;
+    }
 }
 
 DEFINE_CLASS_TYPE(container, "container",
@@ -55,42 +92,97 @@ DEFINE_CLASS_TYPE(container, "container",
                   sizeof(struct rtgui_container));
 RTM_EXPORT(_rtgui_container);
 
+/*
+ * Mark the children which don't need painting: out of the container, out of
+ * the damage, or hidden by the opaque siblings in front of them. The
+ * children are walked front-to-back, the visible extents (or the opaque
+ * parts) of the opaque ones are collected as the occluder of the ones behind.
+ * The visible extents are only trusted when the clips are up to date.
+ */
+static void _container_paint_cull(rtgui_container_t *container)
+{
+    struct rtgui_list_node *node, *next, *prev;
+    rtgui_rect_t *rect;
+    rtgui_widget_t *child;
+    rtgui_region_t occluder;
+
+    /* the children list is singly linked, reverse it to get the front one */
+    prev = RT_NULL;
+    for (node = container->children.next; node != RT_NULL; node = next)
+    {
+        next = node->next;
+        node->next = prev;
+        prev = node;
+    }
+
+    rtgui_region_init(&occluder);
+    /* and reverse it back on the way */
+    for (node = prev, prev = RT_NULL; node != RT_NULL; node = next)
+    {
+        next = node->next;
+        node->next = prev;
+        prev = node;
+
+        child = rtgui_list_entry(node, struct rtgui_widget, sibling);
+        child->flag &= ~RTGUI_WIDGET_FLAG_CULLED;
+        if (RTGUI_WIDGET_IS_HIDE(child) || child->clip_gen == 0)
+            continue;
+
+        /* the visible extent is inverted if it's out of parent */
+        rect = &(child->extent_visiable);
+        if (rect->x1 >= rect->x2 || rect->y1 >= rect->y2)
+        {
+            child->flag |= RTGUI_WIDGET_FLAG_CULLED;
+            continue;
+        }
+
+        if (!rtgui_widget_is_damaged(child) ||
+            rtgui_region_contains_rectangle(&occluder, rect) == RTGUI_REGION_IN)
+            child->flag |= RTGUI_WIDGET_FLAG_CULLED;
+
+        /* the undamaged child still hides the ones behind it */
+        if (child->flag & (RTGUI_WIDGET_FLAG_TRANSPARENT | RTGUI_WIDGET_FLAG_IN_ANIM))
+            continue;
+
+        if (child->opaque == RT_NULL)
+            rtgui_region_union_rect(&occluder, &occluder, rect);
+        else
+        {
+            rtgui_region_t part;
+
+            rtgui_region_init(&part);
+            rtgui_region_copy(&part, child->opaque);
+            rtgui_region_translate(&part, child->extent.x1, child->extent.y1);
+            rtgui_region_intersect_rect(&part, &part, rect);
+            rtgui_region_union(&occluder, &occluder, &part);
+            rtgui_region_fini(&part);
+        }
+    }
+    container->children.next = prev;
+
+    rtgui_region_fini(&occluder);
+}
+
 rt_bool_t rtgui_container_dispatch_event(rtgui_container_t *container, rtgui_event_t *event)
 {
     /* handle in child widget */
     struct rtgui_list_node *node;
-    rtgui_event_t save_event = *event;
     rtgui_widget_t *widget = (rtgui_widget_t *)container;
 
     if (RTGUI_WIDGET_IS_HIDE(widget))
         return RT_TRUE;
 
+    /* the children are still painted back to front */
+    if (event->type == RTGUI_EVENT_PAINT)
+        _container_paint_cull(container);
+
     rtgui_list_foreach(node, &(container->children))
     {
         struct rtgui_widget *w;
         w = rtgui_list_entry(node, struct rtgui_widget, sibling);
 
-        event->type = save_event.type;
-
-        if (RTGUI_EVENT_PAINT & event->type)
-        {
-            if (widget->extent.x1 > w->extent.x2)
-            {
-                event->type &= !RTGUI_EVENT_PAINT;
-            }
-            else if (widget->extent.x2 < w->extent.x1)
-            {
-                event->type &= !RTGUI_EVENT_PAINT;
-            }
-            else if (widget->extent.y1 > w->extent.y2)
-            {
-                event->type &= !RTGUI_EVENT_PAINT;
-            }
-            else if (widget->extent.y2 < w->extent.y1)
-            {
-                event->type &= !RTGUI_EVENT_PAINT;
-            }
-        }
+        if (event->type == RTGUI_EVENT_PAINT && (w->flag & RTGUI_WIDGET_FLAG_CULLED))
+            continue;
 
         if (RTGUI_OBJECT(w)->event_handler &&
                 RTGUI_OBJECT(w)->event_handler(RTGUI_OBJECT(w), event) == RT_TRUE)
@@ -122,28 +214,177 @@ rt_bool_t rtgui_container_broadcast_event(struct rtgui_container *container, str
 }
 RTM_EXPORT(rtgui_container_broadcast_event);
 
+void rtgui_container_invalidate_hit(rtgui_container_t *container)
+{
+    RT_ASSERT(container != RT_NULL);
+
+    if (container->hit_grid != RT_NULL)
+        container->hit_grid->valid = RT_FALSE;
+}
+RTM_EXPORT(rtgui_container_invalidate_hit);
+
+/* get the cells overlapped by rect, returns RT_FALSE if it's out of grid */
+static rt_bool_t _hit_grid_range(struct rtgui_hit_grid *grid, const rtgui_rect_t *rect,
+                                 int *cx1, int *cy1, int *cx2, int *cy2)
+{
+    rtgui_rect_t part = *rect;
+
+    rtgui_rect_intersect(&(grid->extent), &part);
+    if (part.x1 >= part.x2 || part.y1 >= part.y2)
+        return RT_FALSE;
+
+    *cx1 = (part.x1 - grid->extent.x1) / grid->cell_w;
+    *cy1 = (part.y1 - grid->extent.y1) / grid->cell_h;
+    *cx2 = (part.x2 - 1 - grid->extent.x1) / grid->cell_w;
+    *cy2 = (part.y2 - 1 - grid->extent.y1) / grid->cell_h;
+
+    return RT_TRUE;
+}
+
+static void _hit_grid_build(struct rtgui_hit_grid *grid, rtgui_container_t *container, int num)
+{
+    struct rtgui_list_node *node;
+    struct rtgui_widget *w;
+    rt_uint16_t fill[HIT_GRID_CELLS];
+    int cx1, cy1, cx2, cy2, x, y, cell, total;
+
+    grid->valid = RT_TRUE;
+    grid->linear = RT_TRUE;
+    grid->extent = RTGUI_WIDGET(container)->extent;
+    grid->cell_w = (rtgui_rect_width(grid->extent) + HIT_GRID_SIZE - 1) / HIT_GRID_SIZE;
+    grid->cell_h = (rtgui_rect_height(grid->extent) + HIT_GRID_SIZE - 1) / HIT_GRID_SIZE;
+    if (grid->cell_w <= 0 || grid->cell_h <= 0)
+        return;
+
+    /* count the children of each cell */
+    rt_memset(grid->start, 0, sizeof(grid->start));
+    rtgui_list_foreach(node, &(container->children))
+    {
+        w = rtgui_list_entry(node, struct rtgui_widget, sibling);
+        if (!_hit_grid_range(grid, &(w->extent), &cx1, &cy1, &cx2, &cy2))
+            continue;
+
+        for (y = cy1; y <= cy2; y ++)
+            for (x = cx1; x <= cx2; x ++)
+                grid->start[y * HIT_GRID_SIZE + x + 1] ++;
+    }
+
+    total = 0;
+    for (cell = 0; cell < HIT_GRID_CELLS; cell ++)
+    {
+        fill[cell] = total;
+        total += grid->start[cell + 1];
+        grid->start[cell + 1] = total;
+    }
+
+    /* large children make the grid no better than the list */
+    if (total > num * 4 + HIT_GRID_CELLS || total > 0xffff)
+        return;
+
+    if (total > grid->capacity)
+    {
+        struct rtgui_widget **items;
+
+        items = (struct rtgui_widget **) rtgui_realloc(grid->items, total * sizeof(struct rtgui_widget *));
+        if (items == RT_NULL)
+            return;
+        grid->items = items;
+        grid->capacity = total;
+    }
+
+    rtgui_list_foreach(node, &(container->children))
+    {
+        w = rtgui_list_entry(node, struct rtgui_widget, sibling);
+        if (!_hit_grid_range(grid, &(w->extent), &cx1, &cy1, &cx2, &cy2))
+            continue;
+
+        for (y = cy1; y <= cy2; y ++)
+            for (x = cx1; x <= cx2; x ++)
+                grid->items[fill[y * HIT_GRID_SIZE + x] ++] = w;
+    }
+
+    grid->linear = RT_FALSE;
+}
+
+/* get the hit test grid of container, RT_NULL if the list should be used */
+static struct rtgui_hit_grid *_container_get_hit_grid(rtgui_container_t *container)
+{
+    struct rtgui_hit_grid *grid = container->hit_grid;
+
+    if (grid == RT_NULL || !grid->valid)
+    {
+        struct rtgui_list_node *node;
+        int num = 0;
+
+        rtgui_list_foreach(node, &(container->children))
+            num ++;
+        if (num < GUIENGIN_HIT_GRID_CHILDREN)
+            return RT_NULL;
+
+        if (grid == RT_NULL)
+        {
+            grid = (struct rtgui_hit_grid *) rtgui_malloc(sizeof(struct rtgui_hit_grid));
+            if (grid == RT_NULL)
+                return RT_NULL;
+
+            grid->capacity = 0;
+            grid->items = RT_NULL;
+            container->hit_grid = grid;
+        }
+        _hit_grid_build(grid, container, num);
+    }
+
+    return grid->linear ? RT_NULL : grid;
+}
+
+rt_inline rt_bool_t _container_dispatch_mouse_to(struct rtgui_widget *w,
+        struct rtgui_widget *old_focus,
+        struct rtgui_event_mouse *event)
+{
+    if (rtgui_rect_contains_point(&(w->extent), event->x, event->y) != RT_EOK)
+        return RT_FALSE;
+
+    if ((old_focus != w) && RTGUI_WIDGET_IS_FOCUSABLE(w))
+        rtgui_widget_focus(w);
+
+    return RTGUI_OBJECT(w)->event_handler &&
+           RTGUI_OBJECT(w)->event_handler(RTGUI_OBJECT(w), (rtgui_event_t *)event) == RT_TRUE;
+}
+
 rt_bool_t rtgui_container_dispatch_mouse_event(rtgui_container_t *container, struct rtgui_event_mouse *event)
 {
     /* handle in child widget */
     struct rtgui_list_node *node;
     struct rtgui_widget *old_focus;
+    struct rtgui_hit_grid *grid;
 
     old_focus = RTGUI_WIDGET(container)->toplevel->focused_widget;
 
-    rtgui_list_foreach(node, &(container->children))
+    grid = _container_get_hit_grid(container);
+    if (grid != RT_NULL && rtgui_rect_contains_point(&(grid->extent), event->x, event->y) == RT_EOK)
     {
-        struct rtgui_widget *w;
-        w = rtgui_list_entry(node, struct rtgui_widget, sibling);
-        if (rtgui_rect_contains_point(&(w->extent),
-                                      event->x, event->y) == RT_EOK)
+        int index, cell;
+
+        cell = (event->y - grid->extent.y1) / grid->cell_h * HIT_GRID_SIZE +
+               (event->x - grid->extent.x1) / grid->cell_w;
+        for (index = grid->start[cell]; index < grid->start[cell + 1]; index ++)
         {
-            if ((old_focus != w) && RTGUI_WIDGET_IS_FOCUSABLE(w))
-                rtgui_widget_focus(w);
-            if (RTGUI_OBJECT(w)->event_handler &&
-                    RTGUI_OBJECT(w)->event_handler(RTGUI_OBJECT(w),
-                                                   (rtgui_event_t *)event) == RT_TRUE)
+            if (_container_dispatch_mouse_to(grid->items[index], old_focus, event))
                 return RT_TRUE;
+            /* the children are changed by the handler */
+            if (!grid->valid)
+                break;
         }
+
+        return RT_FALSE;
+    }
+
+    rtgui_list_foreach(node, &(container->children))
+    {
+        struct rtgui_widget *w;
+        w = rtgui_list_entry(node, struct rtgui_widget, sibling);
+        if (_container_dispatch_mouse_to(w, old_focus, event))
+            return RT_TRUE;
     }
 
     return RT_FALSE;
@@ -166,15 +407,13 @@ rt_bool_t rtgui_container_event_handler(struct rtgui_object *object, struct rtgu
     case RTGUI_EVENT_PAINT:
     {
         struct rtgui_dc *dc;
-        struct rtgui_rect rect;
 
         dc = rtgui_dc_begin_drawing(widget);
         if (dc == RT_NULL)
             return RT_FALSE;
-        rtgui_widget_get_rect(widget, &rect);
 
         /* fill container with background */
-        rtgui_dc_fill_rect(dc, &rect);
+        rtgui_widget_fill_damage(widget, dc);
 
         /* paint on each child */
         rtgui_container_dispatch_event(container, event);
@@ -258,6 +497,7 @@ void rtgui_container_add_child(rtgui_container_t *container, rtgui_widget_t *chi
     child->parent = RTGUI_WIDGET(container);
     /* put widget to parent's children list */
     rtgui_list_append(&(container->children), &(child->sibling));
+    rtgui_widget_invalidate_clip(child);
 
     /* update children toplevel */
     if (RTGUI_WIDGET(container)->toplevel != RT_NULL)
@@ -294,6 +534,7 @@ void rtgui_container_remove_child(rtgui_container_t *container, rtgui_widget_t *
     /* set parent and toplevel widget */
     child->parent = RT_NULL;
     child->toplevel = RT_NULL;
+    rtgui_widget_invalidate_clip(RTGUI_WIDGET(container));
 
     /* update window clip */
     if (RTGUI_WIDGET(container)->toplevel)
@@ -338,6 +579,7 @@ void rtgui_container_destroy_children(rtgui_container_t *container)
     }
 
     container->children.next = RT_NULL;
+    rtgui_widget_invalidate_clip(RTGUI_WIDGET(container));
 
     /* update widget clip */
     rtgui_win_update_clip(RTGUI_WIN(RTGUI_WIDGET(container)->toplevel));
@@ -25,13 +25,13 @@
  * 2011-04-25     Bernard      fix fill polygon issue, which found by loveic
  */
 
-/* for sin/cos etc */
-#include <math.h>
-
 #include <rtgui/dc.h>
+#include <rtgui/blit.h>
 
 #include <rtgui/rtgui_system.h>
 #include <rtgui/rtgui_server.h>
+#include <rtgui/shape_cache.h>
+#include <rtgui/trace.h>
 #include <rtgui/widgets/window.h>
 #include <rtgui/widgets/title.h>
 
@@ -217,6 +217,61 @@ void rtgui_dc_draw_round_rect(struct rtgui_dc *dc, struct rtgui_rect *rect, int
 }
 RTM_EXPORT(rtgui_dc_draw_round_rect);
 
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+static void _dc_round_corner_render(struct rtgui_dc *sprite, const struct rtgui_shape_key *key)
+{
+    RTGUI_DC_FC(sprite) = key->fc;
+    rtgui_dc_fill_circle(sprite, key->radius, key->radius, key->radius);
+}
+
+/*
+ * blit the quarters of a cached disc on the corners of rect. The disc is
+ * 2 * r + 1 wide like the one filled by rtgui_dc_fill_circle, so the right
+ * quarters are one pixel wider, and the bottom halves are blitted in whole
+ * as the last row of disc is out of the filled rects.
+ */
+static rt_bool_t _dc_fill_round_corner(struct rtgui_dc *dc, struct rtgui_rect *rect, int r)
+{
+    struct rtgui_shape_key key;
+    struct rtgui_shape_item *item;
+    struct rtgui_point point;
+    struct rtgui_rect corner;
+
+    /* the translucent color is written without blending by fill_circle */
+    if (r <= 0 || RTGUI_RGB_A(RTGUI_DC_FC(dc)) != 255 || !rtgui_shape_cache_check(dc))
+        return RT_FALSE;
+
+    rt_memset(&key, 0, sizeof(key));
+    key.type = RTGUI_SHAPE_ROUND_CORNER;
+    key.pixel_format = rtgui_dc_get_pixel_format(dc);
+    key.radius = r;
+    key.width = key.height = 2 * r + 1;
+    key.fc = RTGUI_DC_FC(dc);
+
+    item = rtgui_shape_cache_get(&key, _dc_round_corner_render);
+    if (item == RT_NULL) return RT_FALSE;
+
+    point.x = 0; point.y = 0;
+    rtgui_rect_set(&corner, rect->x1, rect->y1, r, r);
+    rtgui_dc_blit(item->sprite, &point, dc, &corner);
+
+    point.x = r; point.y = 0;
+    rtgui_rect_set(&corner, rect->x2 - r, rect->y1, r + 1, r);
+    rtgui_dc_blit(item->sprite, &point, dc, &corner);
+
+    point.x = 0; point.y = r;
+    rtgui_rect_set(&corner, rect->x1, rect->y2 - r, 2 * r + 1, r + 1);
+    rtgui_dc_blit(item->sprite, &point, dc, &corner);
+
+    rtgui_rect_set(&corner, rect->x2 - 2 * r, rect->y2 - r, 2 * r + 1, r + 1);
+    rtgui_dc_blit(item->sprite, &point, dc, &corner);
+
+    rtgui_shape_cache_put(item);
+
+    return RT_TRUE;
+}
+#endif
+
 void rtgui_dc_fill_round_rect(struct rtgui_dc *dc, struct rtgui_rect *rect, int r)
 {
     struct rtgui_rect rect_temp;
@@ -243,6 +298,11 @@ void rtgui_dc_fill_round_rect(struct rtgui_dc *dc, struct rtgui_rect *rect, int
         rect_temp.y2 = rect->y2 - r;
         rtgui_dc_fill_rect_forecolor(dc, &rect_temp);//fill rect with foreground
 
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+        if (_dc_fill_round_corner(dc, rect, r) == RT_TRUE)
+            return;
+#endif
+
         rtgui_dc_fill_circle(dc, rect->x1 + r, rect->y1 + r, r);
         rtgui_dc_fill_circle(dc, rect->x2 - r, rect->y2 - r, r);
         rtgui_dc_fill_circle(dc, rect->x2 - r, rect->y1 + r, r);
@@ -266,10 +326,102 @@ void rtgui_dc_draw_shaded_rect(struct rtgui_dc *dc, rtgui_rect_t *rect,
 }
 RTM_EXPORT(rtgui_dc_draw_shaded_rect);
 
+/* get the bits of each channel on the low bit depth format, 0 for mono */
+static rt_bool_t _dc_dither_bits(rt_uint8_t pixel_format, int *rbits, int *gbits, int *bbits)
+{
+    switch (pixel_format)
+    {
+    case RTGRAPHIC_PIXEL_FORMAT_MONO:
+        *rbits = *gbits = *bbits = 0;
+        break;
+    case RTGRAPHIC_PIXEL_FORMAT_RGB332:
+        *rbits = 3; *gbits = 3; *bbits = 2;
+        break;
+    case RTGRAPHIC_PIXEL_FORMAT_RGB444:
+        *rbits = 4; *gbits = 4; *bbits = 4;
+        break;
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565P:
+        *rbits = 5; *gbits = 6; *bbits = 5;
+        break;
+    case RTGRAPHIC_PIXEL_FORMAT_RGB666:
+        *rbits = 6; *gbits = 6; *bbits = 6;
+        break;
+    default:
+        return RT_FALSE;
+    }
+
+    return RT_TRUE;
+}
+
+/* quantize a 8.8 fixed point channel with the Bayer threshold @t */
+rt_inline int _dc_dither_channel(int value, int bits, int t)
+{
+    int step = 1 << (8 - bits);
+
+    value = (value + (2 * t + 1) * step * 8) >> 8;
+    if (value > 255) value = 255;
+
+    return value & ~(step - 1);
+}
+
+/*
+ * The gradient on low bit depth target is dithered with 4x4 Bayer matrix,
+ * then each line has 4 colors at most and is drawn as the runs of color.
+ */
+static void _dc_fill_gradient_dither(struct rtgui_dc *dc, rtgui_rect_t *rect,
+                                     rtgui_color_t c1, rtgui_color_t c2,
+                                     int rbits, int gbits, int bbits)
+{
+    int x, y, index, step;
+    rtgui_color_t colors[4];
+
+    step = rtgui_rect_height(*rect);
+
+    for (y = rect->y1; y < rect->y2; y++)
+    {
+        /* the color of this line in 8.8 fixed point */
+        int r = RTGUI_RGB_R(c1) * 256 + ((int)RTGUI_RGB_R(c2) - RTGUI_RGB_R(c1)) * 256 * (y - rect->y1) / step;
+        int g = RTGUI_RGB_G(c1) * 256 + ((int)RTGUI_RGB_G(c2) - RTGUI_RGB_G(c1)) * 256 * (y - rect->y1) / step;
+        int b = RTGUI_RGB_B(c1) * 256 + ((int)RTGUI_RGB_B(c2) - RTGUI_RGB_B(c1)) * 256 * (y - rect->y1) / step;
+
+        for (index = 0; index < 4; index ++)
+        {
+            int t = rtgui_blit_dither_bayer[y & 0x03][(rect->x1 + index) & 0x03];
+
+            if (rbits == 0)
+            {
+                /* luminance against the threshold */
+                int l = (r * 77 + g * 150 + b * 29) >> 8;
+
+                colors[index] = (l + (2 * t + 1) * 8 * 256 >= 256 * 256) ? white : black;
+            }
+            else
+            {
+                colors[index] = RTGUI_RGB(_dc_dither_channel(r, rbits, t),
+                                          _dc_dither_channel(g, gbits, t),
+                                          _dc_dither_channel(b, bbits, t));
+            }
+        }
+
+        /* draw the runs of same color */
+        for (x = rect->x1; x < rect->x2; x = index)
+        {
+            RTGUI_DC_FC(dc) = colors[(x - rect->x1) & 0x03];
+            for (index = x + 1; index < rect->x2; index ++)
+            {
+                if (colors[(index - rect->x1) & 0x03] != RTGUI_DC_FC(dc)) break;
+            }
+            rtgui_dc_draw_hline(dc, x, index, y);
+        }
+    }
+}
+
 void rtgui_dc_fill_gradient_rectv(struct rtgui_dc *dc, rtgui_rect_t *rect,
                                   rtgui_color_t c1, rtgui_color_t c2)
 {
     int y, step;
+    int rbits, gbits, bbits;
     rtgui_color_t fc;
 
     RT_ASSERT(dc != RT_NULL);
@@ -278,6 +430,15 @@ void rtgui_dc_fill_gradient_rectv(struct rtgui_dc *dc, rtgui_rect_t *rect,
     step = rtgui_rect_height(*rect);
     fc = RTGUI_DC_FC(dc);
 
+    if (RTGUI_DC_DITHER(dc) != RTGUI_DITHER_NONE &&
+        RTGUI_RGB_A(c1) == 255 && RTGUI_RGB_A(c2) == 255 &&
+        _dc_dither_bits(rtgui_dc_get_pixel_format(dc), &rbits, &gbits, &bbits))
+    {
+        _dc_fill_gradient_dither(dc, rect, c1, c2, rbits, gbits, bbits);
+        RTGUI_DC_FC(dc) = fc;
+        return;
+    }
+
     for (y = rect->y1; y < rect->y2; y++)
     {
         RTGUI_DC_FC(dc) = RTGUI_ARGB(((int)RTGUI_RGB_A(c2) - RTGUI_RGB_A(c1)) * (y - rect->y1) / step + RTGUI_RGB_A(c1),
@@ -668,237 +829,391 @@ void rtgui_dc_fill_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_in
 }
 RTM_EXPORT(rtgui_dc_fill_circle);
 
-void rtgui_dc_draw_arc(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end)
+/*
+ * The arc, pie and annulus are rasterized by a sector span generator: every
+ * scan line of the shape is the span of outer circle, minus the span of inner
+ * circle, clipped by the half planes of the start and end angle. All of the
+ * computation is in fixed point and the spans are drawn by hline.
+ *
+ * The angle is in degree, 0 is +x and it grows towards +y.
+ */
+#define SECTOR_ONE      (1 << 14)
+#define SECTOR_INF      0x7fffff
+#define SECTOR_COVER    256
+
+/* sin(i degree) in Q14 */
+static const rt_int16_t _sector_sin[91] =
 {
-    rt_int16_t cx = 0;
-    rt_int16_t cy = r;
-    rt_int16_t df = 1 - r;
-    rt_int16_t d_e = 3;
-    rt_int16_t d_se = -2 * r + 5;
-    rt_int16_t xpcx, xmcx, xpcy, xmcy;
-    rt_int16_t ypcy, ymcy, ypcx, ymcx;
-    rt_uint8_t drawoct;
-    int startoct, endoct, oct, stopval_start, stopval_end;
-    double temp;
-
-    stopval_start = 0;
-    stopval_end = 0;
-    temp = 0;
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384,
+};
 
-    /* Sanity check radius */
-    if (r < 0) return ;
-    /* Special case for r=0 - draw a point */
-    if (r == 0)
+struct _sector
+{
+    int sx, sy;     /* direction of start angle in Q14 */
+    int ex, ey;     /* direction of end angle in Q14 */
+    int sweep;      /* 0 < sweep <= 360 */
+};
+
+static int _sector_sin_deg(int angle)
+{
+    angle %= 360;
+    if (angle < 0) angle += 360;
+
+    if (angle <= 90)  return _sector_sin[angle];
+    if (angle <= 180) return _sector_sin[180 - angle];
+    if (angle <= 270) return -_sector_sin[angle - 180];
+    return -_sector_sin[360 - angle];
+}
+
+static rt_uint32_t _sector_isqrt(rt_uint32_t value)
+{
+    rt_uint32_t result = 0, bit = 1UL << 30;
+
+    while (bit > value) bit >>= 2;
+    while (bit)
     {
-        rtgui_dc_draw_point(dc, x, y);
-        return;
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
     }
 
-    /*
-     * Draw arc
-     * Octant labelling
-     *
-     *  \ 5 | 6 /
-     *   \  |  /
-     *  4 \ | / 7
-     *     \|/
-     *------+------ +x
-     *     /|\
-     *  3 / | \ 0
-     *   /  |  \
-     *  / 2 | 1 \
-     *      +y
-     */
+    return result;
+}
+
+/* r * v / SECTOR_ONE, rounded to the nearest */
+rt_inline int _sector_scale(int r, int v)
+{
+    int p = r * v;
+
+    return p >= 0 ? (p + SECTOR_ONE / 2) / SECTOR_ONE : -((SECTOR_ONE / 2 - p) / SECTOR_ONE);
+}
+
+/* floor(a / b), b > 0 */
+rt_inline int _sector_floor_div(int a, int b)
+{
+    return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+/* returns RT_FALSE if the sector is empty */
+static rt_bool_t _sector_init(struct _sector *sec, int start, int end)
+{
+    sec->sweep = (end - start) % 360;
+    if (sec->sweep < 0) sec->sweep += 360;
+    if (sec->sweep == 0)
+    {
+        if (start == end)
+            return RT_FALSE;
+        sec->sweep = 360;
+    }
+
+    sec->sx = _sector_sin_deg(start + 90);
+    sec->sy = _sector_sin_deg(start);
+    sec->ex = _sector_sin_deg(end + 90);
+    sec->ey = _sector_sin_deg(end);
+
+    return RT_TRUE;
+}
+
+/* the pixels of k * x <= c on a scan line, as [lo, hi] */
+static void _sector_half_plane(int k, int c, int *lo, int *hi)
+{
+    *lo = -SECTOR_INF;
+    *hi = SECTOR_INF;
+
+    if (k > 0)
+        *hi = _sector_floor_div(c, k);
+    else if (k < 0)
+        *lo = -_sector_floor_div(c, -k);
+    else if (c < 0)
+        *lo = SECTOR_INF; /* empty */
+}
+
+/* the largest x with x * x + y * y <= r2, or -1 */
+rt_inline int _sector_half_width(int r2, int y)
+{
+    r2 -= y * y;
+    if (r2 < 0) return -1;
 
-    drawoct = 0; // 0x00000000
-    // whether or not to keep drawing a given octant.
-    // For example: 0x00111100 means we're drawing in octants 2-5
+    return (int)_sector_isqrt((rt_uint32_t)r2);
+}
 
-    // 0 <= start & end < 360; note that sometimes start > end - if so, arc goes back through 0.
-    while (start < 0) start += 360;
-    while (end < 0) end += 360;
-    /* Fixup angles */
-    start = start % 360;
-    end = end % 360;
+/*
+ * Get the spans of scan line @y, the pixels of the spans are:
+ *   x^2 + y^2 <= rout2 && x^2 + y^2 > rin2 &&
+ *   cross(start, p) >= bias && cross(p, end) >= bias (|| if sweep > 180)
+ * The spans are sorted and saved in @spans as [lo, hi] pairs.
+ */
+static int _sector_spans(const struct _sector *sec, int y, int rout2, int rin2,
+                         int bias, int spans[8])
+{
+    int ring[4], arc[4];
+    int nring, narc, i, j, n = 0;
+    int wo, wi;
 
+    wo = _sector_half_width(rout2, y);
+    if (wo < 0) return 0;
 
-    // now, we find which octants we're drawing in.
-    startoct = start / 45;
-    endoct = end / 45;
-    oct = startoct - 1; // we increment as first step in loop
+    wi = _sector_half_width(rin2, y);
+    if (wi < 0)
+    {
+        ring[0] = -wo; ring[1] = wo;
+        nring = 1;
+    }
+    else if (wi >= wo)
+    {
+        return 0;
+    }
+    else
+    {
+        ring[0] = -wo;     ring[1] = -wi - 1;
+        ring[2] = wi + 1;  ring[3] = wo;
+        nring = 2;
+    }
 
-    //stopval_start, stopval_end; // what values of cx to stop at.
-    do
+    if (sec->sweep >= 360)
+    {
+        arc[0] = -SECTOR_INF; arc[1] = SECTOR_INF;
+        narc = 1;
+    }
+    else
     {
-        oct = (oct + 1) % 8;
+        int alo, ahi, blo, bhi;
+
+        /* sx * y - sy * x >= bias, ey * x - ex * y >= bias */
+        _sector_half_plane(sec->sy, sec->sx * y - bias, &alo, &ahi);
+        _sector_half_plane(-sec->ey, -sec->ex * y - bias, &blo, &bhi);
 
-        if (oct == startoct)
+        if (sec->sweep <= 180)
         {
-            // need to compute stopval_start for this octant.  Look at picture above if this is unclear
-            switch (oct)
+            arc[0] = alo > blo ? alo : blo;
+            arc[1] = ahi < bhi ? ahi : bhi;
+            narc = 1;
+        }
+        else if (alo > bhi + 1 || blo > ahi + 1)
+        {
+            /* two disjoint pieces */
+            if (alo > blo)
+            {
+                arc[0] = blo; arc[1] = bhi;
+                arc[2] = alo; arc[3] = ahi;
+            }
+            else
             {
-            case 0:
-            case 3:
-                temp = sin(start * M_PI / 180);
-                break;
-            case 1:
-            case 6:
-                temp = cos(start * M_PI / 180);
-                break;
-            case 2:
-            case 5:
-                temp = -cos(start * M_PI / 180);
-                break;
-            case 4:
-            case 7:
-                temp = -sin(start * M_PI / 180);
-                break;
+                arc[0] = alo; arc[1] = ahi;
+                arc[2] = blo; arc[3] = bhi;
             }
-            temp *= r;
-            stopval_start = (int)temp; // always round down.
-            // This isn't arbitrary, but requires graph paper to explain well.
-            // The basic idea is that we're always changing drawoct after we draw, so we
-            // stop immediately after we render the last sensible pixel at x = ((int)temp).
-
-            // and whether to draw in this octant initially
-            if (oct % 2) drawoct |= (1 << oct); // this is basically like saying drawoct[oct] = true, if drawoct were a bool array
-            else         drawoct &= 255 - (1 << oct); // this is basically like saying drawoct[oct] = false
+            narc = 2;
+        }
+        else
+        {
+            arc[0] = alo < blo ? alo : blo;
+            arc[1] = ahi > bhi ? ahi : bhi;
+            narc = 1;
         }
+    }
 
-        if (oct == endoct)
+    for (i = 0; i < nring; i++)
+    {
+        for (j = 0; j < narc; j++)
         {
-            // need to compute stopval_end for this octant
-            switch (oct)
+            int lo = ring[2 * i] > arc[2 * j] ? ring[2 * i] : arc[2 * j];
+            int hi = ring[2 * i + 1] < arc[2 * j + 1] ? ring[2 * i + 1] : arc[2 * j + 1];
+
+            if (lo <= hi)
             {
-            case 0:
-            case 3:
-                temp = sin(end * M_PI / 180);
-                break;
-            case 1:
-            case 6:
-                temp = cos(end * M_PI / 180);
-                break;
-            case 2:
-            case 5:
-                temp = -cos(end * M_PI / 180);
-                break;
-            case 4:
-            case 7:
-                temp = -sin(end * M_PI / 180);
-                break;
+                spans[n++] = lo;
+                spans[n++] = hi;
             }
-            temp *= r;
-            stopval_end = (int)temp;
+        }
+    }
+
+    return n / 2;
+}
+
+/* the coverage of pixel (x, y) on the edges of sector, in [0, SECTOR_COVER] */
+static int _sector_coverage(const struct _sector *sec, int x, int y, int r1, int r2)
+{
+    int n = x * x + y * y;
+    int s = (int)_sector_isqrt((rt_uint32_t)n);
+    int cover = SECTOR_COVER, c;
+
+    /* the distance to circle edge: d - r = (n - r^2) / (d + r) */
+    if (n > r2 * r2)
+    {
+        c = SECTOR_COVER - (n - r2 * r2) * (2 * SECTOR_COVER) / (2 * (s + r2) + 1);
+        if (c < cover) cover = c;
+    }
+    if (r1 > 0 && n < r1 * r1)
+    {
+        c = SECTOR_COVER + (n - r1 * r1) * (2 * SECTOR_COVER) / (2 * (s + r1) + 1);
+        if (c < cover) cover = c;
+    }
+
+    if (sec->sweep < 360)
+    {
+        int a = (sec->sx * y - sec->sy * x) / (SECTOR_ONE / SECTOR_COVER) + SECTOR_COVER / 2;
+        int b = (sec->ey * x - sec->ex * y) / (SECTOR_ONE / SECTOR_COVER) + SECTOR_COVER / 2;
+
+        if (sec->sweep <= 180)
+            c = a < b ? a : b;
+        else
+            c = a > b ? a : b;
+        if (c < cover) cover = c;
+    }
+
+    if (cover < 0) cover = 0;
+    if (cover > SECTOR_COVER) cover = SECTOR_COVER;
+
+    return cover;
+}
+
+static void _sector_fill_aa(struct rtgui_dc *dc, const struct _sector *sec,
+                            int cx, int cy, int r1, int r2)
+{
+    int y, i, j, x, nt, nf;
+    int touch[8], full[8];
+    int tout2, tin2, fout2, fin2;
+    rtgui_color_t color = RTGUI_DC_FC(dc);
+    rt_uint8_t r = RTGUI_RGB_R(color), g = RTGUI_RGB_G(color);
+    rt_uint8_t b = RTGUI_RGB_B(color), a = RTGUI_RGB_A(color);
+
+    /* the pixels touched by the shape and the pixels fully covered */
+    tout2 = (r2 + 1) * (r2 + 1) - 1;
+    fout2 = r2 * r2;
+    tin2 = r1 > 0 ? (r1 - 1) * (r1 - 1) : -1;
+    fin2 = r1 > 0 ? r1 * r1 - 1 : -1;
+
+    for (y = -r2 - 1; y <= r2 + 1; y++)
+    {
+        nt = _sector_spans(sec, y, tout2, tin2, -SECTOR_ONE / 2 + 1, touch);
+        nf = _sector_spans(sec, y, fout2, fin2, SECTOR_ONE / 2, full);
+
+        for (i = 0; i < nt; i++)
+        {
+            x = touch[2 * i];
 
-            // and whether to draw in this octant initially
-            if (startoct == endoct)
+            for (j = 0; j <= nf; j++)
             {
-                // note:      we start drawing, stop, then start again in this case
-                // otherwise: we only draw in this octant, so initialize it to false, it will get set back to true
-                if (start > end)
+                int lo = j < nf ? full[2 * j] : touch[2 * i + 1] + 1;
+                int hi = j < nf ? full[2 * j + 1] : touch[2 * i + 1];
+
+                if (hi < x) continue;
+                if (lo > touch[2 * i + 1] + 1) lo = touch[2 * i + 1] + 1;
+
+                /* the edge pixels */
+                for (; x < lo; x++)
+                {
+                    int cover = _sector_coverage(sec, x, y, r1, r2);
+
+                    if (cover > 0)
+                        rtgui_dc_blend_point(dc, cx + x, cy + y, RTGUI_BLENDMODE_BLEND,
+                                             r, g, b, (rt_uint8_t)((cover * a) / SECTOR_COVER));
+                }
+
+                if (hi > touch[2 * i + 1]) hi = touch[2 * i + 1];
+                if (x > hi) continue;
+
+                /* the solid span */
+                if (a == 255)
                 {
-                    // unfortunately, if we're in the same octant and need to draw over the whole circle,
-                    // we need to set the rest to true, because the while loop will end at the bottom.
-                    drawoct = 255;
+                    rtgui_dc_draw_hline(dc, cx + x, cx + hi + 1, cy + y);
                 }
                 else
                 {
-                    drawoct &= 255 - (1 << oct);
+                    struct rtgui_rect span;
+
+                    rtgui_rect_init(&span, cx + x, cy + y, hi - x + 1, 1);
+                    rtgui_dc_blend_fill_rect(dc, &span, RTGUI_BLENDMODE_BLEND, color);
                 }
+                x = hi + 1;
             }
-            else if (oct % 2) drawoct &= 255 - (1 << oct);
-            else              drawoct |= (1 << oct);
-        }
-        else if (oct != startoct)     // already verified that it's != endoct
-        {
-            drawoct |= (1 << oct); // draw this entire segment
         }
     }
-    while (oct != endoct);
+}
 
-    // so now we have what octants to draw and when to draw them.  all that's left is the actual raster code.
-    do
+/*
+ * Fill the sector of annulus between radius r1 and r2 from @start to @end.
+ * The pixel centers within r1 - 0.5 < d <= r2 + 0.5 are filled, so r1 == r2
+ * makes an one pixel arc.
+ */
+static void _dc_fill_sector(struct rtgui_dc *dc, int cx, int cy, int r1, int r2,
+                            int start, int end, rt_bool_t aa)
+{
+    int y, i, n;
+    int rout2, rin2;
+    int spans[8];
+    struct _sector sec;
+
+    if (dc == RT_NULL || r2 < 0) return;
+    if (r1 > r2)
     {
-        ypcy = y + cy;
-        ymcy = y - cy;
-        if (cx > 0)
-        {
-            xpcx = x + cx;
-            xmcx = x - cx;
-            // always check if we're drawing a certain octant before adding a pixel to that octant.
-            if (drawoct & 4)  rtgui_dc_draw_point(dc, xmcx, ypcy); // drawoct & 4 = 22; drawoct[2]
-            if (drawoct & 2)  rtgui_dc_draw_point(dc, xpcx, ypcy);
-            if (drawoct & 32) rtgui_dc_draw_point(dc, xmcx, ymcy);
-            if (drawoct & 64) rtgui_dc_draw_point(dc, xpcx, ymcy);
-        }
-        else
-        {
-            if (drawoct & 6)  rtgui_dc_draw_point(dc, x, ypcy); // 4 + 2; drawoct[2] || drawoct[1]
-            if (drawoct & 96) rtgui_dc_draw_point(dc, x, ymcy); // 32 + 64
-        }
+        i = r1; r1 = r2; r2 = i;
+    }
+    if (r1 < 0) r1 = 0;
 
-        xpcy = x + cy;
-        xmcy = x - cy;
-        if (cx > 0 && cx != cy)
-        {
-            ypcx = y + cx;
-            ymcx = y - cx;
-            if (drawoct & 8)   rtgui_dc_draw_point(dc, xmcy, ypcx);
-            if (drawoct & 1)   rtgui_dc_draw_point(dc, xpcy, ypcx);
-            if (drawoct & 16)  rtgui_dc_draw_point(dc, xmcy, ymcx);
-            if (drawoct & 128) rtgui_dc_draw_point(dc, xpcy, ymcx);
-        }
-        else if (cx == 0)
-        {
-            if (drawoct & 24)  rtgui_dc_draw_point(dc, xmcy, y); // 8 + 16
-            if (drawoct & 129) rtgui_dc_draw_point(dc, xpcy, y); // 1 + 128
-        }
+    if (_sector_init(&sec, start, end) == RT_FALSE)
+        return;
 
-        /*
-         * Update whether we're drawing an octant
-         */
-        if (stopval_start == cx)
-        {
-            // works like an on-off switch because start & end may be in the same octant.
-            if (drawoct & (1 << startoct)) drawoct &= 255 - (1 << startoct);
-            else drawoct |= (1 << startoct);
-        }
-        if (stopval_end == cx)
-        {
-            if (drawoct & (1 << endoct)) drawoct &= 255 - (1 << endoct);
-            else drawoct |= (1 << endoct);
-        }
+    /* the pixel alpha is only available on buffer dc and framebuffer */
+    if (aa && (dc->type == RTGUI_DC_BUFFER ||
+               rtgui_graphic_driver_get_default()->framebuffer != RT_NULL))
+    {
+        _sector_fill_aa(dc, &sec, cx, cy, r1, r2);
+        return;
+    }
 
-        /*
-         * Update pixels
-         */
-        if (df < 0)
-        {
-            df += d_e;
-            d_e += 2;
-            d_se += 2;
-        }
-        else
-        {
-            df += d_se;
-            d_e += 2;
-            d_se += 4;
-            cy--;
-        }
+    rout2 = r2 * r2 + r2;
+    rin2 = r1 > 0 ? r1 * r1 - r1 : -1;
+    for (y = -r2; y <= r2; y++)
+    {
+        n = _sector_spans(&sec, y, rout2, rin2, 0, spans);
+        for (i = 0; i < n; i++)
+            rtgui_dc_draw_hline(dc, cx + spans[2 * i], cx + spans[2 * i + 1] + 1, cy + y);
+    }
+}
 
-        cx++;
+/* draw the radius line of @angle from r1 to r2 */
+static void _dc_draw_radius(struct rtgui_dc *dc, int cx, int cy, int r1, int r2, int angle)
+{
+    int c = _sector_sin_deg(angle + 90), s = _sector_sin_deg(angle);
+
+    rtgui_dc_draw_line(dc, cx + _sector_scale(r1, c), cy + _sector_scale(r1, s),
+                       cx + _sector_scale(r2, c), cy + _sector_scale(r2, s));
+}
+
+void rtgui_dc_draw_arc(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end)
+{
+    /* Sanity check radius */
+    if (r < 0) return ;
+    /* Special case for r=0 - draw a point */
+    if (r == 0)
+    {
+        rtgui_dc_draw_point(dc, x, y);
+        return;
     }
-    while (cx <= cy);
+
+    _dc_fill_sector(dc, x, y, r, r, start, end, RT_FALSE);
 }
 RTM_EXPORT(rtgui_dc_draw_arc);
 
 void rtgui_dc_draw_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end)
 {
-    rt_int16_t start_x, start_y;
-    rt_int16_t end_x, end_y;
-    double temp;
-    rt_int16_t temp_val = 0;
-
     /* Sanity check radius */
     if ((r1 < 0) || (r2 < 0)) return ;
     /* Special case for r=0 - draw a point */
@@ -908,42 +1223,47 @@ void rtgui_dc_draw_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_i
         return;
     }
 
-    while (start < 0) start += 360;
-    while (end < 0) end += 360;
-
     rtgui_dc_draw_arc(dc, x, y, r1, start, end);
     rtgui_dc_draw_arc(dc, x, y, r2, start, end);
 
-    temp     = cos(start * M_PI / 180);
-    temp_val = (int)(temp * r1);
-    start_x  = x + temp_val;
-    temp_val = (int)(temp * r2);
-    end_x    = x + temp_val;
-
-    temp     = sin(start * M_PI / 180);
-    temp_val = (int)(temp * r1);
-    start_y  = y + temp_val;
-    temp_val = (int)(temp * r2);
-    end_y    = y + temp_val;
-
-    rtgui_dc_draw_line(dc, start_x, start_y, end_x, end_y);
-
-    temp     = cos(end * M_PI / 180);
-    temp_val = (int)(temp * r1);
-    start_x  = x + temp_val;
-    temp_val = (int)(temp * r2);
-    end_x    = x + temp_val;
-
-    temp     = sin(end * M_PI / 180);
-    temp_val = (int)(temp * r1);
-    start_y  = y + temp_val;
-    temp_val = (int)(temp * r2);
-    end_y    = y + temp_val;
-
-    rtgui_dc_draw_line(dc, start_x, start_y, end_x, end_y);
+    _dc_draw_radius(dc, x, y, r1, r2, start);
+    _dc_draw_radius(dc, x, y, r1, r2, end);
 }
 RTM_EXPORT(rtgui_dc_draw_annulus);
 
+void rtgui_dc_fill_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end)
+{
+    /* Sanity check radius */
+    if ((r1 < 0) || (r2 < 0)) return ;
+
+    _dc_fill_sector(dc, x, y, r1, r2, start, end, RT_FALSE);
+}
+RTM_EXPORT(rtgui_dc_fill_annulus);
+
+void rtgui_dc_draw_aa_arc(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end)
+{
+    if (r < 0) return ;
+
+    _dc_fill_sector(dc, x, y, r, r, start, end, RT_TRUE);
+}
+RTM_EXPORT(rtgui_dc_draw_aa_arc);
+
+void rtgui_dc_fill_aa_annulus(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r1, rt_int16_t r2, rt_int16_t start, rt_int16_t end)
+{
+    if ((r1 < 0) || (r2 < 0)) return ;
+
+    _dc_fill_sector(dc, x, y, r1, r2, start, end, RT_TRUE);
+}
+RTM_EXPORT(rtgui_dc_fill_aa_annulus);
+
+void rtgui_dc_fill_aa_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r, rt_int16_t start, rt_int16_t end)
+{
+    if (r < 0) return ;
+
+    _dc_fill_sector(dc, x, y, 0, r, start, end, RT_TRUE);
+}
+RTM_EXPORT(rtgui_dc_fill_aa_pie);
+
 void rtgui_dc_draw_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t rx, rt_int16_t ry)
 {
     int ix, iy;
@@ -1230,21 +1550,9 @@ RTM_EXPORT(rtgui_dc_fill_ellipse);
 
 void rtgui_dc_draw_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t rad, rt_int16_t start, rt_int16_t end)
 {
-    double angle, start_angle, end_angle;
-    double deltaAngle;
-    double dr;
-    int numpoints, i;
-    int *vx, *vy;
-
     /* Sanity check radii */
     if (rad < 0) return ;
 
-    /*
-     * Fixup angles
-     */
-    start = start % 360;
-    end = end % 360;
-
     /*
      * Special case for rad=0 - draw a point
      */
@@ -1254,222 +1562,15 @@ void rtgui_dc_draw_pie(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16
         return;
     }
 
-    /*
-     * Variable setup
-     */
-    dr = (double) rad;
-    deltaAngle = 3.0 / dr;
-    start_angle = (double) start * (2.0 * M_PI / 360.0);
-    end_angle = (double) end * (2.0 * M_PI / 360.0);
-    if (start > end)
-    {
-        end_angle += (2.0 * M_PI);
-    }
-
-    /* We will always have at least 2 points */
-    numpoints = 2;
-
-    /* Count points (rather than calculating it) */
-    angle = start_angle;
-    while (angle < end_angle)
-    {
-        angle += deltaAngle;
-        numpoints++;
-    }
-
-    /* Allocate combined vertex array */
-    vx = vy = (int *) rtgui_malloc(2 * sizeof(int) * numpoints);
-    if (vx == RT_NULL) return ;
-
-    /* Update point to start of vy */
-    vy += numpoints;
-
-    /* Center */
-    vx[0] = x;
-    vy[0] = y;
-
-    /* First vertex */
-    angle = start_angle;
-    vx[1] = x + (int)(dr * cos(angle));
-    vy[1] = y + (int)(dr * sin(angle));
-
-    if (numpoints < 3)
+    rtgui_dc_draw_arc(dc, x, y, rad, start, end);
+    if ((end - start) % 360 != 0)
     {
-        rtgui_dc_draw_line(dc, vx[0], vy[0], vx[1], vy[1]);
+        _dc_draw_radius(dc, x, y, 0, rad, start);
+        _dc_draw_radius(dc, x, y, 0, rad, end);
     }
-    else
-    {
-        /* Calculate other vertices */
-        i = 2;
-        angle = start_angle;
-        while (angle < end_angle)
-        {
-            angle += deltaAngle;
-            if (angle > end_angle)
-            {
-                angle = end_angle;
-            }
-            vx[i] = x + (int)(dr * cos(angle));
-            vy[i] = y + (int)(dr * sin(angle));
-            i++;
-        }
-
-        /* Draw */
-        rtgui_dc_draw_polygon(dc, vx, vy, numpoints);
-    }
-
-    /* Free combined vertex array */
-    rtgui_free(vx);
-    return;
 }
 RTM_EXPORT(rtgui_dc_draw_pie);
 
-/*
- * Octant labelling
- *
- *  \ 5 | 6 /
- *   \  |  /
- *  4 \ | / 7
- *     \|/
- *------+------ +x
- *     /|\
- *  3 / | \ 0
- *   /  |  \
- *  / 2 | 1 \
- *      +y
- */
-static void _draw_octant(struct rtgui_dc *dc,
-                         rt_int16_t ox, rt_int16_t oy,
-                         rt_int16_t y1, rt_int16_t y2, rt_int16_t x, int oct)
-{
-    switch (oct % 8)
-    {
-    case 0:
-        rtgui_dc_draw_line(dc, ox +  x, oy + y1, ox +  x, oy + y2);
-        break;
-    case 1:
-        /* Ugly hack to get the edge right. */
-        y2 += 1;
-        y1 += 1;
-        x -= 1;
-        rtgui_dc_draw_line(dc, ox + y1, oy +  x, ox + y2, oy +  x);
-        break;
-    case 2:
-        y2 -= 1;
-        y1 -= 1;
-        x -= 1;
-        rtgui_dc_draw_line(dc, ox - y2, oy +  x, ox - y1, oy +  x);
-        break;
-    case 3:
-        x -= 1;
-        rtgui_dc_draw_line(dc, ox -  x, oy + y1, ox -  x, oy + y2);
-        break;
-    case 4:
-        x -= 1;
-        rtgui_dc_draw_line(dc, ox -  x, oy - y2, ox -  x, oy - y1);
-        break;
-    case 5:
-        y2 -= 1;
-        y1 -= 1;
-        rtgui_dc_draw_line(dc, ox - y2, oy -  x, ox - y1, oy -  x);
-        break;
-    case 6:
-        y2 += 1;
-        y1 += 1;
-        rtgui_dc_draw_line(dc, ox + y1, oy -  x, ox + y2, oy -  x);
-        break;
-    case 7:
-        rtgui_dc_draw_line(dc, ox +  x, oy - y2, ox +  x, oy - y1);
-        break;
-    };
-}
-
-static void _fill_small_pie(struct rtgui_dc *dc,
-                            rt_int16_t ox, rt_int16_t oy,
-                            rt_int16_t rad, rt_int16_t start, rt_int16_t end,
-                            int oct)
-{
-    /* Midpoint circle algorithm. */
-    int dk, x, y;
-    /* Start X, end X, */
-    rt_int16_t sx, ex, ty = 0, my;
-    enum {ST_NONE, ST_ARC, ST_TRI} st;
-
-    RT_ASSERT(0 <= start && start <= 45);
-    RT_ASSERT(0 <= end && end <= 45);
-    if (start == end)
-        return;
-    RT_ASSERT(start < end);
-    RT_ASSERT(rad > 0);
-
-    /* cos(90 - start) == sin(start) */
-    sx = rad * sin(start * M_PI / 180);
-    ex = rad * sin(end * M_PI / 180);
-
-    dk = 1 - rad;
-    x = 0;
-    y = rad;
-
-    st = ST_NONE;
-    my = ex;
-    while (x <= y)
-    {
-        rt_int16_t lx;
-
-        if (x < sx)
-        {
-        }
-        else if (x == sx)
-        {
-            /* Start point. */
-            st = ST_ARC;
-            ty = y;
-        }
-        else if (x <= ex)
-        {
-            /* Between the pie. */
-            RT_ASSERT(st == ST_ARC);
-        }
-        else /* x > ex */
-        {
-            /* End. */
-            st = ST_TRI;
-            my = y;
-            break;
-        }
-
-        /* Drawing. */
-        if (st == ST_ARC)
-        {
-            lx = y * sx / ty;
-            /* Change from math coordinate to plot coordinate. */
-            _draw_octant(dc, ox, oy, lx, x, y, oct);
-        }
-
-        /* Midpoint increment. */
-        if (dk > 0)
-        {
-            y--;
-            dk += 2 * (x - y) + 5;
-        }
-        else
-        {
-            dk += 2 * x + 3;
-        }
-        x++;
-    }
-    /* Draw bottom part. */
-    for (; y >= 0; y--)
-    {
-        rt_int16_t lx, rx;
-
-        lx = y * sx / ty;
-        rx = y * ex / my;
-
-        _draw_octant(dc, ox, oy, lx, rx, y, oct);
-    }
-}
-
 void rtgui_dc_fill_pie(struct rtgui_dc *dc,
                        rt_int16_t x, rt_int16_t y, rt_int16_t rad,
                        rt_int16_t start, rt_int16_t end)
@@ -1483,61 +1584,45 @@ void rtgui_dc_fill_pie(struct rtgui_dc *dc,
         return;
     }
 
-    if (end - start >= 360)
-    {
-        rtgui_dc_fill_circle(dc, x, y, rad);
-        return;
-    }
-    if (start == end)
-        return;
+    _dc_fill_sector(dc, x, y, 0, rad, start, end, RT_FALSE);
+}
+RTM_EXPORT(rtgui_dc_fill_pie);
 
-    /*
-     * Fixup angles
-     */
-    while (start < 0)
-    {
-        start += 360;
-        end   += 360;
-    }
-    while (start >= 360)
-    {
-        start -= 360;
-        end   -= 360;
-    }
+/*
+ * push a scissor on dc, the drawing is limited in the rect (logic coordinates)
+ * until the scissor is popped. It doesn't touch the clip region of dc, only
+ * the rect is intersected with the outer scissor.
+ */
+void rtgui_dc_push_scissor(struct rtgui_dc *dc, struct rtgui_dc_scissor *scissor, const rtgui_rect_t *rect)
+{
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(scissor != RT_NULL);
+    RT_ASSERT(rect != RT_NULL);
 
-    if (end < start)
-        end += 360;
+    scissor->rect = *rect;
+    if (dc->scissor != RT_NULL)
+        rtgui_rect_intersect(&(dc->scissor->rect), &(scissor->rect));
 
-    while (start / 45 != end / 45)
-    {
-        /* The start and end are not in the same piece. */
-        if ((start / 45) % 2)
-        {
-            _fill_small_pie(dc, x, y, rad,
-                            0, 45 - start % 45, start / 45);
-            start += 45 - start % 45;
-        }
-        else
-        {
-            _fill_small_pie(dc, x, y, rad,
-                            start % 45, 45, start / 45);
-            start += 45 - start % 45;
-        }
-    }
-    if ((start / 45) % 2)
-    {
-        _fill_small_pie(dc, x, y, rad,
-                        90 - end % 90, 90 - start % 90, start / 45);
-    }
-    else
-    {
-        _fill_small_pie(dc, x, y, rad,
-                        start % 45, end % 45, start / 45);
-    }
+    /* keep an empty rect not inverted, nothing is drawn in it */
+    if (scissor->rect.x2 < scissor->rect.x1) scissor->rect.x2 = scissor->rect.x1;
+    if (scissor->rect.y2 < scissor->rect.y1) scissor->rect.y2 = scissor->rect.y1;
 
-    return;
+    scissor->next = dc->scissor;
+    dc->scissor = scissor;
 }
-RTM_EXPORT(rtgui_dc_fill_pie);
+RTM_EXPORT(rtgui_dc_push_scissor);
+
+/*
+ * pop the top scissor of dc
+ */
+void rtgui_dc_pop_scissor(struct rtgui_dc *dc)
+{
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(dc->scissor != RT_NULL);
+
+    dc->scissor = dc->scissor->next;
+}
+RTM_EXPORT(rtgui_dc_pop_scissor);
 
 /*
  * set gc of dc
@@ -1894,6 +1979,11 @@ struct rtgui_dc *rtgui_dc_begin_drawing(rtgui_widget_t *owner)
         }
     }
 
+#ifdef GUIENGIN_USING_TRACE
+    if (dc != RT_NULL)
+        rtgui_trace_draw(win, RT_TRUE);
+#endif
+
     return dc;
 }
 RTM_EXPORT(rtgui_dc_begin_drawing);
@@ -1932,14 +2022,18 @@ void rtgui_dc_end_drawing(struct rtgui_dc *dc, rt_bool_t update)
             RTGUI_OBJECT(win)->event_handler(RTGUI_OBJECT(win), (struct rtgui_event *)&ewin_update);
         }
 
-        if (rtgui_graphic_driver_is_vmode() == RT_FALSE && win->update == 0 && update)
-        {
 #ifdef RTGUI_USING_MOUSE_CURSOR
+        /* the cursor is hidden in begin drawing, even if the update is held */
+        if (rtgui_graphic_driver_is_vmode() == RT_FALSE)
+        {
             rt_mutex_release(&cursor_mutex);
             /* show cursor */
             rtgui_mouse_show_cursor();
+        }
 #endif
 
+        if (rtgui_graphic_driver_is_vmode() == RT_FALSE && win->update == 0 && update)
+        {
             if (RTGUI_IS_WINTITLE(win))
             {
                 /* update screen */
@@ -1961,7 +2055,15 @@ void rtgui_dc_end_drawing(struct rtgui_dc *dc, rt_bool_t update)
         }
     }
 
+    /* the client dc lives in the widget, don't keep the scissors of drawing */
+    if (dc->type == RTGUI_DC_CLIENT)
+        dc->scissor = RT_NULL;
+
     dc->engine->fini(dc);
     rtgui_screen_unlock();
+
+#ifdef GUIENGIN_USING_TRACE
+    rtgui_trace_draw(win, RT_FALSE);
+#endif
 }
 RTM_EXPORT(rtgui_dc_end_drawing);
@@ -74,6 +74,7 @@
 #include <rtgui/dc.h>
 #include <rtgui/dc_draw.h>
 #include <rtgui/color.h>
+#include <rtgui/shape_cache.h>
 #include <string.h>
 
 #include <math.h>
@@ -322,6 +323,34 @@ static rt_bool_t _intersect_rect_line(const rtgui_rect_t* rect,
     return RT_TRUE;
 }
 
+/*
+ * The scissor is in logic coordinates, it's checked before the clip of
+ * owner like the dc engines do.
+ */
+rt_inline rt_bool_t _dc_scissor_point(struct rtgui_dc *dc, int x, int y)
+{
+    rtgui_rect_t *scissor = rtgui_dc_get_scissor(dc);
+
+    return scissor == RT_NULL || rtgui_rect_contains_point(scissor, x, y) == RT_EOK;
+}
+
+static rt_bool_t _dc_scissor_line(struct rtgui_dc *dc, int *x1, int *y1, int *x2, int *y2)
+{
+    rtgui_rect_t *scissor = rtgui_dc_get_scissor(dc);
+
+    return scissor == RT_NULL || _intersect_rect_line(scissor, x1, y1, x2, y2);
+}
+
+static rt_bool_t _dc_scissor_rect(struct rtgui_dc *dc, rtgui_rect_t *rect)
+{
+    rtgui_rect_t *scissor = rtgui_dc_get_scissor(dc);
+
+    if (scissor != RT_NULL)
+        rtgui_rect_intersect(scissor, rect);
+
+    return rect->x1 < rect->x2 && rect->y1 < rect->y2;
+}
+
 static void
 _dc_draw_line1(struct rtgui_dc * dst, int x1, int y1, int x2, int y2, rtgui_color_t color,
                rt_bool_t draw_end)
@@ -518,6 +547,16 @@ static void _do_draw_line(struct rtgui_dc * dst,
         return;
     }
 
+    {
+        int end_x = x2, end_y = y2;
+
+        if (_dc_scissor_line(dst, &x1, &y1, &x2, &y2) == RT_FALSE)
+            return;
+        /* the end cut by the scissor is not the end of line */
+        if (x2 != end_x || y2 != end_y)
+            draw_end = RT_TRUE;
+    }
+
     /* perform clip */
     if (dst->type == RTGUI_DC_CLIENT)
     {
@@ -757,6 +796,50 @@ _dc_blend_point_argb8888(struct rtgui_dc * dst, int x, int y, enum RTGUI_BLENDMO
     return 0;
 }
 
+#define _dc_is_indexed(dc)  ((dc)->type == RTGUI_DC_BUFFER && \
+                             ((struct rtgui_dc_buffer *)(dc))->palette != RT_NULL)
+
+/* blend with the palette color under the pixel and quantize the result back
+ * through the palette, the indexed buffer has no direct pixel operator */
+static int
+_dc_blend_point_indexed(struct rtgui_dc * dst, int x, int y, enum RTGUI_BLENDMODE blendMode,
+                        rt_uint8_t r, rt_uint8_t g, rt_uint8_t b, rt_uint8_t a)
+{
+    unsigned inva = 0xff - a;
+    rtgui_color_t pixel;
+
+    switch (blendMode)
+    {
+    case RTGUI_BLENDMODE_BLEND:
+    {
+        unsigned sr, sg, sb;
+
+        pixel = rtgui_dc_buffer_get_color(dst, x, y);
+        sr = ((r * a) + (inva * RTGUI_RGB_R(pixel))) * 257 >> 16;
+        sg = ((g * a) + (inva * RTGUI_RGB_G(pixel))) * 257 >> 16;
+        sb = ((b * a) + (inva * RTGUI_RGB_B(pixel))) * 257 >> 16;
+        pixel = RTGUI_RGB(sr, sg, sb);
+        break;
+    }
+    case RTGUI_BLENDMODE_ADD:
+        pixel = rtgui_dc_buffer_get_color(dst, x, y);
+        DRAW_SETPIXEL_ADD((sr = RTGUI_RGB_R(pixel), sg = RTGUI_RGB_G(pixel), sb = RTGUI_RGB_B(pixel)),
+                          pixel = RTGUI_RGB(sr, sg, sb));
+        break;
+    case RTGUI_BLENDMODE_MOD:
+        pixel = rtgui_dc_buffer_get_color(dst, x, y);
+        DRAW_SETPIXEL_MOD((sr = RTGUI_RGB_R(pixel), sg = RTGUI_RGB_G(pixel), sb = RTGUI_RGB_B(pixel)),
+                          pixel = RTGUI_RGB(sr, sg, sb));
+        break;
+    default:
+        pixel = RTGUI_RGB(r, g, b);
+        break;
+    }
+    dst->engine->draw_color_point(dst, x, y, pixel);
+
+    return 0;
+}
+
 void
 rtgui_dc_blend_point(struct rtgui_dc * dst, int x, int y, enum RTGUI_BLENDMODE blendMode, rt_uint8_t r,
                      rt_uint8_t g, rt_uint8_t b, rt_uint8_t a)
@@ -771,6 +854,8 @@ rtgui_dc_blend_point(struct rtgui_dc * dst, int x, int y, enum RTGUI_BLENDMODE b
     /* we do not support pixel DC */
     if (_dc_get_pixel(dst, 0, 0) == RT_NULL) return;
 
+    if (!_dc_scissor_point(dst, x, y)) return;
+
     /* Perform clipping */
     if (dst->type == RTGUI_DC_CLIENT)
     {
@@ -827,6 +912,8 @@ rtgui_dc_blend_point(struct rtgui_dc * dst, int x, int y, enum RTGUI_BLENDMODE b
         _dc_blend_point_argb8888(dst, x, y, blendMode, r, g, b, a);
         break;
     default:
+        if (_dc_is_indexed(dst))
+            _dc_blend_point_indexed(dst, x, y, blendMode, r, g, b, a);
         break;
     }
 }
@@ -865,7 +952,10 @@ rtgui_dc_blend_points(struct rtgui_dc *dst, const rtgui_point_t *points, int cou
     case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
         func = _dc_blend_point_argb8888;
     default:
-        return;
+        if (!_dc_is_indexed(dst))
+            return;
+        func = _dc_blend_point_indexed;
+        break;
     }
 
     /* get owner */
@@ -880,6 +970,7 @@ rtgui_dc_blend_points(struct rtgui_dc *dst, const rtgui_point_t *points, int cou
         {
             x = points[i].x;
             y = points[i].y;
+            if (!_dc_scissor_point(dst, x, y)) continue;
 
             /* Perform clipping */
             x = x + owner->extent.x1;
@@ -899,6 +990,7 @@ rtgui_dc_blend_points(struct rtgui_dc *dst, const rtgui_point_t *points, int cou
         {
             x = points[i].x;
             y = points[i].y;
+            if (!_dc_scissor_point(dst, x, y)) continue;
 
             x = x + dc->owner->extent.x1;
             y = y + dc->owner->extent.y1;
@@ -914,6 +1006,7 @@ rtgui_dc_blend_points(struct rtgui_dc *dst, const rtgui_point_t *points, int cou
         {
             x = points[i].x;
             y = points[i].y;
+            if (!_dc_scissor_point(dst, x, y)) continue;
 
             func(dst, x, y, blendMode, r, g, b, a);
         }
@@ -1430,6 +1523,9 @@ static void _do_blend_line(struct rtgui_dc * dst,
         return;
     }
 
+    if (_dc_scissor_line(dst, &x1, &y1, &x2, &y2) == RT_FALSE)
+        return;
+
     r = RTGUI_RGB_R(color);
     g = RTGUI_RGB_G(color);
     b = RTGUI_RGB_B(color);
@@ -1680,11 +1776,27 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
                          enum RTGUI_BLENDMODE blendMode, rtgui_color_t color)
 {
     unsigned r, g, b, a;
+    rtgui_rect_t scissor_rect;
     BlendFillFunc func = RT_NULL;
 
     RT_ASSERT(dst != RT_NULL);
 
     if (!rtgui_dc_get_visible(dst)) return;
+    /* the indexed buffer is blended point by point through its palette */
+    if (_dc_is_indexed(dst))
+    {
+        int x, y;
+
+        for (y = rect->y1; y < rect->y2; y ++)
+        {
+            for (x = rect->x1; x < rect->x2; x ++)
+            {
+                rtgui_dc_blend_point(dst, x, y, blendMode, RTGUI_RGB_R(color),
+                                     RTGUI_RGB_G(color), RTGUI_RGB_B(color), RTGUI_RGB_A(color));
+            }
+        }
+        return;
+    }
     /* This function doesn't work on surfaces < 8 bpp */
     if (_dc_get_bits_per_pixel(dst) < 8)
     {
@@ -1727,6 +1839,11 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
         return ;
     }
 
+    scissor_rect = *rect;
+    if (_dc_scissor_rect(dst, &scissor_rect) == RT_FALSE)
+        return;
+    rect = &scissor_rect;
+
     if (dst->type == RTGUI_DC_CLIENT)
     {
         register rt_base_t index;
@@ -1777,13 +1894,15 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
         rtgui_rect_t draw_rect = *rect;
         struct rtgui_dc_hw *dc = (struct rtgui_dc_hw *) dst;
 
-        draw_rect.x2 = dc->owner->extent.x1 + draw_rect.x2 - draw_rect.x1;
-        draw_rect.y2 = dc->owner->extent.y1 + draw_rect.y2 - draw_rect.y1;
+        /* convert logic to device, the rect may be cut by the scissor */
+        rtgui_rect_move(&draw_rect, dc->owner->extent.x1, dc->owner->extent.y1);
+        rtgui_rect_intersect(&(dc->owner->extent), &draw_rect);
 
-        draw_rect.x1 = dc->owner->extent.x1 > 0 ? dc->owner->extent.x1 : 0;
-        draw_rect.y1 = dc->owner->extent.y1 > 0 ? dc->owner->extent.y1 : 0;
+        if (draw_rect.x1 < 0) draw_rect.x1 = 0;
+        if (draw_rect.y1 < 0) draw_rect.y1 = 0;
         draw_rect.x2 = draw_rect.x2 > hw_driver->width ? hw_driver->width : draw_rect.x2;
         draw_rect.y2 = draw_rect.y2 > hw_driver->height ? hw_driver->height : draw_rect.y2;
+        if (draw_rect.x1 >= draw_rect.x2 || draw_rect.y1 >= draw_rect.y2) return;
 
         func(dst, &draw_rect, blendMode, r, g, b, a);
     }
@@ -1807,6 +1926,12 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
     RT_ASSERT(dst != RT_NULL);
 
     if (!rtgui_dc_get_visible(dst)) return;
+    if (_dc_is_indexed(dst))
+    {
+        for (i = 0; i < count; i ++)
+            rtgui_dc_blend_fill_rect(dst, &rects[i], blendMode, color);
+        return;
+    }
     /* This function doesn't work on surfaces < 8 bpp */
     if (_dc_get_bits_per_pixel(dst)< 8)
     {
@@ -1858,6 +1983,8 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
     for (i = 0; i < count; ++i)
     {
         rect = rects[i];
+        if (_dc_scissor_rect(dst, &rect) == RT_FALSE)
+            continue;
 
         if (dst->type == RTGUI_DC_CLIENT)
         {
@@ -2166,642 +2293,56 @@ void rtgui_dc_draw_aa_ellipse(struct rtgui_dc *dc, rt_int16_t  x, rt_int16_t y,
 }
 RTM_EXPORT(rtgui_dc_draw_aa_ellipse);
 
-void rtgui_dc_draw_aa_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r)
-{
-    rtgui_dc_draw_aa_ellipse(dc, x, y, r, r);
-}
-RTM_EXPORT(rtgui_dc_draw_aa_circle);
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+/* the anti-aliased pixels may lay one pixel beyond the radius */
+#define AA_CIRCLE_MARGIN    2
 
-/*!
-\brief The structure passed to the internal Bresenham iterator.
-*/
-typedef struct
+static void _dc_aa_circle_render(struct rtgui_dc *sprite, const struct rtgui_shape_key *key)
 {
-    rt_int16_t x, y;
-    int dx, dy, s1, s2, swapdir, error;
-    rt_uint32_t count;
-} _BresenhamIterator;
-
-/*!
-\brief The structure passed to the internal Murphy iterator.
-*/
-typedef struct
-{
-    rt_uint32_t color;
-    struct rtgui_dc *dst;
-    int u, v;       /* delta x , delta y */
-    int ku, kt, kv, kd; /* loop constants */
-    int oct2;
-    int quad4;
-    rt_int16_t last1x, last1y, last2x, last2y, first1x, first1y, first2x, first2y, tempx, tempy;
-} _MurphyIterator;
-
-/*!
-\brief Internal function to initialize the Bresenham line iterator.
-
-Example of use:
-_BresenhamIterator b;
-_bresenhamInitialize (&b, x1, y1, x2, y2);
-do {
-plot(b.x, b.y);
-} while (_bresenhamIterate(&b)==0);
-
-\param b Pointer to struct for bresenham line drawing state.
-\param x1 X coordinate of the first point of the line.
-\param y1 Y coordinate of the first point of the line.
-\param x2 X coordinate of the second point of the line.
-\param y2 Y coordinate of the second point of the line.
-
-\returns Returns 0 on success, -1 on failure.
-*/
-int _bresenhamInitialize(_BresenhamIterator *b, rt_int16_t x1, rt_int16_t y1, rt_int16_t x2, rt_int16_t y2)
-{
-    int temp;
-
-    if (b==NULL)
-    {
-        return(-1);
-    }
+    rt_int16_t c = key->radius + AA_CIRCLE_MARGIN;
 
-    b->x = x1;
-    b->y = y1;
-
-    /* dx = abs(x2-x1), s1 = sign(x2-x1) */
-    if ((b->dx = x2 - x1) != 0)
-    {
-        if (b->dx < 0)
-        {
-            b->dx = -b->dx;
-            b->s1 = -1;
-        }
-        else
-        {
-            b->s1 = 1;
-        }
-    }
-    else
-    {
-        b->s1 = 0;
-    }
-
-    /* dy = abs(y2-y1), s2 = sign(y2-y1)    */
-    if ((b->dy = y2 - y1) != 0)
-    {
-        if (b->dy < 0)
-        {
-            b->dy = -b->dy;
-            b->s2 = -1;
-        }
-        else
-        {
-            b->s2 = 1;
-        }
-    }
-    else
-    {
-        b->s2 = 0;
-    }
-
-    if (b->dy > b->dx)
-    {
-        temp = b->dx;
-        b->dx = b->dy;
-        b->dy = temp;
-        b->swapdir = 1;
-    }
-    else
-    {
-        b->swapdir = 0;
-    }
-
-    b->count = (b->dx<0) ? 0 : (unsigned int)b->dx;
-    b->dy <<= 1;
-    b->error = b->dy - b->dx;
-    b->dx <<= 1;
-
-    return(0);
+    RTGUI_DC_FC(sprite) = key->fc;
+    rtgui_dc_draw_aa_ellipse(sprite, c, c, key->radius, key->radius);
 }
 
-
-/*!
-\brief Internal function to move Bresenham line iterator to the next position.
-
-Maybe updates the x and y coordinates of the iterator struct.
-
-\param b Pointer to struct for bresenham line drawing state.
-
-\returns Returns 0 on success, 1 if last point was reached, 2 if moving past end-of-line, -1 on failure.
-*/
-int _bresenhamIterate(_BresenhamIterator *b)
+static rt_bool_t _dc_draw_cached_aa_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r)
 {
-    if (b==NULL)
-    {
-        return (-1);
-    }
+    struct rtgui_shape_key key;
+    struct rtgui_shape_item *item;
+    struct rtgui_point point;
+    struct rtgui_rect rect;
 
-    /* last point check */
-    if (b->count==0)
-    {
-        return (2);
-    }
-
-    while (b->error >= 0)
-    {
-        if (b->swapdir)
-        {
-            b->x += b->s1;
-        }
-        else
-        {
-            b->y += b->s2;
-        }
-
-        b->error -= b->dx;
-    }
-
-    if (b->swapdir)
-    {
-        b->y += b->s2;
-    }
-    else
-    {
-        b->x += b->s1;
-    }
-
-    b->error += b->dy;
-    b->count--;
-
-    /* count==0 indicates "end-of-line" */
-    return ((b->count) ? 0 : 1);
-}
-
-
-/*!
-\brief Internal function to to draw parallel lines with Murphy algorithm.
-
-\param m Pointer to struct for murphy iterator.
-\param x X coordinate of point.
-\param y Y coordinate of point.
-\param d1 Direction square/diagonal.
-*/
-void _murphyParaline(_MurphyIterator *m, rt_int16_t x, rt_int16_t y, int d1)
-{
-    int p;
-    d1 = -d1;
-
-    for (p = 0; p <= m->u; p++)
-    {
-        rtgui_dc_draw_point(m->dst, x, y);
-
-        if (d1 <= m->kt)
-        {
-            if (m->oct2 == 0)
-            {
-                x++;
-            }
-            else
-            {
-                if (m->quad4 == 0)
-                {
-                    y++;
-                }
-                else
-                {
-                    y--;
-                }
-            }
-            d1 += m->kv;
-        }
-        else
-        {
-            x++;
-            if (m->quad4 == 0)
-            {
-                y++;
-            }
-            else
-            {
-                y--;
-            }
-            d1 += m->kd;
-        }
-    }
-
-    m->tempx = x;
-    m->tempy = y;
-}
-
-/*!
-\brief Internal function to to draw one iteration of the Murphy algorithm.
-
-\param m Pointer to struct for murphy iterator.
-\param miter Iteration count.
-\param ml1bx X coordinate of a point.
-\param ml1by Y coordinate of a point.
-\param ml2bx X coordinate of a point.
-\param ml2by Y coordinate of a point.
-\param ml1x X coordinate of a point.
-\param ml1y Y coordinate of a point.
-\param ml2x X coordinate of a point.
-\param ml2y Y coordinate of a point.
-
-*/
-void _murphyIteration(_MurphyIterator *m, rt_uint8_t miter,
-                      rt_uint16_t ml1bx, rt_uint16_t ml1by, rt_uint16_t ml2bx, rt_uint16_t ml2by,
-                      rt_uint16_t ml1x, rt_uint16_t ml1y, rt_uint16_t ml2x, rt_uint16_t ml2y)
-{
-    int atemp1, atemp2;
-    int ftmp1, ftmp2;
-    rt_uint16_t m1x, m1y, m2x, m2y;
-    rt_uint16_t fix, fiy, lax, lay, curx, cury;
-    int px[4], py[4];
-    _BresenhamIterator b;
-
-    if (miter > 1)
-    {
-        if (m->first1x != -32768)
-        {
-            fix = (m->first1x + m->first2x) / 2;
-            fiy = (m->first1y + m->first2y) / 2;
-            lax = (m->last1x + m->last2x) / 2;
-            lay = (m->last1y + m->last2y) / 2;
-            curx = (ml1x + ml2x) / 2;
-            cury = (ml1y + ml2y) / 2;
-
-            atemp1 = (fix - curx);
-            atemp2 = (fiy - cury);
-            ftmp1 = atemp1 * atemp1 + atemp2 * atemp2;
-            atemp1 = (lax - curx);
-            atemp2 = (lay - cury);
-            ftmp2 = atemp1 * atemp1 + atemp2 * atemp2;
-
-            if (ftmp1 <= ftmp2)
-            {
-                m1x = m->first1x;
-                m1y = m->first1y;
-                m2x = m->first2x;
-                m2y = m->first2y;
-            }
-            else
-            {
-                m1x = m->last1x;
-                m1y = m->last1y;
-                m2x = m->last2x;
-                m2y = m->last2y;
-            }
-
-            atemp1 = (m2x - ml2x);
-            atemp2 = (m2y - ml2y);
-            ftmp1 = atemp1 * atemp1 + atemp2 * atemp2;
-            atemp1 = (m2x - ml2bx);
-            atemp2 = (m2y - ml2by);
-            ftmp2 = atemp1 * atemp1 + atemp2 * atemp2;
-
-            if (ftmp2 >= ftmp1)
-            {
-                ftmp1 = ml2bx;
-                ftmp2 = ml2by;
-                ml2bx = ml2x;
-                ml2by = ml2y;
-                ml2x = ftmp1;
-                ml2y = ftmp2;
-                ftmp1 = ml1bx;
-                ftmp2 = ml1by;
-                ml1bx = ml1x;
-                ml1by = ml1y;
-                ml1x = ftmp1;
-                ml1y = ftmp2;
-            }
-
-            _bresenhamInitialize(&b, m2x, m2y, m1x, m1y);
-            do
-            {
-                rtgui_dc_draw_color_point(m->dst, b.x, b.y, m->color);
-            }
-            while (_bresenhamIterate(&b)==0);
-
-            _bresenhamInitialize(&b, m1x, m1y, ml1bx, ml1by);
-            do
-            {
-                rtgui_dc_draw_color_point(m->dst, b.x, b.y, m->color);
-            }
-            while (_bresenhamIterate(&b)==0);
-
-            _bresenhamInitialize(&b, ml1bx, ml1by, ml2bx, ml2by);
-            do
-            {
-                rtgui_dc_draw_color_point(m->dst, b.x, b.y, m->color);
-            }
-            while (_bresenhamIterate(&b)==0);
-
-            _bresenhamInitialize(&b, ml2bx, ml2by, m2x, m2y);
-            do
-            {
-                rtgui_dc_draw_color_point(m->dst, b.x, b.y, m->color);
-            }
-            while (_bresenhamIterate(&b)==0);
-
-            px[0] = m1x;
-            px[1] = m2x;
-            px[2] = ml1bx;
-            px[3] = ml2bx;
-            py[0] = m1y;
-            py[1] = m2y;
-            py[2] = ml1by;
-            py[3] = ml2by;
-            rtgui_dc_draw_polygon(m->dst, px, py, 4);
-        }
-    }
-
-    m->last1x = ml1x;
-    m->last1y = ml1y;
-    m->last2x = ml2x;
-    m->last2y = ml2y;
-    m->first1x = ml1bx;
-    m->first1y = ml1by;
-    m->first2x = ml2bx;
-    m->first2y = ml2by;
-}
-
-#define HYPOT(x,y) sqrt((double)(x)*(double)(x)+(double)(y)*(double)(y))
-
-/*!
-\brief Internal function to to draw wide lines with Murphy algorithm.
-
-Draws lines parallel to ideal line.
-
-\param m Pointer to struct for murphy iterator.
-\param x1 X coordinate of first point.
-\param y1 Y coordinate of first point.
-\param x2 X coordinate of second point.
-\param y2 Y coordinate of second point.
-\param width Width of line.
-\param miter Iteration count.
-
-*/
-void _murphyWideline(_MurphyIterator *m, rt_int16_t x1, rt_int16_t y1, rt_int16_t x2, rt_int16_t y2, rt_uint8_t width, rt_uint8_t miter)
-{
-    float offset = (float)width / 2.f;
-
-    rt_int16_t temp;
-    rt_int16_t ptx, pty, ml1x = 0, ml1y = 0, ml2x = 0, ml2y = 0, ml1bx = 0, ml1by = 0, ml2bx = 0, ml2by = 0;
-
-    int d0, d1;     /* difference terms d0=perpendicular to line, d1=along line */
-
-    int q;          /* pel counter,q=perpendicular to line */
-    int tmp;
-
-    int dd;         /* distance along line */
-    int tk;         /* thickness threshold */
-    double ang;     /* angle for initial point calculation */
-    double sang, cang;
-
-    /* Initialisation */
-    m->u = x2 - x1; /* delta x */
-    m->v = y2 - y1; /* delta y */
-
-    if (m->u < 0)   /* swap to make sure we are in quadrants 1 or 4 */
-    {
-        temp = x1;
-        x1 = x2;
-        x2 = temp;
-        temp = y1;
-        y1 = y2;
-        y2 = temp;
-        m->u *= -1;
-        m->v *= -1;
-    }
-
-    if (m->v < 0)   /* swap to 1st quadrant and flag */
-    {
-        m->v *= -1;
-        m->quad4 = 1;
-    }
-    else
-    {
-        m->quad4 = 0;
-    }
-
-    if (m->v > m->u)    /* swap things if in 2 octant */
-    {
-        tmp = m->u;
-        m->u = m->v;
-        m->v = tmp;
-        m->oct2 = 1;
-    }
-    else
-    {
-        m->oct2 = 0;
-    }
-
-    m->ku = m->u + m->u;    /* change in l for square shift */
-    m->kv = m->v + m->v;    /* change in d for square shift */
-    m->kd = m->kv - m->ku;  /* change in d for diagonal shift */
-    m->kt = m->u - m->kv;   /* diag/square decision threshold */
-
-    d0 = 0;
-    d1 = 0;
-    dd = 0;
-
-    ang = atan((double) m->v / (double) m->u);  /* calc new initial point - offset both sides of ideal */
-    sang = sin(ang);
-    cang = cos(ang);
+    if (r <= 0 || !rtgui_shape_cache_check(dc))
+        return RT_FALSE;
 
-    if (m->oct2 == 0)
-    {
-        ptx = x1 + (rt_int16_t)lrint(offset * sang);
-        if (m->quad4 == 0)
-        {
-            pty = y1 - (rt_int16_t)lrint(offset * cang);
-        }
-        else
-        {
-            pty = y1 + (rt_int16_t)lrint(offset * cang);
-        }
-    }
-    else
-    {
-        ptx = x1 - (rt_int16_t)lrint(offset * cang);
-        if (m->quad4 == 0)
-        {
-            pty = y1 + (rt_int16_t)lrint(offset * sang);
-        }
-        else
-        {
-            pty = y1 - (rt_int16_t)lrint(offset * sang);
-        }
-    }
+    rt_memset(&key, 0, sizeof(key));
+    key.type = RTGUI_SHAPE_AA_CIRCLE;
+    key.pixel_format = rtgui_dc_get_pixel_format(dc);
+    key.radius = r;
+    key.width = key.height = 2 * (r + AA_CIRCLE_MARGIN) + 1;
+    key.fc = RTGUI_DC_FC(dc);
 
-    /* used here for constant thickness line */
-    tk = (int) (4. * HYPOT(ptx - x1, pty - y1) * HYPOT(m->u, m->v));
+    item = rtgui_shape_cache_get(&key, _dc_aa_circle_render);
+    if (item == RT_NULL) return RT_FALSE;
 
-    if (miter == 0)
-    {
-        m->first1x = -32768;
-        m->first1y = -32768;
-        m->first2x = -32768;
-        m->first2y = -32768;
-        m->last1x = -32768;
-        m->last1y = -32768;
-        m->last2x = -32768;
-        m->last2y = -32768;
-    }
+    point.x = 0; point.y = 0;
+    rtgui_rect_set(&rect, x - r - AA_CIRCLE_MARGIN, y - r - AA_CIRCLE_MARGIN,
+                   key.width, key.height);
+    rtgui_dc_blit(item->sprite, &point, dc, &rect);
 
-    for (q = 0; dd <= tk; q++)      /* outer loop, stepping perpendicular to line */
-    {
+    rtgui_shape_cache_put(item);
 
-        _murphyParaline(m, ptx, pty, d1);   /* call to inner loop - right edge */
-        if (q == 0)
-        {
-            ml1x = ptx;
-            ml1y = pty;
-            ml1bx = m->tempx;
-            ml1by = m->tempy;
-        }
-        else
-        {
-            ml2x = ptx;
-            ml2y = pty;
-            ml2bx = m->tempx;
-            ml2by = m->tempy;
-        }
-        if (d0 < m->kt)     /* square move */
-        {
-            if (m->oct2 == 0)
-            {
-                if (m->quad4 == 0)
-                {
-                    pty++;
-                }
-                else
-                {
-                    pty--;
-                }
-            }
-            else
-            {
-                ptx++;
-            }
-        }
-        else    /* diagonal move */
-        {
-            dd += m->kv;
-            d0 -= m->ku;
-            if (d1 < m->kt)     /* normal diagonal */
-            {
-                if (m->oct2 == 0)
-                {
-                    ptx--;
-                    if (m->quad4 == 0)
-                    {
-                        pty++;
-                    }
-                    else
-                    {
-                        pty--;
-                    }
-                }
-                else
-                {
-                    ptx++;
-                    if (m->quad4 == 0)
-                    {
-                        pty--;
-                    }
-                    else
-                    {
-                        pty++;
-                    }
-                }
-                d1 += m->kv;
-            }
-            else    /* double square move, extra parallel line */
-            {
-                if (m->oct2 == 0)
-                {
-                    ptx--;
-                }
-                else
-                {
-                    if (m->quad4 == 0)
-                    {
-                        pty--;
-                    }
-                    else
-                    {
-                        pty++;
-                    }
-                }
-                d1 += m->kd;
-                if (dd > tk)
-                {
-                    _murphyIteration(m, miter, ml1bx, ml1by, ml2bx, ml2by, ml1x, ml1y, ml2x, ml2y);
-                    return; /* breakout on the extra line */
-                }
-                _murphyParaline(m, ptx, pty, d1);
-                if (m->oct2 == 0)
-                {
-                    if (m->quad4 == 0)
-                    {
-                        pty++;
-                    }
-                    else
-                    {
-
-                        pty--;
-                    }
-                }
-                else
-                {
-                    ptx++;
-                }
-            }
-        }
-        dd += m->ku;
-        d0 += m->kv;
-    }
-
-    _murphyIteration(m, miter, ml1bx, ml1by, ml2bx, ml2by, ml1x, ml1y, ml2x, ml2y);
+    return RT_TRUE;
 }
+#endif
 
-
-/*!
-\brief Draw a thick line with alpha blending.
-
-\param dst The surface to draw on.
-\param x1 X coordinate of the first point of the line.
-\param y1 Y coordinate of the first point of the line.
-\param x2 X coordinate of the second point of the line.
-\param y2 Y coordinate of the second point of the line.
-\param width Width of the line in pixels. Must be >0.
-\param color The color value of the line to draw (0xRRGGBBAA).
-
-\returns Returns 0 on success, -1 on failure.
-*/
-int rtgui_dc_draw_thick_line(struct rtgui_dc * dst, rt_int16_t x1, rt_int16_t y1, rt_int16_t x2, rt_int16_t y2, rt_uint8_t width)
+void rtgui_dc_draw_aa_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t r)
 {
-    int wh;
-    _MurphyIterator m;
-
-    if (dst == NULL) return -1;
-    if (width < 1) return -1;
-
-    /* Special case: thick "point" */
-    if ((x1 == x2) && (y1 == y2))
-    {
-        struct rtgui_rect rect;
-        wh = width / 2;
-
-        rtgui_rect_init(&rect, x1 - wh, y1 - wh, x2 + width, y2 + width);
-        rtgui_dc_fill_rect(dst, &rect);
-    }
-
-    m.dst = dst;
-    m.color = RTGUI_DC_FC(dst);
-
-    _murphyWideline(&m, x1, y1, x2, y2, width, 0);
-    _murphyWideline(&m, x1, y1, x2, y2, width, 1);
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+    if (_dc_draw_cached_aa_circle(dc, x, y, r) == RT_TRUE)
+        return;
+#endif
 
-    return(0);
+    rtgui_dc_draw_aa_ellipse(dc, x, y, r, r);
 }
-RTM_EXPORT(rtgui_dc_draw_thick_line);
+RTM_EXPORT(rtgui_dc_draw_aa_circle);
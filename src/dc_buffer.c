@@ -55,14 +55,507 @@ const struct rtgui_dc_engine dc_buffer_engine =
 
 #define _dc_get_pitch(dc)           \
     (dc->pitch)
+/* the byte of pixel (x, y), the packed formats share it with the neighbours */
 #define _dc_get_pixel(dc, x, y)     \
-    ((dc)->pixel + (y) * (dc)->pitch + (x) * rtgui_color_get_bpp((dc)->pixel_format))
+    ((dc)->pixel + (y) * (dc)->pitch + (x) * rtgui_color_get_bits((dc)->pixel_format) / 8)
 #define _dc_get_bits_per_pixel(dc)  \
     rtgui_color_get_bits(dc->pixel_format)
 
 #define _hw_get_pixel(dst, x, y, type)  \
         (type *)((rt_uint8_t*)((dst)->framebuffer) + (y) * (dst)->pitch + (x) * _UI_BITBYTES((dst)->bits_per_pixel))
 
+/*
+ * Indexed buffer dc: MONO (1 bit), GRAY16 (4 bits) and PAL8 (8 bits).
+ */
+#define _MONO_INDEX(line, x)    (((line)[(x) >> 3] >> (7 - ((x) & 0x07))) & 0x01)
+#define _GRAY16_INDEX(line, x)  (((line)[(x) >> 1] >> (((x) & 0x01) ? 0 : 4)) & 0x0f)
+
+rt_inline rt_bool_t _dc_format_is_indexed(rt_uint8_t pixel_format)
+{
+    return (pixel_format == RTGRAPHIC_PIXEL_FORMAT_MONO ||
+            pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16 ||
+            pixel_format == RTGUI_PIXEL_FORMAT_PAL8);
+}
+
+static struct rtgui_dc_palette *_dc_palette_create(rt_uint8_t pixel_format)
+{
+    int index, ncolors;
+    struct rtgui_dc_palette *palette;
+
+    ncolors = 1 << rtgui_color_get_bits(pixel_format);
+    palette = (struct rtgui_dc_palette *) rtgui_malloc(sizeof(struct rtgui_dc_palette) +
+              ncolors * (sizeof(rtgui_color_t) + sizeof(rt_uint32_t)));
+    if (palette == RT_NULL) return RT_NULL;
+
+    palette->ncolors = ncolors;
+    palette->colors = (rtgui_color_t *)(palette + 1);
+    palette->lut = (rt_uint32_t *)(palette->colors + ncolors);
+    palette->lut_format = 0;
+    palette->lut_valid = RT_FALSE;
+
+    /* the default palette: black and white, 16 level gray or RGB332 */
+    for (index = 0; index < ncolors; index ++)
+    {
+        if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_MONO)
+            palette->colors[index] = index ? white : black;
+        else if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16)
+            palette->colors[index] = RTGUI_RGB(index * 17, index * 17, index * 17);
+        else
+            palette->colors[index] = RTGUI_RGB((index >> 5) * 255 / 7,
+                                               ((index >> 2) & 0x07) * 255 / 7,
+                                               (index & 0x03) * 85);
+    }
+    palette->last_color = palette->colors[0];
+    palette->last_index = 0;
+
+    return palette;
+}
+
+/* get the index of the nearest palette color */
+static rt_uint8_t _dc_palette_index(struct rtgui_dc_palette *palette, rtgui_color_t color)
+{
+    int index;
+    rt_uint32_t distance, best = 0xffffffff;
+
+    if (color == palette->last_color)
+        return palette->last_index;
+
+    for (index = 0; index < palette->ncolors; index ++)
+    {
+        int dr = (int)RTGUI_RGB_R(color) - (int)RTGUI_RGB_R(palette->colors[index]);
+        int dg = (int)RTGUI_RGB_G(color) - (int)RTGUI_RGB_G(palette->colors[index]);
+        int db = (int)RTGUI_RGB_B(color) - (int)RTGUI_RGB_B(palette->colors[index]);
+
+        /* the eye is more sensitive to green */
+        distance = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+        if (distance < best)
+        {
+            best = distance;
+            palette->last_index = index;
+            if (distance == 0) break;
+        }
+    }
+    palette->last_color = color;
+
+    return palette->last_index;
+}
+
+/* the bytes of a lookup table entry for the destination format, 0 for not supported */
+static int _dc_palette_lut_bpp(rt_uint8_t pixel_format)
+{
+    switch (pixel_format)
+    {
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+    case RTGRAPHIC_PIXEL_FORMAT_BGR565:
+    case RTGRAPHIC_PIXEL_FORMAT_RGB888:
+    case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
+        return rtgui_color_get_bpp(pixel_format);
+    }
+
+    return 0;
+}
+
+static void _dc_palette_update_lut(struct rtgui_dc_palette *palette, rt_uint8_t pixel_format)
+{
+    int index;
+
+    if (palette->lut_valid && palette->lut_format == pixel_format)
+        return;
+
+    for (index = 0; index < palette->ncolors; index ++)
+    {
+        rtgui_color_t color = palette->colors[index];
+
+        switch (pixel_format)
+        {
+        case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+            palette->lut[index] = rtgui_color_to_565(color);
+            break;
+        case RTGRAPHIC_PIXEL_FORMAT_BGR565:
+            palette->lut[index] = rtgui_color_to_565p(color);
+            break;
+        case RTGRAPHIC_PIXEL_FORMAT_RGB888:
+            palette->lut[index] = rtgui_color_to_888(color);
+            break;
+        case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
+            palette->lut[index] = color | 0xff000000;
+            break;
+        }
+    }
+
+    palette->lut_format = pixel_format;
+    palette->lut_valid = RT_TRUE;
+}
+
+rt_inline rt_uint8_t _dc_indexed_get(struct rtgui_dc_buffer *dc, const rt_uint8_t *line, int x)
+{
+    if (dc->pixel_format == RTGUI_PIXEL_FORMAT_PAL8)
+        return line[x];
+    else if (dc->pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16)
+        return _GRAY16_INDEX(line, x);
+
+    return _MONO_INDEX(line, x);
+}
+
+rt_inline void _dc_indexed_set(struct rtgui_dc_buffer *dc, rt_uint8_t *line, int x, rt_uint8_t index)
+{
+    if (dc->pixel_format == RTGUI_PIXEL_FORMAT_PAL8)
+    {
+        line[x] = index;
+    }
+    else if (dc->pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16)
+    {
+        int shift = (x & 0x01) ? 0 : 4;
+
+        line[x >> 1] = (line[x >> 1] & ~(0x0f << shift)) | (index << shift);
+    }
+    else
+    {
+        int shift = 7 - (x & 0x07);
+
+        line[x >> 3] = (line[x >> 3] & ~(0x01 << shift)) | (index << shift);
+    }
+}
+
+/* get the color of pixel x in a line of graphic device format */
+static rtgui_color_t _dc_hw_line_color(rt_uint8_t pixel_format, const rt_uint8_t *line, int x)
+{
+    switch (pixel_format)
+    {
+    case RTGRAPHIC_PIXEL_FORMAT_MONO:
+        return rtgui_color_from_mono(_MONO_INDEX(line, x));
+    case RTGRAPHIC_PIXEL_FORMAT_GRAY16:
+        return RTGUI_RGB(_GRAY16_INDEX(line, x) * 17, _GRAY16_INDEX(line, x) * 17,
+                         _GRAY16_INDEX(line, x) * 17);
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+        return rtgui_color_from_565(((const rt_uint16_t *)line)[x]);
+    case RTGRAPHIC_PIXEL_FORMAT_BGR565:
+        return rtgui_color_from_565p(((const rt_uint16_t *)line)[x]);
+    case RTGRAPHIC_PIXEL_FORMAT_RGB888:
+        line += x * 3;
+        return RTGUI_RGB(line[0], line[1], line[2]);
+    case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
+        return rtgui_color_from_888(((const rt_uint32_t *)line)[x]);
+    }
+
+    return black;
+}
+
+/* fill [x1, x2) x [y1, y2) of indexed dc, the area should be clipped */
+static void _dc_indexed_fill(struct rtgui_dc_buffer *dc, int x1, int x2, int y1, int y2,
+                             rtgui_color_t color)
+{
+    int x, ppb;
+    rt_uint8_t index, fill, *line;
+
+    if (x1 >= x2 || y1 >= y2) return;
+
+    index = _dc_palette_index(dc->palette, color);
+    if (dc->pixel_format == RTGUI_PIXEL_FORMAT_PAL8)
+    {
+        ppb = 1;
+        fill = index;
+    }
+    else if (dc->pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16)
+    {
+        ppb = 2;
+        fill = index * 0x11;
+    }
+    else
+    {
+        ppb = 8;
+        fill = index ? 0xff : 0x00;
+    }
+
+    for (line = dc->pixel + y1 * dc->pitch; y1 < y2; y1 ++, line += dc->pitch)
+    {
+        /* the pixels in partial bytes on both ends and the whole bytes in middle */
+        for (x = x1; x < x2 && (x % ppb); x ++)
+            _dc_indexed_set(dc, line, x, index);
+        if (x2 - x >= ppb)
+        {
+            rt_memset(line + x / ppb, fill, (x2 - x) / ppb);
+            x += (x2 - x) / ppb * ppb;
+        }
+        for (; x < x2; x ++)
+            _dc_indexed_set(dc, line, x, index);
+    }
+}
+
+#define _INDEXED_EXPAND(type)                                                   \
+    do {                                                                        \
+        type *d = (type *)dst;                                                  \
+        if (dc->pixel_format == RTGUI_PIXEL_FORMAT_PAL8)                        \
+            for (x = x1; x < x2; x ++) *d++ = (type)lut[line[x]];               \
+        else if (dc->pixel_format == RTGRAPHIC_PIXEL_FORMAT_GRAY16)             \
+            for (x = x1; x < x2; x ++) *d++ = (type)lut[_GRAY16_INDEX(line, x)]; \
+        else                                                                    \
+            for (x = x1; x < x2; x ++) *d++ = (type)lut[_MONO_INDEX(line, x)];  \
+    } while (0)
+
+/* expand the pixels [x1, x2) of line y to @dst with the lookup table */
+static void _dc_indexed_expand_line(struct rtgui_dc_buffer *dc, int x1, int x2, int y,
+                                    rt_uint8_t *dst, int bpp)
+{
+    int x;
+    const rt_uint32_t *lut = dc->palette->lut;
+    const rt_uint8_t *line = dc->pixel + y * dc->pitch;
+
+    switch (bpp)
+    {
+    case 2:
+        _INDEXED_EXPAND(rt_uint16_t);
+        break;
+    case 4:
+        _INDEXED_EXPAND(rt_uint32_t);
+        break;
+    case 3:
+        for (x = x1; x < x2; x ++)
+        {
+            rt_uint32_t pixel = lut[_dc_indexed_get(dc, line, x)];
+
+            *dst++ = (pixel >> 16) & 0xff;
+            *dst++ = (pixel >> 8) & 0xff;
+            *dst++ = pixel & 0xff;
+        }
+        break;
+    }
+}
+
+/*
+ * Blit the indexed dc. The pixels are expanded with the lookup table when
+ * the destination is a memory buffer, a framebuffer or a device with line
+ * blit in RGB565/BGR565/RGB888/ARGB888 format, otherwise each line is drawn
+ * as the runs of same color.
+ */
+static void _dc_indexed_blit(struct rtgui_dc_buffer *dc, struct rtgui_point *dc_point,
+                             struct rtgui_dc *dest, struct rtgui_rect *dest_rect,
+                             int width, int height)
+{
+    int x, y, bpp;
+    struct rtgui_graphic_driver *hw_driver;
+
+    hw_driver = rtgui_graphic_driver_get_default();
+
+    if (dest->type == RTGUI_DC_BUFFER)
+    {
+        struct rtgui_dc_buffer *dest_dc = (struct rtgui_dc_buffer *)dest;
+
+        bpp = _dc_palette_lut_bpp(dest_dc->pixel_format);
+        if (bpp != 0)
+        {
+            _dc_palette_update_lut(dc->palette, dest_dc->pixel_format);
+            for (y = 0; y < height; y ++)
+            {
+                _dc_indexed_expand_line(dc, dc_point->x, dc_point->x + width, dc_point->y + y,
+                                        _dc_get_pixel(dest_dc, dest_rect->x1, dest_rect->y1 + y), bpp);
+            }
+            return;
+        }
+    }
+    else if ((bpp = _dc_palette_lut_bpp(hw_driver->pixel_format)) != 0)
+    {
+        _dc_palette_update_lut(dc->palette, hw_driver->pixel_format);
+
+        if (hw_driver->framebuffer != RT_NULL && dest->type == RTGUI_DC_CLIENT)
+        {
+            int index;
+            struct rtgui_widget *owner;
+            struct rtgui_region dest_region;
+            struct rtgui_rect dest_extent;
+
+            owner = RTGUI_CONTAINER_OF(dest, struct rtgui_widget, dc_type);
+
+            dest_extent = *dest_rect;
+            dest_extent.x2 = dest_extent.x1 + width;
+            dest_extent.y2 = dest_extent.y1 + height;
+            rtgui_widget_rect_to_device(owner, &dest_extent);
+
+            rtgui_region_init_with_extents(&dest_region, &dest_extent);
+            rtgui_region_intersect_rect(&dest_region, &(owner->clip), &dest_extent);
+
+            for (index = 0; index < rtgui_region_num_rects(&dest_region); index ++)
+            {
+                struct rtgui_rect *r = &(rtgui_region_rects(&dest_region)[index]);
+
+                for (y = r->y1; y < r->y2; y ++)
+                {
+                    _dc_indexed_expand_line(dc, dc_point->x + (r->x1 - dest_extent.x1),
+                                            dc_point->x + (r->x2 - dest_extent.x1),
+                                            dc_point->y + (y - dest_extent.y1),
+                                            _hw_get_pixel(hw_driver, r->x1, y, rt_uint8_t), bpp);
+                }
+            }
+
+            rtgui_region_fini(&dest_region);
+        }
+        else if (hw_driver->framebuffer != RT_NULL && dest->type == RTGUI_DC_HW)
+        {
+            struct rtgui_widget *owner = ((struct rtgui_dc_hw *)dest)->owner;
+
+            for (y = 0; y < height; y ++)
+            {
+                _dc_indexed_expand_line(dc, dc_point->x, dc_point->x + width, dc_point->y + y,
+                                        _hw_get_pixel(hw_driver, owner->extent.x1 + dest_rect->x1,
+                                                      owner->extent.y1 + dest_rect->y1 + y, rt_uint8_t), bpp);
+            }
+        }
+        else
+        {
+            rt_uint8_t *line_ptr;
+
+            line_ptr = (rt_uint8_t *) rtgui_malloc(width * bpp);
+            if (line_ptr == RT_NULL) return;
+
+            for (y = 0; y < height; y ++)
+            {
+                _dc_indexed_expand_line(dc, dc_point->x, dc_point->x + width, dc_point->y + y, line_ptr, bpp);
+                dest->engine->blit_line(dest, dest_rect->x1, dest_rect->x1 + width,
+                                        dest_rect->y1 + y, line_ptr);
+            }
+
+            rtgui_free(line_ptr);
+        }
+        return;
+    }
+
+    /* draw the runs of same color */
+    {
+        rtgui_color_t foreground = RTGUI_DC_FC(dest);
+
+        for (y = 0; y < height; y ++)
+        {
+            const rt_uint8_t *line = dc->pixel + (dc_point->y + y) * dc->pitch;
+
+            for (x = 0; x < width;)
+            {
+                int start = x;
+                rt_uint8_t index = _dc_indexed_get(dc, line, dc_point->x + x);
+
+                for (x ++; x < width; x ++)
+                {
+                    if (_dc_indexed_get(dc, line, dc_point->x + x) != index) break;
+                }
+
+                RTGUI_DC_FC(dest) = dc->palette->colors[index];
+                rtgui_dc_draw_hline(dest, dest_rect->x1 + start, dest_rect->x1 + x, dest_rect->y1 + y);
+            }
+        }
+
+        RTGUI_DC_FC(dest) = foreground;
+    }
+}
+
+/*
+ * Blit the pixels of @info to the indexed dc at (x, y). Each pixel is
+ * blended with the palette color under it and mapped to the nearest one.
+ */
+static void _dc_indexed_blit_info(struct rtgui_dc_buffer *dc, int x, int y,
+                                  struct rtgui_blit_info *info)
+{
+    int i, j, width, height;
+    rt_uint32_t alpha;
+    rt_uint8_t *line;
+    const rt_uint8_t *src;
+    rtgui_color_t color, back;
+
+    width = _UI_MIN(info->src_w, info->dst_w);
+    height = _UI_MIN(info->src_h, info->dst_h);
+
+    for (j = 0; j < height; j ++)
+    {
+        src = info->src + j * info->src_pitch;
+        line = dc->pixel + (y + j) * dc->pitch;
+
+        for (i = 0; i < width; i ++)
+        {
+            color = _dc_hw_line_color(info->src_fmt, src, i);
+            alpha = info->a;
+            if (info->src_fmt == RTGRAPHIC_PIXEL_FORMAT_ARGB888)
+                alpha = ((((const rt_uint32_t *)src)[i] >> 24) * alpha + 128) / 255;
+
+            if (alpha == 0) continue;
+            if (alpha != 255)
+            {
+                back = dc->palette->colors[_dc_indexed_get(dc, line, x + i)];
+                color = RTGUI_RGB((RTGUI_RGB_R(color) * alpha + RTGUI_RGB_R(back) * (255 - alpha)) / 255,
+                                  (RTGUI_RGB_G(color) * alpha + RTGUI_RGB_G(back) * (255 - alpha)) / 255,
+                                  (RTGUI_RGB_B(color) * alpha + RTGUI_RGB_B(back) * (255 - alpha)) / 255);
+            }
+
+            _dc_indexed_set(dc, line, x + i, _dc_palette_index(dc->palette, color));
+        }
+    }
+}
+
+/*
+ * Blit the source of @info to the buffer dc at (x, y). The dst of @info is
+ * filled here except the dst_w and dst_h, the indexed dc is drawn through
+ * its palette as rtgui_blit doesn't know it.
+ */
+void rtgui_dc_buffer_blit_info(struct rtgui_dc *self, int x, int y, struct rtgui_blit_info *info)
+{
+    struct rtgui_dc_buffer *dc = (struct rtgui_dc_buffer *)self;
+
+    RT_ASSERT(self != RT_NULL && self->type == RTGUI_DC_BUFFER);
+
+    if (dc->palette)
+    {
+        _dc_indexed_blit_info(dc, x, y, info);
+        return;
+    }
+
+    info->dst = _dc_get_pixel(dc, x, y);
+    info->dst_fmt = dc->pixel_format;
+    info->dst_pitch = dc->pitch;
+    info->dst_skip = info->dst_pitch - info->dst_w * rtgui_color_get_bpp(dc->pixel_format);
+    info->dither_x = x;
+    info->dither_y = y;
+
+    rtgui_blit(info);
+}
+RTM_EXPORT(rtgui_dc_buffer_blit_info);
+
+/* get the palette color of pixel (x, y) of the indexed buffer dc */
+rtgui_color_t rtgui_dc_buffer_get_color(struct rtgui_dc *self, int x, int y)
+{
+    struct rtgui_dc_buffer *dc = (struct rtgui_dc_buffer *)self;
+
+    RT_ASSERT(self != RT_NULL && self->type == RTGUI_DC_BUFFER && dc->palette != RT_NULL);
+
+    if (x < 0 || y < 0 || x >= dc->width || y >= dc->height)
+        return black;
+
+    return dc->palette->colors[_dc_indexed_get(dc, dc->pixel + y * dc->pitch, x)];
+}
+RTM_EXPORT(rtgui_dc_buffer_get_color);
+
+rt_err_t rtgui_dc_buffer_set_palette(struct rtgui_dc *dc, const rtgui_color_t *colors,
+                                     int first, int count)
+{
+    int index;
+    struct rtgui_dc_palette *palette;
+
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(colors != RT_NULL);
+
+    if (dc->type != RTGUI_DC_BUFFER) return -RT_ERROR;
+    palette = ((struct rtgui_dc_buffer *)dc)->palette;
+    if (palette == RT_NULL) return -RT_ERROR;
+    if (first < 0 || count < 0 || first + count > palette->ncolors) return -RT_ERROR;
+
+    for (index = 0; index < count; index ++)
+        palette->colors[first + index] = colors[index] | 0xff000000;
+
+    /* rebuild the lookup table and the color cache on the next use */
+    palette->lut_valid = RT_FALSE;
+    palette->last_color = palette->colors[0];
+    palette->last_index = 0;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rtgui_dc_buffer_set_palette);
+
 struct rtgui_dc *rtgui_dc_buffer_create(int w, int h)
 {
     rt_uint8_t pixel_format;
@@ -83,17 +576,34 @@ struct rtgui_dc *rtgui_dc_buffer_create_pixformat(rt_uint8_t pixel_format, int w
     {
         dc->parent.type = RTGUI_DC_BUFFER;
         dc->parent.engine = &dc_buffer_engine;
+        dc->parent.scissor = RT_NULL;
         dc->gc.foreground = default_foreground;
         dc->gc.background = default_background;
         dc->gc.font = rtgui_font_default();
         dc->gc.textalign = RTGUI_ALIGN_LEFT | RTGUI_ALIGN_TOP;
         dc->gc.textstyle = RTGUI_TEXTSTYLE_NORMAL;
+        dc->gc.dither = RTGUI_DITHER_NONE;
         dc->pixel_format = pixel_format;
         dc->pixel_alpha = 255;
+        dc->palette = RT_NULL;
 
         dc->width = w;
         dc->height = h;
-        dc->pitch = w * rtgui_color_get_bpp(pixel_format);
+        if (_dc_format_is_indexed(pixel_format))
+        {
+            /* the packed pixels of a line start from a byte */
+            dc->pitch = (w * rtgui_color_get_bits(pixel_format) + 7) / 8;
+            dc->palette = _dc_palette_create(pixel_format);
+            if (!dc->palette)
+            {
+                rtgui_free(dc);
+                return RT_NULL;
+            }
+        }
+        else
+        {
+            dc->pitch = w * rtgui_color_get_bpp(pixel_format);
+        }
 
 #ifdef GUIENGINE_IMAGE_CONTAINER
         dc->image_item = RT_NULL;
@@ -101,6 +611,7 @@ struct rtgui_dc *rtgui_dc_buffer_create_pixformat(rt_uint8_t pixel_format, int w
         dc->pixel = rtgui_malloc(h * dc->pitch);
         if (!dc->pixel)
         {
+            if (dc->palette) rtgui_free(dc->palette);
             rtgui_free(dc);
             return RT_NULL;
         }
@@ -124,12 +635,15 @@ struct rtgui_dc *rtgui_img_dc_create_pixformat(rt_uint8_t pixel_format,
     {
         dc->parent.type = RTGUI_DC_BUFFER;
         dc->parent.engine = &dc_buffer_engine;
+        dc->parent.scissor = RT_NULL;
         dc->gc.foreground = default_foreground;
         dc->gc.background = default_background;
         dc->gc.font = rtgui_font_default();
         dc->gc.textalign = RTGUI_ALIGN_LEFT | RTGUI_ALIGN_TOP;
+        dc->gc.dither = RTGUI_DITHER_NONE;
         dc->pixel_format = pixel_format;
         dc->pixel_alpha = 255;
+        dc->palette = RT_NULL;
 
         dc->width = image_item->image->w;
         dc->height = image_item->image->h;
@@ -164,6 +678,8 @@ struct rtgui_dc *rtgui_dc_buffer_create_from_dc(struct rtgui_dc* dc)
         if (buffer != RT_NULL)
         {
             memcpy(buffer->pixel, d->pixel, d->pitch * d->height);
+            if (d->palette)
+                rtgui_dc_buffer_set_palette(RTGUI_DC(buffer), d->palette->colors, 0, d->palette->ncolors);
             d->pixel_alpha = 255;
 
             return RTGUI_DC(buffer);
@@ -209,6 +725,8 @@ static rt_bool_t rtgui_dc_buffer_fini(struct rtgui_dc *dc)
 
     if (buffer->pixel)
         rtgui_free(buffer->pixel);
+    if (buffer->palette)
+        rtgui_free(buffer->palette);
 
     return RT_TRUE;
 }
@@ -216,6 +734,7 @@ static rt_bool_t rtgui_dc_buffer_fini(struct rtgui_dc *dc)
 static void rtgui_dc_buffer_draw_point(struct rtgui_dc *self, int x, int y)
 {
     struct rtgui_dc_buffer *dst;
+    rtgui_rect_t *scissor;
     unsigned r, g, b, a;
 
     dst = (struct rtgui_dc_buffer *)self;
@@ -223,6 +742,15 @@ static void rtgui_dc_buffer_draw_point(struct rtgui_dc *self, int x, int y)
     /* does not draw point out of dc */
     if ((x >= dst->width) || (y >= dst->height)) return;
     if (x < 0 || y < 0) return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK) return;
+
+    if (dst->palette)
+    {
+        _dc_indexed_set(dst, dst->pixel + y * dst->pitch, x,
+                        _dc_palette_index(dst->palette, dst->gc.foreground));
+        return;
+    }
 
     r = RTGUI_RGB_R(dst->gc.foreground);
     g = RTGUI_RGB_G(dst->gc.foreground);
@@ -249,6 +777,7 @@ static void rtgui_dc_buffer_draw_point(struct rtgui_dc *self, int x, int y)
 static void rtgui_dc_buffer_draw_color_point(struct rtgui_dc *self, int x, int y, rtgui_color_t color)
 {
     struct rtgui_dc_buffer *dst;
+    rtgui_rect_t *scissor;
     unsigned r, g, b, a;
 
     dst = (struct rtgui_dc_buffer *)self;
@@ -256,6 +785,14 @@ static void rtgui_dc_buffer_draw_color_point(struct rtgui_dc *self, int x, int y
     /* does not draw point out of dc */
     if ((x >= dst->width) || (y >= dst->height)) return;
     if (x < 0 || y < 0) return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK) return;
+
+    if (dst->palette)
+    {
+        _dc_indexed_set(dst, dst->pixel + y * dst->pitch, x, _dc_palette_index(dst->palette, color));
+        return;
+    }
 
     r = RTGUI_RGB_R(color);
     g = RTGUI_RGB_G(color);
@@ -282,16 +819,32 @@ static void rtgui_dc_buffer_draw_color_point(struct rtgui_dc *self, int x, int y
 static void rtgui_dc_buffer_draw_vline(struct rtgui_dc *self, int x1, int y1, int y2)
 {
     struct rtgui_dc_buffer *dst;
+    rtgui_rect_t *scissor;
     unsigned r, g, b, a;
 
     dst = (struct rtgui_dc_buffer *)self;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (x1 < scissor->x1 || x1 >= scissor->x2) return;
+        if (y1 < scissor->y1) y1 = scissor->y1;
+        if (y2 > scissor->y2) y2 = scissor->y2;
+        if (y1 >= y2) return;
+    }
+
     if (x1 < 0 || x1 >= dst->width) return;
     if (y1 >= dst->height) return;
 
     if (y1 < 0) y1 = 0;
     if (y2 > dst->height) y2 = dst->height;
 
+    if (dst->palette)
+    {
+        _dc_indexed_fill(dst, x1, x1 + 1, y1, y2, dst->gc.foreground);
+        return;
+    }
+
     r = RTGUI_RGB_R(dst->gc.foreground);
     g = RTGUI_RGB_G(dst->gc.foreground);
     b = RTGUI_RGB_B(dst->gc.foreground);
@@ -321,10 +874,20 @@ static void rtgui_dc_buffer_draw_vline(struct rtgui_dc *self, int x1, int y1, in
 static void rtgui_dc_buffer_draw_hline(struct rtgui_dc *self, int x1, int x2, int y1)
 {
     struct rtgui_dc_buffer *dst;
+    rtgui_rect_t *scissor;
     unsigned r, g, b, a;
 
     dst = (struct rtgui_dc_buffer *)self;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (y1 < scissor->y1 || y1 >= scissor->y2) return;
+        if (x1 < scissor->x1) x1 = scissor->x1;
+        if (x2 > scissor->x2) x2 = scissor->x2;
+        if (x1 >= x2) return;
+    }
+
     /* parameter checking */
     if (y1 < 0 || y1 >= dst->height) return;
     if (x1 >= dst->width) return;
@@ -332,6 +895,12 @@ static void rtgui_dc_buffer_draw_hline(struct rtgui_dc *self, int x1, int x2, in
     if (x1 < 0) x1 = 0;
     if (x2 > dst->width) x2 = dst->width;
 
+    if (dst->palette)
+    {
+        _dc_indexed_fill(dst, x1, x2, y1, y1 + 1, dst->gc.foreground);
+        return;
+    }
+
     r = RTGUI_RGB_R(dst->gc.foreground);
     g = RTGUI_RGB_G(dst->gc.foreground);
     b = RTGUI_RGB_B(dst->gc.foreground);
@@ -362,11 +931,17 @@ static void rtgui_dc_buffer_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
 {
     struct rtgui_dc_buffer *dst;
     unsigned r, g, b, a;
-    rtgui_rect_t _r, *rect;
+    rtgui_rect_t _r, *rect, *scissor;
 
     RT_ASSERT(self);
     if (dst_rect == RT_NULL) rtgui_dc_get_rect(self, &_r);
     else _r = *dst_rect;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        rtgui_rect_intersect(scissor, &_r);
+        if (_r.x1 >= _r.x2 || _r.y1 >= _r.y2) return;
+    }
 
     dst = (struct rtgui_dc_buffer *)self;
 
@@ -388,6 +963,12 @@ static void rtgui_dc_buffer_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
         _r.y2 = dst->height;
     rect = &_r;
 
+    if (dst->palette)
+    {
+        _dc_indexed_fill(dst, rect->x1, rect->x2, rect->y1, rect->y2, dst->gc.background);
+        return;
+    }
+
     r = RTGUI_RGB_R(dst->gc.background);
     g = RTGUI_RGB_G(dst->gc.background);
     b = RTGUI_RGB_B(dst->gc.background);
@@ -422,7 +1003,7 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
 {
     int pitch;
     rt_uint16_t rect_width, rect_height;
-    struct rtgui_rect _rect, *dest_rect;
+    struct rtgui_rect _rect, *dest_rect, *scissor;
     struct rtgui_point dc_point;
     struct rtgui_dc_buffer *dc = (struct rtgui_dc_buffer *)self;
 
@@ -468,6 +1049,30 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
             dest_rect->y2 = _rect.y2;
     }
 
+    scissor = rtgui_dc_get_scissor(dest);
+    if (scissor != RT_NULL)
+    {
+        /* the bounds of dest dc are used, keep the rect of caller */
+        _rect = *dest_rect;
+        dest_rect = &_rect;
+
+        if (dest_rect->x1 < scissor->x1)
+        {
+            dc_point.x += scissor->x1 - dest_rect->x1;
+            dest_rect->x1 = scissor->x1;
+        }
+        if (dest_rect->y1 < scissor->y1)
+        {
+            dc_point.y += scissor->y1 - dest_rect->y1;
+            dest_rect->y1 = scissor->y1;
+        }
+        if (dest_rect->x2 > scissor->x2)
+            dest_rect->x2 = scissor->x2;
+        if (dest_rect->y2 > scissor->y2)
+            dest_rect->y2 = scissor->y2;
+        if (dest_rect->x1 >= dest_rect->x2 || dest_rect->y1 >= dest_rect->y2) return;
+    }
+
     if (dest_rect->x2 < dest_rect->x1 || dest_rect->y2 < dest_rect->y1) return;
     if (dc_point.x >= dc->width || dc_point.y >= dc->height) return;
 
@@ -475,6 +1080,12 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
     rect_width  = _UI_MIN(rtgui_rect_width(*dest_rect), dc->width - dc_point.x);
     rect_height = _UI_MIN(rtgui_rect_height(*dest_rect), dc->height - dc_point.y);
 
+    if (dc->palette)
+    {
+        _dc_indexed_blit(dc, &dc_point, dest, dest_rect, rect_width, rect_height);
+        return;
+    }
+
     if ((dest->type == RTGUI_DC_HW) || (dest->type == RTGUI_DC_CLIENT))
     {
         int index;
@@ -517,6 +1128,9 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
             info.dst_w = rect_width;
             info.dst_pitch = hw_driver->pitch;
             info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(hw_driver->pixel_format);
+            info.dither = RTGUI_DC_DITHER(dest);
+            info.dither_x = owner->extent.x1 + dest_rect->x1;
+            info.dither_y = owner->extent.y1 + dest_rect->y1;
 
             rtgui_blit(&info);
         }
@@ -555,6 +1169,7 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
 
             info.dst_fmt = hw_driver->pixel_format;
             info.dst_pitch = hw_driver->pitch;
+            info.dither = RTGUI_DC_DITHER(dest);
 
             for (index = 0; index < num_rects; index ++)
             {
@@ -577,6 +1192,8 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
                 info.dst_h = blit_height;
                 info.dst_w = blit_width;
                 info.dst_skip = info.dst_pitch - info.dst_w * hw_bpp;
+                info.dither_x = r->x1;
+                info.dither_y = r->y1;
 
                 rtgui_blit(&info);
             }
@@ -657,25 +1274,38 @@ static void rtgui_dc_buffer_blit(struct rtgui_dc *self,
         info.src_skip = info.src_pitch - info.src_w * rtgui_color_get_bpp(dc->pixel_format);
 
         /* blit destination */
-        info.dst = _dc_get_pixel(dest_dc, dest_rect->x1, dest_rect->y1);
-        info.dst_fmt = dest_dc->pixel_format;
         info.dst_h = rect_height;
         info.dst_w = rect_width;
-        info.dst_pitch = dest_dc->pitch;
-        info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(dest_dc->pixel_format);
+        info.dither = RTGUI_DC_DITHER(dest);
 
-        rtgui_blit(&info);
+        rtgui_dc_buffer_blit_info(dest, dest_rect->x1, dest_rect->y1, &info);
     }
 }
 
 static void rtgui_dc_buffer_blit_line(struct rtgui_dc *self, int x1, int x2, int y, rt_uint8_t *line_data)
 {
     rt_uint8_t *pixel;
+    int skip = 0;
+    rtgui_rect_t *scissor;
     struct rtgui_dc_buffer *dc = (struct rtgui_dc_buffer *)self;
 
     RT_ASSERT(dc != RT_NULL);
     RT_ASSERT(line_data != RT_NULL);
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (y < scissor->y1 || y >= scissor->y2) return;
+        /* the pixels out of scissor are skipped in the line data */
+        if (x1 < scissor->x1)
+        {
+            skip = scissor->x1 - x1;
+            x1 = scissor->x1;
+        }
+        if (x2 > scissor->x2) x2 = scissor->x2;
+        if (x1 >= x2) return;
+    }
+
     /* out of range */
     if ((x1 >= dc->width) || (y >= dc->height) || y < 0 || x1 == x2)
         return;
@@ -686,8 +1316,26 @@ static void rtgui_dc_buffer_blit_line(struct rtgui_dc *self, int x1, int x2, int
     if (x2 >= dc->width)
         x2 = dc->width;
 
+    if (dc->palette)
+    {
+        int x;
+        rt_uint8_t hw_format;
+
+        /* the line data is in the format of graphic device, as the images
+         * load it, each pixel is mapped to the nearest palette color */
+        hw_format = rtgui_graphic_driver_get_default()->pixel_format;
+        for (x = x1; x < x2; x ++)
+        {
+            _dc_indexed_set(dc, dc->pixel + y * dc->pitch, x,
+                            _dc_palette_index(dc->palette,
+                                              _dc_hw_line_color(hw_format, line_data, x - x1 + skip)));
+        }
+        return;
+    }
+
     pixel = _dc_get_pixel(dc,x1,y);
-    memcpy(pixel, line_data, (x2 - x1) * rtgui_color_get_bpp(dc->pixel_format));
+    memcpy(pixel, line_data + skip * rtgui_color_get_bpp(dc->pixel_format),
+           (x2 - x1) * rtgui_color_get_bpp(dc->pixel_format));
 }
 
 #ifdef RT_USING_DFS
@@ -713,7 +1361,7 @@ void rtgui_dc_buffer_dump(struct rtgui_dc *self, char *fn)
     if (fd >= 0)
     {
         write(fd, &header, sizeof(header));
-        write(fd, buffer->pixel, header.w * header.h * rtgui_color_get_bpp(header.format));
+        write(fd, buffer->pixel, buffer->pitch * header.h);
         close(fd);
     }
 }
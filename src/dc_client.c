@@ -70,6 +70,7 @@ void rtgui_dc_client_init(rtgui_widget_t *owner)
     dc = RTGUI_WIDGET_DC(owner);
     dc->type = RTGUI_DC_CLIENT;
     dc->engine = &dc_client_engine;
+    dc->scissor = RT_NULL;
 }
 
 struct rtgui_dc *rtgui_dc_client_create(rtgui_widget_t *owner)
@@ -92,12 +93,15 @@ static rt_bool_t rtgui_dc_client_fini(struct rtgui_dc *dc)
  */
 static void rtgui_dc_client_draw_point(struct rtgui_dc *self, int x, int y)
 {
-    rtgui_rect_t rect;
+    rtgui_rect_t rect, *scissor;
     rtgui_widget_t *owner;
 
     if (self == RT_NULL) return;
     if (!rtgui_dc_get_visible(self)) return;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK) return;
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -113,12 +117,15 @@ static void rtgui_dc_client_draw_point(struct rtgui_dc *self, int x, int y)
 
 static void rtgui_dc_client_draw_color_point(struct rtgui_dc *self, int x, int y, rtgui_color_t color)
 {
-    rtgui_rect_t rect;
+    rtgui_rect_t rect, *scissor;
     rtgui_widget_t *owner;
 
     if (self == RT_NULL) return;
     if (!rtgui_dc_get_visible(self)) return;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK) return;
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -138,11 +145,22 @@ static void rtgui_dc_client_draw_color_point(struct rtgui_dc *self, int x, int y
 static void rtgui_dc_client_draw_vline(struct rtgui_dc *self, int x, int y1, int y2)
 {
     register rt_base_t index;
+    rtgui_rect_t *scissor;
     rtgui_widget_t *owner;
 
     if (self == RT_NULL) return;
     if (!rtgui_dc_get_visible(self)) return;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (y1 > y2) _int_swap(y1, y2);
+        if (x < scissor->x1 || x >= scissor->x2) return;
+        if (y1 < scissor->y1) y1 = scissor->y1;
+        if (y2 > scissor->y2) y2 = scissor->y2;
+        if (y1 >= y2) return;
+    }
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -197,11 +215,22 @@ static void rtgui_dc_client_draw_vline(struct rtgui_dc *self, int x, int y1, int
 static void rtgui_dc_client_draw_hline(struct rtgui_dc *self, int x1, int x2, int y)
 {
     register rt_base_t index;
+    rtgui_rect_t *scissor;
     rtgui_widget_t *owner;
 
     if (self == RT_NULL) return;
     if (!rtgui_dc_get_visible(self)) return;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (x1 > x2) _int_swap(x1, x2);
+        if (y < scissor->y1 || y >= scissor->y2) return;
+        if (x1 < scissor->x1) x1 = scissor->x1;
+        if (x2 > scissor->x2) x2 = scissor->x2;
+        if (x1 >= x2) return;
+    }
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -255,6 +284,7 @@ static void rtgui_dc_client_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
 {
     rtgui_color_t foreground;
     register rt_base_t index;
+    rtgui_rect_t area, *scissor;
     rtgui_widget_t *owner;
 
     RT_ASSERT(self);
@@ -262,6 +292,16 @@ static void rtgui_dc_client_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
 
     if (!rtgui_dc_get_visible(self)) return;
 
+    /* only fill the lines in the scissor */
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        area = *rect;
+        if (area.y1 < scissor->y1) area.y1 = scissor->y1;
+        if (area.y2 > scissor->y2) area.y2 = scissor->y2;
+        rect = &area;
+    }
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -284,11 +324,27 @@ static void rtgui_dc_client_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
 static void rtgui_dc_client_blit_line(struct rtgui_dc *self, int x1, int x2, int y, rt_uint8_t *line_data)
 {
     register rt_base_t index;
+    rtgui_rect_t *scissor;
     rtgui_widget_t *owner;
 
     if (self == RT_NULL) return;
     if (!rtgui_dc_get_visible(self)) return;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (x1 > x2) _int_swap(x1, x2);
+        if (y < scissor->y1 || y >= scissor->y2) return;
+        if (x1 < scissor->x1)
+        {
+            /* skip the pixels out of scissor */
+            line_data += (scissor->x1 - x1) * _UI_BITBYTES(hw_driver->bits_per_pixel);
+            x1 = scissor->x1;
+        }
+        if (x2 > scissor->x2) x2 = scissor->x2;
+        if (x1 >= x2) return;
+    }
+
     /* get owner */
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
 
@@ -308,13 +364,14 @@ static void rtgui_dc_client_blit_line(struct rtgui_dc *self, int x1, int x2, int
         if (prect->y1 > y  || prect->y2 <= y) return;
         if (prect->x2 <= x1 || prect->x1 > x2) return;
 
-        if (prect->x1 > x1) x1 = prect->x1;
+        /* skip the pixels clipped at the left side */
+        if (prect->x1 > x1)
+        {
+            offset = prect->x1 - x1;
+            x1 = prect->x1;
+        }
         if (prect->x2 < x2) x2 = prect->x2;
 
-        /* patch note:
-         * We need to adjust the offset when update widget clip!
-         * Of course at ordinary times for 0. General */
-        offset = owner->clip.extents.x1 - owner->extent.x1;
         offset = offset * _UI_BITBYTES(hw_driver->bits_per_pixel);
         /* draw hline */
         hw_driver->ops->draw_raw_hline(line_data + offset, x1, x2, y);
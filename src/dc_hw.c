@@ -67,6 +67,7 @@ struct rtgui_dc *rtgui_dc_hw_create(rtgui_widget_t *owner)
     {
         dc->parent.type = RTGUI_DC_HW;
         dc->parent.engine = &dc_hw_engine;
+        dc->parent.scissor = RT_NULL;
         dc->owner = owner;
         dc->hw_driver = rtgui_graphic_driver_get_default();
 
@@ -92,12 +93,16 @@ static rt_bool_t rtgui_dc_hw_fini(struct rtgui_dc *dc)
 static void rtgui_dc_hw_draw_point(struct rtgui_dc *self, int x, int y)
 {
     struct rtgui_dc_hw *dc;
+    rtgui_rect_t *scissor;
 
     RT_ASSERT(self != RT_NULL);
     dc = (struct rtgui_dc_hw *) self;
 
     if (x < 0 || y < 0)
         return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK)
+        return;
 
     x = x + dc->owner->extent.x1;
     if (x >= dc->owner->extent.x2)
@@ -113,12 +118,16 @@ static void rtgui_dc_hw_draw_point(struct rtgui_dc *self, int x, int y)
 static void rtgui_dc_hw_draw_color_point(struct rtgui_dc *self, int x, int y, rtgui_color_t color)
 {
     struct rtgui_dc_hw *dc;
+    rtgui_rect_t *scissor;
 
     RT_ASSERT(self != RT_NULL);
     dc = (struct rtgui_dc_hw *) self;
 
     if (x < 0 || y < 0)
         return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL && rtgui_rect_contains_point(scissor, x, y) != RT_EOK)
+        return;
 
     x = x + dc->owner->extent.x1;
     if (x >= dc->owner->extent.x2)
@@ -137,12 +146,27 @@ static void rtgui_dc_hw_draw_color_point(struct rtgui_dc *self, int x, int y, rt
 static void rtgui_dc_hw_draw_vline(struct rtgui_dc *self, int x, int y1, int y2)
 {
     struct rtgui_dc_hw *dc;
+    rtgui_rect_t *scissor;
 
     RT_ASSERT(self != RT_NULL);
     dc = (struct rtgui_dc_hw *) self;
 
     if (x < 0)
         return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (y1 > y2)
+            _int_swap(y1, y2);
+        if (x < scissor->x1 || x >= scissor->x2)
+            return;
+        if (y1 < scissor->y1)
+            y1 = scissor->y1;
+        if (y2 > scissor->y2)
+            y2 = scissor->y2;
+        if (y1 >= y2)
+            return;
+    }
     x = x + dc->owner->extent.x1;
     if (x >= dc->owner->extent.x2)
         return;
@@ -170,12 +194,27 @@ static void rtgui_dc_hw_draw_vline(struct rtgui_dc *self, int x, int y1, int y2)
 static void rtgui_dc_hw_draw_hline(struct rtgui_dc *self, int x1, int x2, int y)
 {
     struct rtgui_dc_hw *dc;
+    rtgui_rect_t *scissor;
 
     RT_ASSERT(self != RT_NULL);
     dc = (struct rtgui_dc_hw *) self;
 
     if (y < 0)
         return;
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (x1 > x2)
+            _int_swap(x1, x2);
+        if (y < scissor->y1 || y >= scissor->y2)
+            return;
+        if (x1 < scissor->x1)
+            x1 = scissor->x1;
+        if (x2 > scissor->x2)
+            x2 = scissor->x2;
+        if (x1 >= x2)
+            return;
+    }
     y = y + dc->owner->extent.y1;
     if (y >= dc->owner->extent.y2)
         return;
@@ -201,12 +240,23 @@ static void rtgui_dc_hw_fill_rect(struct rtgui_dc *self, struct rtgui_rect *rect
 {
     rtgui_color_t color;
     register rt_base_t y1, y2, x1, x2;
+    rtgui_rect_t area, *scissor;
     struct rtgui_dc_hw *dc;
 
     RT_ASSERT(self != RT_NULL);
     RT_ASSERT(rect);
     dc = (struct rtgui_dc_hw *) self;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        area = *rect;
+        rtgui_rect_intersect(scissor, &area);
+        if (area.x1 >= area.x2 || area.y1 >= area.y2)
+            return;
+        rect = &area;
+    }
+
     /* get background color */
     color = dc->owner->gc.background;
 
@@ -243,10 +293,30 @@ static void rtgui_dc_hw_fill_rect(struct rtgui_dc *self, struct rtgui_rect *rect
 static void rtgui_dc_hw_blit_line(struct rtgui_dc *self, int x1, int x2, int y, rt_uint8_t *line_data)
 {
     struct rtgui_dc_hw *dc;
+    rtgui_rect_t *scissor;
 
     RT_ASSERT(self != RT_NULL);
     dc = (struct rtgui_dc_hw *) self;
 
+    scissor = rtgui_dc_get_scissor(self);
+    if (scissor != RT_NULL)
+    {
+        if (x1 > x2)
+            _int_swap(x1, x2);
+        if (y < scissor->y1 || y >= scissor->y2)
+            return;
+        if (x1 < scissor->x1)
+        {
+            /* skip the pixels out of scissor */
+            line_data += (scissor->x1 - x1) * _UI_BITBYTES(dc->hw_driver->bits_per_pixel);
+            x1 = scissor->x1;
+        }
+        if (x2 > scissor->x2)
+            x2 = scissor->x2;
+        if (x1 >= x2)
+            return;
+    }
+
     /* convert logic to device */
     if (y < 0)
         return;
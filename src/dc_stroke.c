@@ -0,0 +1,676 @@
+/*
+ * File      : dc_stroke.c
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+#include <rtgui/dc.h>
+#include <rtgui/color.h>
+#include <rtgui/matrix.h>
+#include <rtgui/rtgui_system.h>
+
+#include <stdlib.h> /* for qsort */
+
+/*
+ * The stroker converts a polyline into polygons: a quad for each segment,
+ * a wedge or a disc for each join and the caps on both ends. All of the
+ * polygons are added into one edge list with the same orientation, then
+ * the edge list is filled by a scanline filler with non-zero winding rule,
+ * so every pixel of the stroke is touched only once.
+ *
+ * The coordinate is fixed point with 8 bits fraction, the center of pixel
+ * (x, y) is (x + 0.5, y + 0.5).
+ */
+
+#define STROKE_FRAC_BITS    8
+#define STROKE_ONE          (1 << STROKE_FRAC_BITS)
+#define STROKE_HALF         (STROKE_ONE / 2)
+
+/* sub-scanlines for each pixel row in anti-aliasing mode */
+#define STROKE_AA_SHIFT     2
+#define STROKE_AA_SAMPLES   (1 << STROKE_AA_SHIFT)
+#define STROKE_AA_FULL      (STROKE_ONE * STROKE_AA_SAMPLES)
+
+#define STROKE_MITER_LIMIT  4
+
+struct _stroke_point
+{
+    int x, y;
+};
+
+struct _stroke_edge
+{
+    int y0, y1;
+    int x0;
+    int slope;      /* dx/dy in 16.16 */
+    int dir;        /* winding direction */
+};
+
+struct _stroke_cross
+{
+    int x;
+    int dir;
+};
+
+struct _stroker
+{
+    const struct rtgui_stroke *style;
+    int hw;         /* half of the line width */
+
+    struct _stroke_edge *edges;
+    int count, size;
+    int ymin, ymax;
+
+    rt_bool_t failed;
+};
+
+/* cos(2 * PI * i / 64) in Q14 */
+static const rt_int16_t _stroke_cos[64] =
+{
+     16384,  16305,  16069,  15679,  15137,  14449,  13623,  12665,
+     11585,  10394,   9102,   7723,   6270,   4756,   3196,   1606,
+         0,  -1606,  -3196,  -4756,  -6270,  -7723,  -9102, -10394,
+    -11585, -12665, -13623, -14449, -15137, -15679, -16069, -16305,
+    -16384, -16305, -16069, -15679, -15137, -14449, -13623, -12665,
+    -11585, -10394,  -9102,  -7723,  -6270,  -4756,  -3196,  -1606,
+         0,   1606,   3196,   4756,   6270,   7723,   9102,  10394,
+     11585,  12665,  13623,  14449,  15137,  15679,  16069,  16305,
+};
+
+static rt_uint32_t _stroke_isqrt(uint64_t value)
+{
+    uint64_t result = 0, bit = (uint64_t)1 << 62;
+
+    while (bit > value) bit >>= 2;
+    while (bit)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (rt_uint32_t)result;
+}
+
+static void _stroker_add_edge(struct _stroker *s, const struct _stroke_point *p0,
+                              const struct _stroke_point *p1, int dir)
+{
+    struct _stroke_edge *edge;
+
+    /* horizontal edge never crosses a scanline */
+    if (p0->y == p1->y) return;
+
+    if (s->count == s->size)
+    {
+        struct _stroke_edge *edges;
+        int size = s->size ? s->size * 2 : 32;
+
+        edges = (struct _stroke_edge *) rtgui_realloc(s->edges, size * sizeof(struct _stroke_edge));
+        if (edges == RT_NULL)
+        {
+            s->failed = RT_TRUE;
+            return;
+        }
+        s->edges = edges;
+        s->size = size;
+    }
+
+    if (p0->y > p1->y)
+    {
+        const struct _stroke_point *t = p0;
+        p0 = p1;
+        p1 = t;
+        dir = -dir;
+    }
+
+    edge = &s->edges[s->count++];
+    edge->y0 = p0->y;
+    edge->y1 = p1->y;
+    edge->x0 = p0->x;
+    edge->slope = (int)((int64_t)(p1->x - p0->x) * 65536 / (p1->y - p0->y));
+    edge->dir = dir;
+
+    if (edge->y0 < s->ymin) s->ymin = edge->y0;
+    if (edge->y1 > s->ymax) s->ymax = edge->y1;
+}
+
+/* add a polygon, which is always added in clockwise */
+static void _stroker_add_poly(struct _stroker *s, const struct _stroke_point *pts, int n)
+{
+    int i, dir;
+    int64_t area = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        const struct _stroke_point *a = &pts[i];
+        const struct _stroke_point *b = &pts[(i + 1) % n];
+
+        area += (int64_t)a->x * b->y - (int64_t)b->x * a->y;
+    }
+    if (area == 0) return;
+    dir = area > 0 ? 1 : -1;
+
+    for (i = 0; i < n; i++)
+        _stroker_add_edge(s, &pts[i], &pts[(i + 1) % n], dir);
+}
+
+static void _stroker_add_disc(struct _stroker *s, const struct _stroke_point *c)
+{
+    int i, n, step;
+    struct _stroke_point pts[64];
+
+    /* less vertex on the small disc */
+    n = s->hw <= 3 * STROKE_ONE ? 16 : (s->hw <= 12 * STROKE_ONE ? 32 : 64);
+    step = 64 / n;
+
+    for (i = 0; i < n; i++)
+    {
+        pts[i].x = c->x + ((s->hw * _stroke_cos[(i * step) & 63]) >> 14);
+        pts[i].y = c->y + ((s->hw * _stroke_cos[(i * step + 48) & 63]) >> 14);
+    }
+
+    _stroker_add_poly(s, pts, n);
+}
+
+static void _stroker_add_square(struct _stroker *s, const struct _stroke_point *c)
+{
+    struct _stroke_point pts[4];
+
+    pts[0].x = c->x - s->hw; pts[0].y = c->y - s->hw;
+    pts[1].x = c->x + s->hw; pts[1].y = c->y - s->hw;
+    pts[2].x = c->x + s->hw; pts[2].y = c->y + s->hw;
+    pts[3].x = c->x - s->hw; pts[3].y = c->y + s->hw;
+
+    _stroker_add_poly(s, pts, 4);
+}
+
+/* get the normal of segment p0->p1 with the length of half width */
+static void _stroker_normal(struct _stroker *s, const struct _stroke_point *p0,
+                            const struct _stroke_point *p1, struct _stroke_point *normal)
+{
+    int dx = p1->x - p0->x;
+    int dy = p1->y - p0->y;
+    rt_uint32_t len;
+
+    len = _stroke_isqrt((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+    normal->x = _rtgui_matrix_round_div6432(-(int64_t)dy * s->hw, len);
+    normal->y = _rtgui_matrix_round_div6432((int64_t)dx * s->hw, len);
+}
+
+static void _stroker_add_join(struct _stroker *s, const struct _stroke_point *p,
+                              const struct _stroke_point *n0, const struct _stroke_point *n1)
+{
+    int side;
+    int64_t cross, dot, hw2;
+    struct _stroke_point pts[4];
+
+    cross = (int64_t)n0->x * n1->y - (int64_t)n0->y * n1->x;
+    dot = (int64_t)n0->x * n1->x + (int64_t)n0->y * n1->y;
+    if (cross == 0 && dot > 0) return; /* straight line */
+
+    if (s->style->join == RTGUI_JOIN_ROUND)
+    {
+        _stroker_add_disc(s, p);
+        return;
+    }
+
+    /* the join is on the outer side of the turn */
+    side = cross > 0 ? -1 : 1;
+
+    pts[0] = *p;
+    pts[1].x = p->x + side * n0->x;
+    pts[1].y = p->y + side * n0->y;
+
+    hw2 = (int64_t)s->hw * s->hw;
+    /* |miter| / hw = sqrt(2 * hw^2 / (hw^2 + dot)) */
+    if (s->style->join == RTGUI_JOIN_MITER && (hw2 + dot) > 0 &&
+        (hw2 + dot) * STROKE_MITER_LIMIT * STROKE_MITER_LIMIT >= 2 * hw2)
+    {
+        pts[2].x = p->x + side * (int)(((int64_t)(n0->x + n1->x) * hw2) / (hw2 + dot));
+        pts[2].y = p->y + side * (int)(((int64_t)(n0->y + n1->y) * hw2) / (hw2 + dot));
+        pts[3].x = p->x + side * n1->x;
+        pts[3].y = p->y + side * n1->y;
+        _stroker_add_poly(s, pts, 4);
+    }
+    else
+    {
+        /* bevel */
+        pts[2].x = p->x + side * n1->x;
+        pts[2].y = p->y + side * n1->y;
+        _stroker_add_poly(s, pts, 3);
+    }
+}
+
+/* stroke a piece of polyline without zero length segment */
+static void _stroker_add_piece(struct _stroker *s, const struct _stroke_point *pts, int n)
+{
+    int i;
+    struct _stroke_point normal, last, p0, p1;
+    struct _stroke_point quad[4];
+
+    if (n == 1)
+    {
+        /* a dot */
+        if (s->style->cap == RTGUI_CAP_ROUND)
+            _stroker_add_disc(s, &pts[0]);
+        else if (s->style->cap == RTGUI_CAP_SQUARE)
+            _stroker_add_square(s, &pts[0]);
+        return;
+    }
+
+    for (i = 0; i < n - 1; i++)
+    {
+        _stroker_normal(s, &pts[i], &pts[i + 1], &normal);
+        if (i > 0)
+            _stroker_add_join(s, &pts[i], &last, &normal);
+
+        p0 = pts[i];
+        p1 = pts[i + 1];
+        if (s->style->cap == RTGUI_CAP_SQUARE)
+        {
+            /* extend the end segments by half width */
+            if (i == 0)
+            {
+                p0.x -= normal.y;
+                p0.y += normal.x;
+            }
+            if (i == n - 2)
+            {
+                p1.x += normal.y;
+                p1.y -= normal.x;
+            }
+        }
+
+        quad[0].x = p0.x + normal.x; quad[0].y = p0.y + normal.y;
+        quad[1].x = p1.x + normal.x; quad[1].y = p1.y + normal.y;
+        quad[2].x = p1.x - normal.x; quad[2].y = p1.y - normal.y;
+        quad[3].x = p0.x - normal.x; quad[3].y = p0.y - normal.y;
+        _stroker_add_poly(s, quad, 4);
+
+        last = normal;
+    }
+
+    if (s->style->cap == RTGUI_CAP_ROUND)
+    {
+        _stroker_add_disc(s, &pts[0]);
+        _stroker_add_disc(s, &pts[n - 1]);
+    }
+}
+
+rt_inline void _stroke_piece_append(struct _stroke_point *piece, int *n, int x, int y)
+{
+    if (*n > 0 && piece[*n - 1].x == x && piece[*n - 1].y == y)
+        return;
+
+    piece[*n].x = x;
+    piece[*n].y = y;
+    (*n) ++;
+}
+
+/* split the polyline by dash pattern */
+static void _stroker_add_dash(struct _stroker *s, const struct _stroke_point *pts, int count,
+                              struct _stroke_point *piece)
+{
+    int i, n = 0, index = 0;
+    int remain, total = 0;
+    rt_bool_t on = RT_TRUE;
+    const struct rtgui_stroke *style = s->style;
+
+    for (i = 0; i < style->dash_count; i++)
+        total += style->dash[i];
+    if (total == 0)
+    {
+        /* not a valid pattern, draw as solid line */
+        for (i = 0; i < count; i++)
+            _stroke_piece_append(piece, &n, pts[i].x, pts[i].y);
+        _stroker_add_piece(s, piece, n);
+        return;
+    }
+
+    /* skip the dash offset */
+    remain = style->dash_offset % (style->dash_count & 1 ? 2 * total : total);
+    while (remain >= style->dash[index])
+    {
+        remain -= style->dash[index];
+        index = (index + 1) % style->dash_count;
+        on = !on;
+    }
+    remain = (style->dash[index] - remain) * STROKE_ONE;
+
+    for (i = 0; i < count - 1; i++)
+    {
+        int dx, dy, len, pos = 0, step;
+
+        dx = pts[i + 1].x - pts[i].x;
+        dy = pts[i + 1].y - pts[i].y;
+        len = _stroke_isqrt((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+        if (len == 0) continue;
+
+        while (pos < len)
+        {
+            step = _UI_MIN(remain, len - pos);
+
+            if (on && n == 0)
+                _stroke_piece_append(piece, &n, pts[i].x + (int)((int64_t)dx * pos / len),
+                                     pts[i].y + (int)((int64_t)dy * pos / len));
+            pos += step;
+            remain -= step;
+            if (on)
+                _stroke_piece_append(piece, &n, pts[i].x + (int)((int64_t)dx * pos / len),
+                                     pts[i].y + (int)((int64_t)dy * pos / len));
+
+            if (remain == 0)
+            {
+                if (on && n > 0)
+                    _stroker_add_piece(s, piece, n);
+                n = 0;
+
+                index = (index + 1) % style->dash_count;
+                remain = style->dash[index] * STROKE_ONE;
+                on = !on;
+            }
+        }
+    }
+
+    if (on && n > 0)
+        _stroker_add_piece(s, piece, n);
+}
+
+static int _stroke_edge_compare(const void *a, const void *b)
+{
+    return ((const struct _stroke_edge *)a)->y0 - ((const struct _stroke_edge *)b)->y0;
+}
+
+/* get the crossings of active edges on scanline sy, sorted by x */
+static int _stroker_scan(struct _stroker *s, int sy, int *next, int *active, int *nactive,
+                         struct _stroke_cross *cross)
+{
+    int i, j, n = 0, count = 0;
+
+    /* add the new edges */
+    while (*next < s->count && s->edges[*next].y0 <= sy)
+        active[(*nactive)++] = (*next)++;
+
+    for (i = 0; i < *nactive; i++)
+    {
+        struct _stroke_edge *edge = &s->edges[active[i]];
+        struct _stroke_cross c;
+
+        /* remove the finished edges */
+        if (edge->y1 <= sy) continue;
+        active[n++] = active[i];
+        if (edge->y0 > sy) continue;
+
+        c.x = edge->x0 + (int)(((int64_t)(sy - edge->y0) * edge->slope) >> 16);
+        c.dir = edge->dir;
+
+        /* insertion sort, there are only a few crossings */
+        for (j = count; j > 0 && cross[j - 1].x > c.x; j--)
+            cross[j] = cross[j - 1];
+        cross[j] = c;
+        count ++;
+    }
+    *nactive = n;
+
+    return count;
+}
+
+static void _stroker_fill(struct _stroker *s, struct rtgui_dc *dc, rt_bool_t aa)
+{
+    int y, ystart, yend, width;
+    int next = 0, nactive = 0;
+    int *active = RT_NULL, *cover = RT_NULL, *delta = RT_NULL;
+    struct _stroke_cross *cross = RT_NULL;
+    struct rtgui_rect rect;
+    rtgui_color_t color;
+
+    if (s->count == 0) return;
+
+    rtgui_dc_get_rect(dc, &rect);
+    width = rtgui_rect_width(rect);
+    ystart = _UI_MAX(s->ymin >> STROKE_FRAC_BITS, 0);
+    yend = _UI_MIN((s->ymax + STROKE_ONE - 1) >> STROKE_FRAC_BITS, rtgui_rect_height(rect));
+    if (ystart >= yend || width <= 0) return;
+
+    active = (int *) rtgui_malloc(s->count * sizeof(int));
+    cross = (struct _stroke_cross *) rtgui_malloc(s->count * sizeof(struct _stroke_cross));
+    if (active == RT_NULL || cross == RT_NULL)
+        goto __exit;
+    if (aa)
+    {
+        cover = (int *) rtgui_malloc((width + 1) * sizeof(int));
+        delta = (int *) rtgui_malloc((width + 1) * sizeof(int));
+        if (cover == RT_NULL || delta == RT_NULL)
+            goto __exit;
+        rt_memset(cover, 0, (width + 1) * sizeof(int));
+        rt_memset(delta, 0, (width + 1) * sizeof(int));
+    }
+
+    qsort(s->edges, s->count, sizeof(struct _stroke_edge), _stroke_edge_compare);
+    color = RTGUI_DC_FC(dc);
+
+    for (y = ystart; y < yend; y++)
+    {
+        int sample, samples = aa ? STROKE_AA_SAMPLES : 1;
+        int xmin = width, xmax = 0;
+
+        for (sample = 0; sample < samples; sample++)
+        {
+            int i, count, winding = 0, xa = 0;
+            int sy = aa ? ((y << STROKE_FRAC_BITS) + (sample << (STROKE_FRAC_BITS - STROKE_AA_SHIFT)) +
+                           (STROKE_HALF >> STROKE_AA_SHIFT))
+                     : ((y << STROKE_FRAC_BITS) + STROKE_HALF);
+
+            count = _stroker_scan(s, sy, &next, active, &nactive, cross);
+            for (i = 0; i < count; i++)
+            {
+                int xb, px0, px1;
+
+                if (winding == 0) xa = cross[i].x;
+                winding += cross[i].dir;
+                if (winding != 0) continue;
+
+                xb = cross[i].x;
+                if (!aa)
+                {
+                    /* the pixel whose center is in [xa, xb) */
+                    px0 = _UI_MAX((xa - STROKE_HALF + STROKE_ONE - 1) >> STROKE_FRAC_BITS, 0);
+                    px1 = _UI_MIN((xb - STROKE_HALF + STROKE_ONE - 1) >> STROKE_FRAC_BITS, width);
+                    if (px0 < px1)
+                        rtgui_dc_draw_hline(dc, px0, px1, y);
+                    continue;
+                }
+
+                xa = _UI_MAX(xa, 0);
+                xb = _UI_MIN(xb, width << STROKE_FRAC_BITS);
+                if (xa >= xb) continue;
+
+                px0 = xa >> STROKE_FRAC_BITS;
+                px1 = xb >> STROKE_FRAC_BITS;
+                if (px0 == px1)
+                {
+                    cover[px0] += xb - xa;
+                }
+                else
+                {
+                    cover[px0] += STROKE_ONE - (xa & (STROKE_ONE - 1));
+                    delta[px0 + 1] += STROKE_ONE;
+                    delta[px1] -= STROKE_ONE;
+                    cover[px1] += xb & (STROKE_ONE - 1);
+                }
+                if (px0 < xmin) xmin = px0;
+                if (px1 > xmax) xmax = px1;
+            }
+        }
+
+        if (aa && xmin <= xmax)
+        {
+            int x, run = 0, start = -1;
+            rt_uint8_t r = RTGUI_RGB_R(color), g = RTGUI_RGB_G(color);
+            rt_uint8_t b = RTGUI_RGB_B(color), a = RTGUI_RGB_A(color);
+
+            for (x = xmin; x <= xmax + 1; x++)
+            {
+                int total = 0;
+
+                if (x <= xmax)
+                {
+                    run += delta[x];
+                    total = cover[x] + run;
+                    cover[x] = delta[x] = 0;
+                }
+
+                if (total >= STROKE_AA_FULL)
+                {
+                    if (start < 0) start = x;
+                    continue;
+                }
+
+                /* flush the solid span */
+                if (start >= 0)
+                {
+                    if (a == 255)
+                    {
+                        rtgui_dc_draw_hline(dc, start, x, y);
+                    }
+                    else
+                    {
+                        struct rtgui_rect span;
+
+                        rtgui_rect_init(&span, start, y, x - start, 1);
+                        rtgui_dc_blend_fill_rect(dc, &span, RTGUI_BLENDMODE_BLEND, color);
+                    }
+                    start = -1;
+                }
+
+                if (total > 0)
+                    rtgui_dc_blend_point(dc, x, y, RTGUI_BLENDMODE_BLEND, r, g, b,
+                                         (rt_uint8_t)((total * a) >> (STROKE_FRAC_BITS + STROKE_AA_SHIFT)));
+            }
+        }
+    }
+
+__exit:
+    if (active) rtgui_free(active);
+    if (cross) rtgui_free(cross);
+    if (cover) rtgui_free(cover);
+    if (delta) rtgui_free(delta);
+}
+
+void rtgui_stroke_init(struct rtgui_stroke *stroke, rt_uint8_t width)
+{
+    RT_ASSERT(stroke != RT_NULL);
+
+    rt_memset(stroke, 0, sizeof(struct rtgui_stroke));
+    stroke->width = width;
+    stroke->join = RTGUI_JOIN_MITER;
+    stroke->cap = RTGUI_CAP_BUTT;
+}
+RTM_EXPORT(rtgui_stroke_init);
+
+int rtgui_dc_draw_stroke(struct rtgui_dc *dc, const struct rtgui_point *points, int count,
+                         const struct rtgui_stroke *stroke)
+{
+    int i, n = 0;
+    rt_bool_t aa;
+    struct _stroker s;
+    struct _stroke_point *pts, *piece;
+
+    if (dc == RT_NULL || points == RT_NULL || stroke == RT_NULL) return -1;
+    if (count < 1 || stroke->width < 1) return -1;
+    if (!rtgui_dc_get_visible(dc)) return 0;
+
+    rt_memset(&s, 0, sizeof(s));
+    s.style = stroke;
+    s.hw = stroke->width << (STROKE_FRAC_BITS - 1);
+    s.ymin = 0x7fffffff;
+    s.ymax = -0x7fffffff;
+
+    pts = (struct _stroke_point *) rtgui_malloc(2 * (count + 1) * sizeof(struct _stroke_point));
+    if (pts == RT_NULL) return -1;
+    piece = pts + count + 1;
+
+    /* move to the pixel center and drop the duplicated points */
+    for (i = 0; i < count; i++)
+        _stroke_piece_append(pts, &n, points[i].x * STROKE_ONE + STROKE_HALF,
+                             points[i].y * STROKE_ONE + STROKE_HALF);
+
+    if (stroke->dash != RT_NULL && stroke->dash_count > 0)
+        _stroker_add_dash(&s, pts, n, piece);
+    else
+        _stroker_add_piece(&s, pts, n);
+
+    /* the alpha blending needs the pixel buffer */
+    aa = stroke->aa && (dc->type == RTGUI_DC_BUFFER ||
+                        rtgui_graphic_driver_get_default()->framebuffer != RT_NULL);
+    if (s.failed == RT_FALSE)
+        _stroker_fill(&s, dc, aa);
+
+    rtgui_free(pts);
+    if (s.edges) rtgui_free(s.edges);
+
+    return s.failed == RT_TRUE ? -1 : 0;
+}
+RTM_EXPORT(rtgui_dc_draw_stroke);
+
+/*!
+\brief Draw a thick line.
+
+\param dst The surface to draw on.
+\param x1 X coordinate of the first point of the line.
+\param y1 Y coordinate of the first point of the line.
+\param x2 X coordinate of the second point of the line.
+\param y2 Y coordinate of the second point of the line.
+\param width Width of the line in pixels. Must be >0.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int rtgui_dc_draw_thick_line(struct rtgui_dc * dst, rt_int16_t x1, rt_int16_t y1, rt_int16_t x2, rt_int16_t y2, rt_uint8_t width)
+{
+    struct rtgui_stroke stroke;
+    struct rtgui_point points[2];
+
+    if (dst == RT_NULL) return -1;
+    if (width < 1) return -1;
+
+    /* Special case: thick "point" */
+    if ((x1 == x2) && (y1 == y2))
+    {
+        struct rtgui_rect rect;
+
+        rtgui_rect_init(&rect, x1 - width / 2, y1 - width / 2, width, width);
+        rtgui_dc_fill_rect_forecolor(dst, &rect);
+        return 0;
+    }
+
+    rtgui_stroke_init(&stroke, width);
+    points[0].x = x1; points[0].y = y1;
+    points[1].x = x2; points[1].y = y2;
+
+    return rtgui_dc_draw_stroke(dst, points, 2, &stroke);
+}
+RTM_EXPORT(rtgui_dc_draw_thick_line);
@@ -0,0 +1,416 @@
+/*
+ * File      : frame.c
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+#include <rthw.h>
+#include <rtgui/rtgui.h>
+#include <rtgui/event.h>
+#include <rtgui/frame.h>
+#include <rtgui/driver.h>
+#include <rtgui/rtgui_app.h>
+#include <rtgui/rtgui_system.h>
+#include <rtgui/widgets/widget.h>
+#include <rtgui/widgets/window.h>
+
+/* the clocks waiting for the next vsync, and the ones being sent on this */
+static rtgui_list_t _frame_waiting;
+static rtgui_list_t _frame_sending;
+
+/* the timer stands in for vsync if driver has none */
+static struct rt_timer _frame_timer;
+static rt_bool_t _frame_timer_running = RT_FALSE;
+static rt_bool_t _frame_driver_vsync = RT_FALSE;
+
+static void _rtgui_frame_timeout(void *parameter)
+{
+    rtgui_frame_vsync();
+}
+
+void rtgui_system_frame_init(void)
+{
+    rt_tick_t period;
+
+    period = rt_tick_from_millisecond(GUIENGIN_FRAME_MS);
+    if (period == 0) period = 1;
+
+    rtgui_list_init(&_frame_waiting);
+    rtgui_list_init(&_frame_sending);
+    rt_timer_init(&_frame_timer, "frame", _rtgui_frame_timeout, RT_NULL,
+                  period, RT_TIMER_FLAG_PERIODIC);
+}
+
+void rtgui_frame_clock_init(struct rtgui_frame_clock *clock)
+{
+    rtgui_list_init(&clock->list);
+    rtgui_list_init(&clock->callbacks);
+    clock->requested = RT_FALSE;
+    clock->sending = RT_FALSE;
+    clock->detached = RT_FALSE;
+    clock->cursor = RT_NULL;
+    clock->frame = 0;
+    clock->paint_num = 0;
+}
+
+void rtgui_frame_clock_fini(struct rtgui_frame_clock *clock)
+{
+    rt_base_t level;
+    rtgui_list_t *node;
+    struct rtgui_frame_callback *callback;
+
+    level = rt_hw_interrupt_disable();
+    clock->detached = RT_TRUE;
+    if (clock->requested)
+    {
+        rtgui_list_remove(&_frame_waiting, &clock->list);
+        clock->requested = RT_FALSE;
+    }
+    /* it may be taken by the vsync but not sent yet */
+    rtgui_list_remove(&_frame_sending, &clock->list);
+    /* or being sent right now, wait the vsync to let it go */
+    while (clock->sending)
+    {
+        rt_hw_interrupt_enable(level);
+        rt_thread_delay(1);
+        level = rt_hw_interrupt_disable();
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* the callbacks are owned by user, just detach them */
+    rtgui_list_foreach(node, &clock->callbacks)
+    {
+        callback = rtgui_list_entry(node, struct rtgui_frame_callback, list);
+        callback->running = RT_FALSE;
+    }
+    rtgui_list_init(&clock->callbacks);
+    clock->paint_num = 0;
+}
+
+struct rtgui_frame_callback *rtgui_frame_callback_create(rtgui_frame_func_t func, void *parameter)
+{
+    struct rtgui_frame_callback *callback;
+
+    callback = (struct rtgui_frame_callback *) rtgui_malloc(sizeof(struct rtgui_frame_callback));
+    if (callback == RT_NULL)
+        return RT_NULL;
+
+    rtgui_list_init(&callback->list);
+    callback->app = rtgui_app_self();
+    callback->running = RT_FALSE;
+    callback->func = func;
+    callback->user_data = parameter;
+
+    return callback;
+}
+RTM_EXPORT(rtgui_frame_callback_create);
+
+void rtgui_frame_callback_destroy(struct rtgui_frame_callback *callback)
+{
+    RT_ASSERT(callback != RT_NULL);
+
+    rtgui_frame_callback_stop(callback);
+    rtgui_free(callback);
+}
+RTM_EXPORT(rtgui_frame_callback_destroy);
+
+void rtgui_frame_callback_start(struct rtgui_frame_callback *callback)
+{
+    RT_ASSERT(callback != RT_NULL);
+    RT_ASSERT(callback->app == rtgui_app_self());
+
+    if (callback->running)
+        return;
+
+    rtgui_list_append(&callback->app->frame.callbacks, &callback->list);
+    callback->running = RT_TRUE;
+
+    rtgui_frame_request(callback->app);
+}
+RTM_EXPORT(rtgui_frame_callback_start);
+
+void rtgui_frame_callback_stop(struct rtgui_frame_callback *callback)
+{
+    struct rtgui_frame_clock *clock;
+
+    RT_ASSERT(callback != RT_NULL);
+
+    if (!callback->running)
+        return;
+
+    clock = &callback->app->frame;
+    /* don't break the dispatching */
+    if (clock->cursor == &callback->list)
+        clock->cursor = callback->list.next;
+
+    rtgui_list_remove(&clock->callbacks, &callback->list);
+    callback->running = RT_FALSE;
+}
+RTM_EXPORT(rtgui_frame_callback_stop);
+
+/* put the clock on the waiting list, interrupt must be disabled */
+static void _rtgui_frame_wait(struct rtgui_frame_clock *clock)
+{
+    if (clock->requested || clock->detached)
+        return;
+
+    clock->requested = RT_TRUE;
+    rtgui_list_insert(&_frame_waiting, &clock->list);
+
+    if (!_frame_driver_vsync && !_frame_timer_running)
+    {
+        _frame_timer_running = RT_TRUE;
+        rt_timer_start(&_frame_timer);
+    }
+}
+
+void rtgui_frame_request(struct rtgui_app *app)
+{
+    rt_base_t level;
+    struct rtgui_frame_clock *clock;
+
+    RT_ASSERT(app != RT_NULL);
+
+    clock = &app->frame;
+
+    level = rt_hw_interrupt_disable();
+    _rtgui_frame_wait(clock);
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rtgui_frame_request);
+
+void rtgui_frame_invalidate(struct rtgui_widget *widget)
+{
+    int index;
+    struct rtgui_app *app;
+    struct rtgui_frame_clock *clock;
+
+    RT_ASSERT(widget != RT_NULL);
+
+    app = rtgui_app_self();
+    if (app == RT_NULL)
+        return;
+
+    clock = &app->frame;
+    for (index = 0; index < clock->paint_num; index ++)
+    {
+        if (clock->paint[index] == widget)
+            return;
+    }
+
+    if (clock->paint_num == GUIENGIN_FRAME_PAINT_MAX)
+    {
+        /* too many widgets in this frame, paint it now */
+        rtgui_widget_update(widget);
+        return;
+    }
+
+    clock->paint[clock->paint_num ++] = widget;
+    rtgui_frame_request(app);
+}
+RTM_EXPORT(rtgui_frame_invalidate);
+
+void rtgui_frame_cancel(struct rtgui_widget *widget)
+{
+    int index;
+    struct rtgui_app *app;
+    struct rtgui_frame_clock *clock;
+
+    app = rtgui_app_self();
+    if (app == RT_NULL)
+        return;
+
+    clock = &app->frame;
+    for (index = 0; index < clock->paint_num; index ++)
+    {
+        if (clock->paint[index] == widget)
+        {
+            clock->paint_num --;
+            rt_memmove(&clock->paint[index], &clock->paint[index + 1],
+                       (clock->paint_num - index) * sizeof(clock->paint[0]));
+            return;
+        }
+    }
+}
+RTM_EXPORT(rtgui_frame_cancel);
+
+/* paint the invalidated widgets with one screen update */
+static void _rtgui_frame_paint(struct rtgui_app *app, struct rtgui_frame_clock *clock)
+{
+    int index, num;
+    rtgui_rect_t rect;
+    struct rtgui_widget *widget;
+
+    num = clock->paint_num;
+    if (num == 0)
+        return;
+
+    rt_memset(&rect, 0, sizeof(rect));
+
+    /* hold the screen update of the windows until all widgets are painted */
+    for (index = 0; index < num; index ++)
+    {
+        widget = clock->paint[index];
+        if (widget->toplevel != RT_NULL)
+            widget->toplevel->update ++;
+    }
+
+    for (index = 0; index < num; index ++)
+    {
+        widget = clock->paint[index];
+        if (widget->toplevel == RT_NULL)
+            continue;
+
+        rtgui_widget_update(widget);
+        if (!RTGUI_WIDGET_IS_HIDE(widget))
+            rtgui_rect_union(&widget->extent, &rect);
+    }
+
+    for (index = 0; index < num; index ++)
+    {
+        widget = clock->paint[index];
+        if (widget->toplevel != RT_NULL)
+            widget->toplevel->update --;
+    }
+
+    /* the widgets invalidated in painting are left to next frame */
+    clock->paint_num -= num;
+    if (clock->paint_num)
+    {
+        rt_memmove(&clock->paint[0], &clock->paint[num],
+                   clock->paint_num * sizeof(clock->paint[0]));
+        rtgui_frame_request(app);
+    }
+
+    if (!rtgui_rect_is_empty(&rect) && rtgui_graphic_driver_is_vmode() == RT_FALSE)
+        rtgui_graphic_driver_screen_update(rtgui_graphic_driver_get_default(), &rect);
+}
+
+void rtgui_frame_dispatch(struct rtgui_app *app, struct rtgui_event_frame *event)
+{
+    rtgui_list_t *node;
+    struct rtgui_frame_clock *clock;
+    struct rtgui_frame_callback *callback;
+
+    clock = &app->frame;
+    clock->frame ++;
+
+    /* the callbacks may start or stop the others */
+    clock->cursor = clock->callbacks.next;
+    while (clock->cursor != RT_NULL)
+    {
+        node = clock->cursor;
+        clock->cursor = node->next;
+
+        callback = rtgui_list_entry(node, struct rtgui_frame_callback, list);
+        callback->func(callback, event->tick, callback->user_data);
+    }
+
+    _rtgui_frame_paint(app, clock);
+
+    /* keep ticking while animating */
+    if (clock->callbacks.next != RT_NULL)
+        rtgui_frame_request(app);
+}
+
+void rtgui_frame_set_vsync(rt_bool_t driver)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    _frame_driver_vsync = driver;
+    if (driver && _frame_timer_running)
+    {
+        _frame_timer_running = RT_FALSE;
+        rt_timer_stop(&_frame_timer);
+    }
+    else if (!driver && !_frame_timer_running && _frame_waiting.next != RT_NULL)
+    {
+        _frame_timer_running = RT_TRUE;
+        rt_timer_start(&_frame_timer);
+    }
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rtgui_frame_set_vsync);
+
+void rtgui_frame_vsync(void)
+{
+    rt_err_t result;
+    rt_base_t level;
+    rtgui_list_t *node;
+    struct rtgui_app *app;
+    struct rtgui_frame_clock *clock = RT_NULL;
+    struct rtgui_event_frame event;
+
+    /*
+     * Note: can not use RTGUI_EVENT_FRAME_INIT to init, it may be called in
+     * interrupt
+     */
+    event.parent.type = RTGUI_EVENT_FRAME;
+    event.parent.user = 0;
+    event.parent.sender = RT_NULL;
+    event.parent.ack = RT_NULL;
+    event.tick = rt_tick_get();
+
+    /* take the waiting clocks, the apps may request again from now on */
+    level = rt_hw_interrupt_disable();
+    node = _frame_waiting.next;
+    _frame_waiting.next = RT_NULL;
+    _frame_sending.next = node;
+    for (; node != RT_NULL; node = node->next)
+        rtgui_list_entry(node, struct rtgui_frame_clock, list)->requested = RT_FALSE;
+
+    /* nothing is animating, skip the ticks */
+    if (_frame_sending.next == RT_NULL && _frame_timer_running)
+    {
+        _frame_timer_running = RT_FALSE;
+        rt_timer_stop(&_frame_timer);
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* send with interrupt enabled, one clock is taken off at a time */
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        node = _frame_sending.next;
+        if (node != RT_NULL)
+        {
+            _frame_sending.next = node->next;
+            /* hold off the fini of the clock until it's sent */
+            clock = rtgui_list_entry(node, struct rtgui_frame_clock, list);
+            clock->sending = RT_TRUE;
+        }
+        rt_hw_interrupt_enable(level);
+
+        if (node == RT_NULL)
+            break;
+
+        app = RTGUI_CONTAINER_OF(clock, struct rtgui_app, frame);
+        result = rtgui_send(app, &event.parent, sizeof(event));
+
+        level = rt_hw_interrupt_disable();
+        clock->sending = RT_FALSE;
+        /* the queue is full, try again on next vsync if it's still alive */
+        if (result != RT_EOK)
+            _rtgui_frame_wait(clock);
+        rt_hw_interrupt_enable(level);
+    }
+}
+RTM_EXPORT(rtgui_frame_vsync);
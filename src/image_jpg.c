@@ -449,15 +449,10 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image, struct rtgui_dc *dc
             else dst_y = rect->y1;
 
             /* initialize destination blit information */
-            info.dst = rtgui_dc_buffer_get_pixel(RTGUI_DC(buffer)) + dst_y * buffer->pitch +
-                       dst_x * rtgui_color_get_bpp(buffer->pixel_format);
             info.dst_h = h;
             info.dst_w = w;
-            info.dst_fmt = buffer->pixel_format;
-            info.dst_pitch = buffer->pitch;
-            info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(buffer->pixel_format);
 
-            rtgui_blit(&info);
+            rtgui_dc_buffer_blit_info(RTGUI_DC(buffer), dst_x, dst_y, &info);
         }
         else
         {
@@ -959,17 +954,12 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image,
             info.src_pitch = image->w * jpeg->byte_per_pixel;
             info.src_skip = info.src_pitch - info.src_w * jpeg->byte_per_pixel;
 
-            info.dst = rtgui_dc_buffer_get_pixel(RTGUI_DC(buffer)) + dst_rect->y1 * buffer->pitch +
-                       dst_rect->x1 * rtgui_color_get_bpp(buffer->pixel_format);
             info.dst_h = rtgui_rect_height(*dst_rect);
             info.dst_w = rtgui_rect_width(*dst_rect);
-            info.dst_fmt = buffer->pixel_format;
-            info.dst_pitch = buffer->pitch;
-            info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(buffer->pixel_format);
 
             info.a = 255;
 
-            rtgui_blit(&info);
+            rtgui_dc_buffer_blit_info(RTGUI_DC(buffer), dst_rect->x1, dst_rect->y1, &info);
         }
     }
 }
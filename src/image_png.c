@@ -687,13 +687,8 @@ static void rtgui_image_png_blit(struct rtgui_image *image, struct rtgui_dc *dc,
             if (buffer->pixel_alpha == 0)
                 info.a = 255;
 
-            info.dst = rtgui_dc_buffer_get_pixel(RTGUI_DC(buffer)) + dst_y * buffer->pitch +
-                       dst_x * rtgui_color_get_bpp(buffer->pixel_format);
             info.dst_h = h;
             info.dst_w = w;
-            info.dst_fmt = buffer->pixel_format;
-            info.dst_pitch = buffer->pitch;
-            info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(buffer->pixel_format);
         }
         else if (dc->type == RTGUI_DC_HW)
         {
@@ -713,9 +708,16 @@ static void rtgui_image_png_blit(struct rtgui_image *image, struct rtgui_dc *dc,
             info.dst_w = w;
             info.dst_pitch = hw_driver->pitch;
             info.dst_skip = info.dst_pitch - info.dst_w * rtgui_color_get_bpp(hw_driver->pixel_format);
+            info.dither_x = owner->extent.x1 + dst_x;
+            info.dither_y = owner->extent.y1 + dst_y;
         }
+        info.dither = RTGUI_DC_DITHER(dc);
 
-        rtgui_blit(&info);
+        /* the indexed buffer is drawn through its palette */
+        if (dc->type == RTGUI_DC_BUFFER)
+            rtgui_dc_buffer_blit_info(dc, dst_x, dst_y, &info);
+        else
+            rtgui_blit(&info);
     }
 }
 
@@ -66,8 +66,26 @@ struct rtgui_cursor
 
 struct rtgui_cursor *_rtgui_cursor;
 
-#ifdef RTGUI_USING_MOUSE_CURSOR
+/* the cursor and the window move rect are shared by the server, the input
+ * stage and the clients drawing */
+#if defined(RTGUI_USING_MOUSE_CURSOR) || defined(RTGUI_USING_WINMOVE)
+#define RTGUI_USING_CURSOR_LOCK
 struct rt_mutex cursor_mutex;
+#endif
+
+#ifdef RTGUI_USING_MOUSE_CURSOR
+/* the cursor_mutex is held by a client all along its drawing, the position
+ * and the saved background are guarded by this short one, so the server
+ * hides and shows the cursor without waiting for the client */
+static struct rt_mutex cursor_state_mutex;
+#define _cursor_state_lock()    rt_mutex_take(&cursor_state_mutex, RT_WAITING_FOREVER)
+#define _cursor_state_unlock()  rt_mutex_release(&cursor_state_mutex)
+#else
+#define _cursor_state_lock()
+#define _cursor_state_unlock()
+#endif
+
+#ifdef RTGUI_USING_MOUSE_CURSOR
 static const rt_uint8_t *cursor_xpm[] =
 {
     "16 16 35 1",
@@ -145,9 +163,12 @@ void rtgui_mouse_init(void)
     _rtgui_cursor = (struct rtgui_cursor *) rtgui_malloc(sizeof(struct rtgui_cursor));
     rt_memset(_rtgui_cursor, 0, sizeof(struct rtgui_cursor));
 
-#ifdef RTGUI_USING_MOUSE_CURSOR
+#ifdef RTGUI_USING_CURSOR_LOCK
     rt_mutex_init(&cursor_mutex, "cursor", RT_IPC_FLAG_FIFO);
 #endif
+#ifdef RTGUI_USING_MOUSE_CURSOR
+    rt_mutex_init(&cursor_state_mutex, "cursorst", RT_IPC_FLAG_FIFO);
+#endif
 
     /* init cursor */
     _rtgui_cursor->bpp = _UI_BITBYTES(gd->bits_per_pixel);
@@ -202,8 +223,11 @@ void rtgui_mouse_fini(void)
         rtgui_free(_rtgui_cursor->win_top);
         rtgui_free(_rtgui_cursor->win_bottom);
 #endif
-#ifdef RTGUI_USING_MOUSE_CURSOR
+#ifdef RTGUI_USING_CURSOR_LOCK
         rt_mutex_detach(&cursor_mutex);
+#endif
+#ifdef RTGUI_USING_MOUSE_CURSOR
+        rt_mutex_detach(&cursor_state_mutex);
         rtgui_image_destroy(_rtgui_cursor->cursor_image);
         rtgui_free(_rtgui_cursor->cursor_saved);
 #endif
@@ -213,12 +237,10 @@ void rtgui_mouse_fini(void)
     }
 }
 
-void rtgui_mouse_moveto(int x, int y)
+/* the cursor_mutex is taken by caller */
+static void _rtgui_mouse_moveto(int x, int y)
 {
-#ifdef RTGUI_USING_MOUSE_CURSOR
-    rt_mutex_take(&cursor_mutex, RT_WAITING_FOREVER);
-#endif
-
+    _cursor_state_lock();
     if (x != _rtgui_cursor->cx ||
             y != _rtgui_cursor->cy)
     {
@@ -270,14 +292,62 @@ void rtgui_mouse_moveto(int x, int y)
         rtgui_cursor_set_position(_rtgui_cursor->cx, _rtgui_cursor->cy);
 #endif
     }
+    _cursor_state_unlock();
+}
 
-#ifdef RTGUI_USING_MOUSE_CURSOR
+void rtgui_mouse_moveto(int x, int y)
+{
+    rtgui_mouse_lock();
+    _rtgui_mouse_moveto(x, y);
+    rtgui_mouse_unlock();
+}
+
+/*
+ * The cursor is hidden while a client is drawing with the cursor_mutex taken.
+ * Don't wait for it, just move the position and the client shows the cursor
+ * there when it's done.
+ */
+void rtgui_mouse_moveto_nowait(int x, int y)
+{
+#ifdef RTGUI_USING_CURSOR_LOCK
+    if (rt_mutex_take(&cursor_mutex, 0) != RT_EOK)
+    {
+#ifdef RTGUI_USING_WINMOVE
+        /* the window rect is moved with the cursor */
+        if (_rtgui_cursor->win_rect_show)
+        {
+            rtgui_mouse_moveto(x, y);
+            return;
+        }
+#endif
+        rtgui_mouse_set_position(x, y);
+        return;
+    }
+
+    _rtgui_mouse_moveto(x, y);
+    rt_mutex_release(&cursor_mutex);
+#else
+    _rtgui_mouse_moveto(x, y);
+#endif
+}
+
+void rtgui_mouse_lock(void)
+{
+#ifdef RTGUI_USING_CURSOR_LOCK
+    rt_mutex_take(&cursor_mutex, RT_WAITING_FOREVER);
+#endif
+}
+
+void rtgui_mouse_unlock(void)
+{
+#ifdef RTGUI_USING_CURSOR_LOCK
     rt_mutex_release(&cursor_mutex);
 #endif
 }
 
 void rtgui_mouse_set_position(int x, int y)
 {
+    _cursor_state_lock();
     /* move current cursor */
     _rtgui_cursor->cx = x;
     _rtgui_cursor->cy = y;
@@ -285,6 +355,7 @@ void rtgui_mouse_set_position(int x, int y)
 #ifdef RTGUI_USING_HW_CURSOR
     rtgui_cursor_set_position(_rtgui_cursor->cx, _rtgui_cursor->cy);
 #endif
+    _cursor_state_unlock();
 }
 
 #ifdef RTGUI_USING_MOUSE_CURSOR
@@ -311,6 +382,7 @@ void rtgui_mouse_show_cursor()
     if (_rtgui_cursor->show_cursor == RT_FALSE)
         return;
 
+    _cursor_state_lock();
     _rtgui_cursor->show_cursor_count ++;
     if (_rtgui_cursor->show_cursor_count == 1)
     {
@@ -320,6 +392,7 @@ void rtgui_mouse_show_cursor()
         /* show mouse cursor */
         rtgui_cursor_show();
     }
+    _cursor_state_unlock();
 }
 
 void rtgui_mouse_hide_cursor()
@@ -327,12 +400,14 @@ void rtgui_mouse_hide_cursor()
     if (_rtgui_cursor->show_cursor == RT_FALSE)
         return;
 
+    _cursor_state_lock();
     if (_rtgui_cursor->show_cursor_count == 1)
     {
         /* display the cursor coverage area */
         rtgui_cursor_restore();
     }
     _rtgui_cursor->show_cursor_count --;
+    _cursor_state_unlock();
 }
 
 rt_bool_t rtgui_mouse_is_intersect(rtgui_rect_t *r)
@@ -433,6 +508,9 @@ static void rtgui_cursor_show()
 #ifdef RTGUI_USING_WINMOVE
 void rtgui_winrect_set(struct rtgui_win *win)
 {
+    /* called by the client, the input stage may be moving the rect */
+    rtgui_mouse_lock();
+
     /* set win rect show */
     _rtgui_cursor->win_rect_show = RT_TRUE;
 
@@ -443,6 +521,8 @@ void rtgui_winrect_set(struct rtgui_win *win)
         RTGUI_WIDGET(win->_title_wgt)->extent;
 
     _rtgui_cursor->win = win;
+
+    rtgui_mouse_unlock();
 }
 
 rt_bool_t rtgui_winrect_moved_done(rtgui_rect_t *winrect, struct rtgui_win **win)
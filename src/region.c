@@ -21,8 +21,10 @@
  * Date           Author       Notes
  * 2009-10-16     Bernard      first version
  */
+#include <rthw.h>
 #include <rtgui/region.h>
 #include <rtgui/rtgui_system.h>
+#include <rtgui/rtgui_app.h>
 
 /* #define good(reg) RT_ASSERT(rtgui_region16_valid(reg)) */
 #define good(reg)
@@ -46,12 +48,14 @@
 #define PIXREGION_TOP(reg) PIXREGION_BOX(reg, (reg)->data->numRects)
 #define PIXREGION_END(reg) PIXREGION_BOX(reg, (reg)->data->numRects - 1)
 #define PIXREGION_SZOF(n) (sizeof(rtgui_region_data_t) + ((n) * sizeof(rtgui_rect_t)))
+/* the rects are in the storage of region itself */
+#define PIXREGION_INLINE(reg) ((reg)->data == &(reg)->inline_data.head)
 
 rtgui_rect_t rtgui_empty_rect = {0, 0, 0, 0};
 rtgui_point_t rtgui_empty_point = {0, 0};
 
-static rtgui_region_data_t rtgui_region_emptydata = {0, 0};
-static rtgui_region_data_t  rtgui_brokendata = {0, 0};
+static rtgui_region_data_t rtgui_region_emptydata = {0, 0, 0};
+static rtgui_region_data_t  rtgui_brokendata = {0, 0, 0};
 
 static rtgui_region_status_t rtgui_break(rtgui_region_t *pReg);
 
@@ -131,7 +135,7 @@ static rtgui_region_status_t rtgui_break(rtgui_region_t *pReg);
         ((r1)->y2 <= (r2)->y2) )
 
 #define allocData(n) rtgui_malloc(PIXREGION_SZOF(n))
-#define freeData(reg) if ((reg)->data && (reg)->data->size) rtgui_free((reg)->data)
+#define freeData(reg) if ((reg)->data && (reg)->data->size && !PIXREGION_INLINE(reg)) rtgui_free((reg)->data)
 
 #define RECTALLOC_BAIL(pReg,n,bail) \
 if (!(pReg)->data || (((pReg)->data->numRects + (n)) > (pReg)->data->size)) \
@@ -230,15 +234,31 @@ static rtgui_region_status_t rtgui_rect_alloc(rtgui_region_t *region, int n)
     if (!region->data)
     {
         n++;
-        region->data = allocData(n);
-        if (!region->data) return rtgui_break(region);
+        if (n <= GUIENGIN_REGION_INLINE_RECTS)
+        {
+            n = GUIENGIN_REGION_INLINE_RECTS;
+            region->data = &region->inline_data.head;
+        }
+        else
+        {
+            region->data = allocData(n);
+            if (!region->data) return rtgui_break(region);
+        }
         region->data->numRects = 1;
         *PIXREGION_BOXPTR(region) = region->extents;
     }
     else if (!region->data->size)
     {
-        region->data = allocData(n);
-        if (!region->data) return rtgui_break(region);
+        if (n <= GUIENGIN_REGION_INLINE_RECTS)
+        {
+            n = GUIENGIN_REGION_INLINE_RECTS;
+            region->data = &region->inline_data.head;
+        }
+        else
+        {
+            region->data = allocData(n);
+            if (!region->data) return rtgui_break(region);
+        }
         region->data->numRects = 0;
     }
     else
@@ -250,14 +270,148 @@ static rtgui_region_status_t rtgui_rect_alloc(rtgui_region_t *region, int n)
                 n = 250;
         }
         n += region->data->numRects;
-        data = (rtgui_region_data_t *)rt_realloc(region->data, PIXREGION_SZOF(n));
-        if (!data) return rtgui_break(region);
+        if (PIXREGION_INLINE(region))
+        {
+            /* move out of the inline storage */
+            data = allocData(n);
+            if (!data) return rtgui_break(region);
+            rt_memcpy(data, region->data, PIXREGION_SZOF(region->data->numRects));
+        }
+        else
+        {
+            data = (rtgui_region_data_t *)rt_realloc(region->data, PIXREGION_SZOF(n));
+            if (!data) return rtgui_break(region);
+        }
         region->data = data;
     }
     region->data->size = n;
+    region->data->hint = 0;
+    return RTGUI_REGION_STATUS_SUCCESS;
+}
+
+/*
+ * Set the rects of @dst to the @numRects rects in @rects. The inline storage
+ * is used if they fit, otherwise a heap block of exact size.
+ */
+static rtgui_region_status_t rtgui_set_rects(rtgui_region_t *dst, rtgui_rect_t *rects, int numRects)
+{
+    if (numRects <= GUIENGIN_REGION_INLINE_RECTS)
+    {
+        if (!PIXREGION_INLINE(dst))
+        {
+            freeData(dst);
+            dst->data = &dst->inline_data.head;
+            dst->data->size = GUIENGIN_REGION_INLINE_RECTS;
+        }
+    }
+    else if (!dst->data || PIXREGION_INLINE(dst) ||
+             (dst->data->size < numRects) || (dst->data->size > 2 * numRects))
+    {
+        freeData(dst);
+        dst->data = allocData(numRects);
+        if (!dst->data) return rtgui_break(dst);
+        dst->data->size = numRects;
+    }
+    dst->data->numRects = numRects;
+    dst->data->hint = 0;
+    rt_memmove((char *)PIXREGION_BOXPTR(dst), (char *)rects,
+               numRects * sizeof(rtgui_rect_t));
     return RTGUI_REGION_STATUS_SUCCESS;
 }
 
+/* move @src to @dst, the region can't be moved by assignment */
+static void rtgui_region_move(rtgui_region_t *dst, rtgui_region_t *src)
+{
+    dst->extents = src->extents;
+    if (PIXREGION_INLINE(src))
+    {
+        dst->inline_data = src->inline_data;
+        dst->data = &dst->inline_data.head;
+    }
+    else
+    {
+        dst->data = src->data;
+    }
+}
+
+/* take the scratch storage of current thread for at least @n rects */
+static rtgui_region_data_t *rtgui_arena_take(int n)
+{
+    struct rtgui_app *app = rtgui_app_self();
+    rtgui_region_data_t *data = RT_NULL;
+
+    if (app != RT_NULL && app->region_arena.data != RT_NULL)
+    {
+        data = app->region_arena.data;
+        app->region_arena.data = RT_NULL;
+
+        if (data->size < n)
+        {
+            rtgui_region_data_t *new_data;
+
+            new_data = (rtgui_region_data_t *)rt_realloc(data, PIXREGION_SZOF(n));
+            if (!new_data)
+            {
+                rtgui_free(data);
+                return RT_NULL;
+            }
+            data = new_data;
+            data->size = n;
+        }
+    }
+    else
+    {
+        data = allocData(n);
+        if (!data) return RT_NULL;
+        data->size = n;
+    }
+    data->numRects = 0;
+    data->hint = 0;
+
+    return data;
+}
+
+/* give back the scratch storage, it may be grown during the operation */
+static void rtgui_arena_give(rtgui_region_data_t *data)
+{
+    struct rtgui_app *app = rtgui_app_self();
+
+    if (app != RT_NULL && app->region_arena.data == RT_NULL)
+        app->region_arena.data = data;
+    else
+        rtgui_free(data);
+}
+
+void rtgui_region_arena_reset(void)
+{
+    struct rtgui_app *app = rtgui_app_self();
+    rtgui_region_data_t *data;
+
+    if (app == RT_NULL || app->region_arena.data == RT_NULL)
+        return;
+
+    /* don't keep the memory of a big operation for ever */
+    data = app->region_arena.data;
+    if (data->size > GUIENGIN_REGION_ARENA_RECTS)
+    {
+        app->region_arena.data = RT_NULL;
+        rtgui_free(data);
+    }
+}
+RTM_EXPORT(rtgui_region_arena_reset);
+
+void rtgui_region_arena_fini(struct rtgui_region_arena *arena)
+{
+    RT_ASSERT(arena != RT_NULL);
+
+    if (arena->data != RT_NULL)
+    {
+        rtgui_free(arena->data);
+        arena->data = RT_NULL;
+    }
+}
+RTM_EXPORT(rtgui_region_arena_fini);
+
 rtgui_region_status_t rtgui_region_copy(rtgui_region_t *dst, rtgui_region_t *src)
 {
     good(dst);
@@ -271,19 +425,124 @@ rtgui_region_status_t rtgui_region_copy(rtgui_region_t *dst, rtgui_region_t *src
         dst->data = src->data;
         return RTGUI_REGION_STATUS_SUCCESS;
     }
-    if (!dst->data || (dst->data->size < src->data->numRects))
+    return rtgui_set_rects(dst, PIXREGION_BOXPTR(src), src->data->numRects);
+}
+RTM_EXPORT(rtgui_region_copy);
+
+struct rtgui_region_snapshot *rtgui_region_snapshot_create(rtgui_region_t *region, rt_uint32_t version)
+{
+    struct rtgui_region_snapshot *snapshot;
+
+    RT_ASSERT(region != RT_NULL);
+
+    snapshot = (struct rtgui_region_snapshot *) rtgui_malloc(sizeof(struct rtgui_region_snapshot));
+    if (snapshot == RT_NULL)
+        return RT_NULL;
+
+    snapshot->refcount = 1;
+    snapshot->version = version;
+    rtgui_region_init(&snapshot->region);
+    if (rtgui_region_copy(&snapshot->region, region) != RTGUI_REGION_STATUS_SUCCESS)
     {
-        freeData(dst);
-        dst->data = allocData(src->data->numRects);
-        if (!dst->data) return rtgui_break(dst);
-        dst->data->size = src->data->numRects;
+        rtgui_region_fini(&snapshot->region);
+        rtgui_free(snapshot);
+        return RT_NULL;
     }
-    dst->data->numRects = src->data->numRects;
-    rt_memmove((char *)PIXREGION_BOXPTR(dst), (char *)PIXREGION_BOXPTR(src),
-               dst->data->numRects * sizeof(rtgui_rect_t));
-    return RTGUI_REGION_STATUS_SUCCESS;
+
+    return snapshot;
 }
-RTM_EXPORT(rtgui_region_copy);
+RTM_EXPORT(rtgui_region_snapshot_create);
+
+struct rtgui_region_snapshot *rtgui_region_snapshot_ref(struct rtgui_region_snapshot *snapshot)
+{
+    rt_base_t level;
+
+    RT_ASSERT(snapshot != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    RT_ASSERT(snapshot->refcount > 0);
+    snapshot->refcount ++;
+    rt_hw_interrupt_enable(level);
+
+    return snapshot;
+}
+RTM_EXPORT(rtgui_region_snapshot_ref);
+
+void rtgui_region_snapshot_unref(struct rtgui_region_snapshot *snapshot)
+{
+    rt_base_t level;
+    rt_uint32_t refcount;
+
+    if (snapshot == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    RT_ASSERT(snapshot->refcount > 0);
+    refcount = --snapshot->refcount;
+    rt_hw_interrupt_enable(level);
+
+    /* the last holder releases it, nobody else can see it now */
+    if (refcount == 0)
+    {
+        rtgui_region_fini(&snapshot->region);
+        rtgui_free(snapshot);
+    }
+}
+RTM_EXPORT(rtgui_region_snapshot_unref);
+
+struct rtgui_region_snapshot *rtgui_region_snapshot_exchange(struct rtgui_region_snapshot **slot,
+        struct rtgui_region_snapshot *snapshot)
+{
+    rt_base_t level;
+    struct rtgui_region_snapshot *old;
+
+    RT_ASSERT(slot != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    old = *slot;
+    *slot = snapshot;
+    rt_hw_interrupt_enable(level);
+
+    return old;
+}
+RTM_EXPORT(rtgui_region_snapshot_exchange);
+
+struct rtgui_region_snapshot *rtgui_region_snapshot_peek(struct rtgui_region_snapshot **slot)
+{
+    rt_base_t level;
+    struct rtgui_region_snapshot *snapshot;
+
+    RT_ASSERT(slot != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    snapshot = *slot;
+    if (snapshot != RT_NULL)
+        snapshot->refcount ++;
+    rt_hw_interrupt_enable(level);
+
+    return snapshot;
+}
+RTM_EXPORT(rtgui_region_snapshot_peek);
+
+rt_bool_t rtgui_region_snapshot_compare_exchange(struct rtgui_region_snapshot **slot,
+        struct rtgui_region_snapshot *expected, struct rtgui_region_snapshot *snapshot)
+{
+    rt_base_t level;
+    rt_bool_t result = RT_FALSE;
+
+    RT_ASSERT(slot != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (*slot == expected)
+    {
+        *slot = snapshot;
+        result = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+RTM_EXPORT(rtgui_region_snapshot_compare_exchange);
 
 /*======================================================================
  *      Generic Region Operator
@@ -475,6 +734,37 @@ rtgui_region_appendNonO(
  *-----------------------------------------------------------------------
  */
 
+/* copy the result built in @newReg to @dstReg and give back the scratch */
+static rtgui_region_status_t
+rtgui_op_commit(rtgui_region_t *dstReg, rtgui_region_t *newReg)
+{
+    int numRects;
+
+    if (PIXREGION_NAR(newReg))
+        return rtgui_break(dstReg);
+
+    numRects = newReg->data->numRects;
+    if (!numRects)
+    {
+        freeData(dstReg);
+        dstReg->data = &rtgui_region_emptydata;
+    }
+    else if (numRects == 1)
+    {
+        dstReg->extents = *PIXREGION_BOXPTR(newReg);
+        freeData(dstReg);
+        dstReg->data = (rtgui_region_data_t *)RT_NULL;
+    }
+    else if (!rtgui_set_rects(dstReg, PIXREGION_BOXPTR(newReg), numRects))
+    {
+        rtgui_arena_give(newReg->data);
+        return RTGUI_REGION_STATUS_FAILURE;
+    }
+
+    rtgui_arena_give(newReg->data);
+    return RTGUI_REGION_STATUS_SUCCESS;
+}
+
 typedef rtgui_region_status_t (*OverlapProcPtr)(
     rtgui_region_t   *region,
     rtgui_rect_t *r1,
@@ -487,7 +777,7 @@ typedef rtgui_region_status_t (*OverlapProcPtr)(
 
 static rtgui_region_status_t
 rtgui_op(
-    rtgui_region_t *newReg,         /* Place to store result         */
+    rtgui_region_t *dstReg,         /* Place to store result         */
     rtgui_region_t *reg1,           /* First region in operation     */
     rtgui_region_t *reg2,           /* 2d region in operation        */
     OverlapProcPtr  overlapFunc,    /* Function to call for over-
@@ -504,7 +794,8 @@ rtgui_op(
     rtgui_rect_t       *r2End;          /* End of 2d region          */
     short       ybot;           /* Bottom of intersection        */
     short       ytop;           /* Top of intersection       */
-    rtgui_region_data_t        *oldData;            /* Old data for newReg       */
+    rtgui_region_t  scratch;        /* The result is built here      */
+    rtgui_region_t  *newReg = &scratch;
     int         prevBand;           /* Index of start of
                              * previous band in newReg       */
     int         curBand;            /* Index of start of current
@@ -522,14 +813,14 @@ rtgui_op(
      * Break any region computed from a broken region
      */
     if (PIXREGION_NAR(reg1) || PIXREGION_NAR(reg2))
-        return rtgui_break(newReg);
+        return rtgui_break(dstReg);
 
     /*
      * Initialization:
-     *  set r1, r2, r1End and r2End appropriately, save the rectangles
-     * of the destination region until the end in case it's one of
-     * the two source regions, then mark the "new" region empty, allocating
-     * another array of rectangles for it to use.
+     *  set r1, r2, r1End and r2End appropriately. The result is built in
+     * the scratch storage of the thread and copied to the destination region
+     * at the end, so the source regions are kept in case the destination is
+     * one of them.
      */
 
     r1 = PIXREGION_RECTS(reg1);
@@ -541,24 +832,14 @@ rtgui_op(
     RT_ASSERT(r1 != r1End);
     RT_ASSERT(r2 != r2End);
 
-    oldData = (rtgui_region_data_t *)RT_NULL;
-    if (((newReg == reg1) && (newSize > 1)) ||
-            ((newReg == reg2) && (numRects > 1)))
-    {
-        oldData = newReg->data;
-        newReg->data = &rtgui_region_emptydata;
-    }
     /* guess at new size */
     if (numRects > newSize)
         newSize = numRects;
     newSize <<= 1;
-    if (!newReg->data)
-        newReg->data = &rtgui_region_emptydata;
-    else if (newReg->data->size)
-        newReg->data->numRects = 0;
-    if (newSize > newReg->data->size)
-        if (!rtgui_rect_alloc(newReg, newSize))
-            return RTGUI_REGION_STATUS_FAILURE;
+    scratch.extents = rtgui_empty_rect;
+    scratch.data = rtgui_arena_take(newSize);
+    if (!scratch.data)
+        return rtgui_break(dstReg);
 
     /*
      * Initialize ybot.
@@ -655,7 +936,7 @@ rtgui_op(
             curBand = newReg->data->numRects;
             if ((* overlapFunc)(newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot,
                                 pOverlap) == RTGUI_REGION_STATUS_FAILURE)
-                return RTGUI_REGION_STATUS_FAILURE;
+                goto __failed;
             Coalesce(newReg, prevBand, curBand);
         }
 
@@ -706,27 +987,13 @@ rtgui_op(
         }
     }
 
-    if (oldData)
-        rtgui_free(oldData);
+    return rtgui_op_commit(dstReg, newReg);
 
-    numRects = newReg->data->numRects;
-    if (!numRects)
-    {
-        freeData(newReg);
-        newReg->data = &rtgui_region_emptydata;
-    }
-    else if (numRects == 1)
-    {
-        newReg->extents = *PIXREGION_BOXPTR(newReg);
-        freeData(newReg);
-        newReg->data = (rtgui_region_data_t *)RT_NULL;
-    }
-    else
-    {
-        DOWNSIZE(newReg, numRects);
-    }
-
-    return RTGUI_REGION_STATUS_SUCCESS;
+__failed:
+    /* the scratch is broken if it failed to grow */
+    if (!PIXREGION_NAR(newReg))
+        rtgui_arena_give(newReg->data);
+    return rtgui_break(dstReg);
 }
 
 /*-
@@ -854,6 +1121,223 @@ rtgui_region_intersectO(
     return RTGUI_REGION_STATUS_SUCCESS;
 }
 
+/*
+ * The rects of region are sorted in y-x bands, and the rects in a band have
+ * the same y1 and y2. So the first rect which is below (x, y) or at its right
+ * in the same band can be found by binary search.
+ */
+static int rtgui_region_search(rtgui_rect_t *rects, int numRects, int x, int y)
+{
+    int low, high, mid;
+
+    low = 0;
+    high = numRects;
+    while (low < high)
+    {
+        mid = (low + high) >> 1;
+        if (rects[mid].y2 <= y || (rects[mid].y1 <= y && rects[mid].x2 <= x))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/*
+ * The operations between a region and a single rectangle are the most common
+ * ones in clip updating. They are done in one pass over the bands of region
+ * instead of rtgui_op, and the size of result is predicted, so the scratch
+ * storage is never grown during the operation.
+ */
+static rtgui_region_status_t
+rtgui_region_intersect_box(rtgui_region_t *newReg, rtgui_region_t *reg1, rtgui_rect_t *prect)
+{
+    rtgui_region_t scratch;
+    rtgui_rect_t rect = *prect;
+    rtgui_rect_t *r, *rEnd, *pNextRect;
+    int numRects, prevBand, curBand;
+    int x1, x2, y1, y2, bandY1;
+
+    numRects = PIXREGION_NUM_RECTS(reg1);
+    r = PIXREGION_RECTS(reg1);
+    rEnd = r + numRects;
+
+    /* each rect is clipped to one rect at most */
+    scratch.extents = rtgui_empty_rect;
+    scratch.data = rtgui_arena_take(numRects);
+    if (!scratch.data)
+        return rtgui_break(newReg);
+
+    /* skip the rects above or at left of rect */
+    r += rtgui_region_search(r, numRects, rect.x1, rect.y1);
+
+    prevBand = 0;
+    while (r != rEnd && r->y1 < rect.y2)
+    {
+        bandY1 = r->y1;
+        y1 = RTGUI_MAX(r->y1, rect.y1);
+        y2 = RTGUI_MIN(r->y2, rect.y2);
+
+        curBand = scratch.data->numRects;
+        pNextRect = PIXREGION_TOP(&scratch);
+        do
+        {
+            x1 = RTGUI_MAX(r->x1, rect.x1);
+            x2 = RTGUI_MIN(r->x2, rect.x2);
+            if (x1 < x2)
+            {
+                ADDRECT(pNextRect, x1, y1, x2, y2);
+                scratch.data->numRects++;
+            }
+            r++;
+        }
+        while (r != rEnd && r->y1 == bandY1);
+        Coalesce((&scratch), prevBand, curBand);
+    }
+    RT_ASSERT(scratch.data->numRects <= scratch.data->size);
+
+    if (!rtgui_op_commit(newReg, &scratch))
+        return RTGUI_REGION_STATUS_FAILURE;
+    rtgui_set_extents(newReg);
+
+    return RTGUI_REGION_STATUS_SUCCESS;
+}
+
+/* append the rects of a band with new top and bottom */
+rt_inline void
+rtgui_region_copy_band(rtgui_region_t *region, rtgui_rect_t *r, rtgui_rect_t *rEnd,
+                       int y1, int y2)
+{
+    rtgui_rect_t *pNextRect = PIXREGION_TOP(region);
+
+    region->data->numRects += rEnd - r;
+    for (; r != rEnd; r++)
+        ADDRECT(pNextRect, r->x1, y1, r->x2, y2);
+}
+
+static rtgui_region_status_t
+rtgui_region_subtract_box(rtgui_region_t *regD, rtgui_region_t *regM, rtgui_rect_t *prect)
+{
+    rtgui_region_t scratch;
+    rtgui_rect_t rect = *prect;
+    rtgui_rect_t *r, *rEnd, *p, *bandEnd, *pNextRect;
+    int numRects, prevBand, curBand;
+    int y1, y2, bandY1, bandY2;
+
+    numRects = PIXREGION_NUM_RECTS(regM);
+    r = PIXREGION_RECTS(regM);
+    rEnd = r + numRects;
+
+    /*
+     * rect splits the bands it overlaps into three at most: the first and
+     * the last ones get a copy of their rects, and the middle part of each
+     * gets one more rect.
+     */
+    scratch.extents = rtgui_empty_rect;
+    scratch.data = rtgui_arena_take(3 * numRects + 1);
+    if (!scratch.data)
+        return rtgui_break(regD);
+
+    prevBand = 0;
+    while (r != rEnd)
+    {
+        bandY1 = r->y1;
+        bandY2 = r->y2;
+        for (bandEnd = r + 1; bandEnd != rEnd && bandEnd->y1 == bandY1; bandEnd++);
+
+        if (bandY2 <= rect.y1 || bandY1 >= rect.y2)
+        {
+            curBand = scratch.data->numRects;
+            rtgui_region_copy_band(&scratch, r, bandEnd, bandY1, bandY2);
+            Coalesce((&scratch), prevBand, curBand);
+        }
+        else
+        {
+            if (bandY1 < rect.y1)
+            {
+                curBand = scratch.data->numRects;
+                rtgui_region_copy_band(&scratch, r, bandEnd, bandY1, rect.y1);
+                Coalesce((&scratch), prevBand, curBand);
+            }
+
+            y1 = RTGUI_MAX(bandY1, rect.y1);
+            y2 = RTGUI_MIN(bandY2, rect.y2);
+            curBand = scratch.data->numRects;
+            pNextRect = PIXREGION_TOP(&scratch);
+            for (p = r; p != bandEnd; p++)
+            {
+                if (p->x2 <= rect.x1 || p->x1 >= rect.x2)
+                {
+                    ADDRECT(pNextRect, p->x1, y1, p->x2, y2);
+                }
+                else
+                {
+                    if (p->x1 < rect.x1)
+                        ADDRECT(pNextRect, p->x1, y1, rect.x1, y2);
+                    if (p->x2 > rect.x2)
+                        ADDRECT(pNextRect, rect.x2, y1, p->x2, y2);
+                }
+            }
+            scratch.data->numRects = pNextRect - PIXREGION_BOXPTR(&scratch);
+            Coalesce((&scratch), prevBand, curBand);
+
+            if (bandY2 > rect.y2)
+            {
+                curBand = scratch.data->numRects;
+                rtgui_region_copy_band(&scratch, r, bandEnd, rect.y2, bandY2);
+                Coalesce((&scratch), prevBand, curBand);
+            }
+        }
+        r = bandEnd;
+    }
+    RT_ASSERT(scratch.data->numRects <= scratch.data->size);
+
+    if (!rtgui_op_commit(regD, &scratch))
+        return RTGUI_REGION_STATUS_FAILURE;
+    rtgui_set_extents(regD);
+
+    return RTGUI_REGION_STATUS_SUCCESS;
+}
+
+/* union of two regions whose extents don't overlap vertically */
+static rtgui_region_status_t
+rtgui_region_union_disjoint(rtgui_region_t *newReg, rtgui_region_t *upper, rtgui_region_t *lower)
+{
+    rtgui_region_t scratch;
+    rtgui_rect_t *r, *rEnd, *bandEnd;
+    int numUpper, numLower, prevBand, curBand;
+
+    numUpper = PIXREGION_NUM_RECTS(upper);
+    numLower = PIXREGION_NUM_RECTS(lower);
+
+    scratch.extents = rtgui_empty_rect;
+    scratch.data = rtgui_arena_take(numUpper + numLower);
+    if (!scratch.data)
+        return rtgui_break(newReg);
+
+    rt_memcpy(PIXREGION_BOXPTR(&scratch), PIXREGION_RECTS(upper),
+              numUpper * sizeof(rtgui_rect_t));
+    scratch.data->numRects = numUpper;
+
+    /* the last band of upper may be coalesced with the first one of lower */
+    r = PIXREGION_BOXPTR(&scratch);
+    for (prevBand = numUpper - 1; prevBand > 0 && r[prevBand - 1].y1 == r[numUpper - 1].y1; prevBand--);
+
+    r = PIXREGION_RECTS(lower);
+    rEnd = r + numLower;
+    for (bandEnd = r + 1; bandEnd != rEnd && bandEnd->y1 == r->y1; bandEnd++);
+
+    curBand = scratch.data->numRects;
+    rtgui_region_copy_band(&scratch, r, bandEnd, r->y1, r->y2);
+    Coalesce((&scratch), prevBand, curBand);
+
+    rt_memcpy(PIXREGION_TOP(&scratch), bandEnd, (rEnd - bandEnd) * sizeof(rtgui_rect_t));
+    scratch.data->numRects += rEnd - bandEnd;
+
+    return rtgui_op_commit(newReg, &scratch);
+}
+
 rtgui_region_status_t
 rtgui_region_intersect(rtgui_region_t *newReg,
                        rtgui_region_t *reg1,
@@ -900,6 +1384,14 @@ rtgui_region_intersect(rtgui_region_t *newReg,
     {
         return rtgui_region_copy(newReg, reg1);
     }
+    else if (!reg2->data)
+    {
+        return rtgui_region_intersect_box(newReg, reg1, &reg2->extents);
+    }
+    else if (!reg1->data)
+    {
+        return rtgui_region_intersect_box(newReg, reg2, &reg1->extents);
+    }
     else
     {
         /* General purpose intersection */
@@ -1105,7 +1597,27 @@ rtgui_region_union(rtgui_region_t *newReg, rtgui_region_t *reg1, rtgui_region_t
         return RTGUI_REGION_STATUS_SUCCESS;
     }
 
-    if (!rtgui_op(newReg, reg1, reg2, rtgui_region_unionO, RTGUI_REGION_STATUS_SUCCESS, RTGUI_REGION_STATUS_SUCCESS, &overlap))
+    if (!reg1->data && !reg2->data &&
+        ((reg1->extents.x1 == reg2->extents.x1 && reg1->extents.x2 == reg2->extents.x2 &&
+          reg1->extents.y1 <= reg2->extents.y2 && reg2->extents.y1 <= reg1->extents.y2) ||
+         (reg1->extents.y1 == reg2->extents.y1 && reg1->extents.y2 == reg2->extents.y2 &&
+          reg1->extents.x1 <= reg2->extents.x2 && reg2->extents.x1 <= reg1->extents.x2)))
+    {
+        /* two rectangles make up a rectangle, the extents is set below */
+        freeData(newReg);
+        newReg->data = (rtgui_region_data_t *)RT_NULL;
+    }
+    else if (reg1->extents.y2 <= reg2->extents.y1)
+    {
+        if (!rtgui_region_union_disjoint(newReg, reg1, reg2))
+            return RTGUI_REGION_STATUS_FAILURE;
+    }
+    else if (reg2->extents.y2 <= reg1->extents.y1)
+    {
+        if (!rtgui_region_union_disjoint(newReg, reg2, reg1))
+            return RTGUI_REGION_STATUS_FAILURE;
+    }
+    else if (!rtgui_op(newReg, reg1, reg2, rtgui_region_unionO, RTGUI_REGION_STATUS_SUCCESS, RTGUI_REGION_STATUS_SUCCESS, &overlap))
         return RTGUI_REGION_STATUS_FAILURE;
 
     newReg->extents.x1 = RTGUI_MIN(reg1->extents.x1, reg2->extents.x1);
@@ -1387,7 +1899,7 @@ rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg,
     numRI = 1;
     ri[0].prevBand = 0;
     ri[0].curBand = 0;
-    ri[0].reg = *badreg;
+    rtgui_region_move(&ri[0].reg, badreg);
     box = PIXREGION_BOXPTR(&ri[0].reg);
     ri[0].reg.extents = *box;
     ri[0].reg.data->numRects = 1;
@@ -1444,9 +1956,16 @@ rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg,
         {
             /* Oops, allocate space for new region information */
             sizeRI <<= 1;
-            rit = (RegionInfo *) rt_realloc(ri, sizeRI * sizeof(RegionInfo));
+            rit = (RegionInfo *) rtgui_malloc(sizeRI * sizeof(RegionInfo));
             if (!rit)
                 goto bail;
+            for (j = 0; j < numRI; j++)
+            {
+                rit[j].prevBand = ri[j].prevBand;
+                rit[j].curBand = ri[j].curBand;
+                rtgui_region_move(&rit[j].reg, &ri[j].reg);
+            }
+            rtgui_free(ri);
             ri = rit;
             rit = &ri[numRI];
         }
@@ -1500,7 +2019,7 @@ NextRect:
         }
         numRI -= half;
     }
-    *badreg = ri[0].reg;
+    rtgui_region_move(badreg, &ri[0].reg);
     rtgui_free(ri);
     good(badreg);
     return ret;
@@ -1683,6 +2202,11 @@ rtgui_region_subtract(rtgui_region_t *regD,
         return RTGUI_REGION_STATUS_SUCCESS;
     }
 
+    else if (!regS->data)
+    {
+        return rtgui_region_subtract_box(regD, regM, &regS->extents);
+    }
+
     /* Add those rectangles in region 1 that aren't in region 2,
        do yucky substraction for overlaps, and
        just throw away rectangles in region 2 that aren't in region 1 */
@@ -1823,10 +2347,14 @@ int rtgui_region_contains_rectangle(rtgui_region_t *region, rtgui_rect_t *prect)
     x = prect->x1;
     y = prect->y1;
 
+    pbox = PIXREGION_BOXPTR(region);
+    pboxEnd = pbox + numRects;
+    /* skip the rects above or at left of (x,y) */
+    if (numRects > GUIENGIN_REGION_BSEARCH_RECTS)
+        pbox += rtgui_region_search(pbox, numRects, x, y);
+
     /* can stop when both partOut and partIn are RTGUI_REGION_STATUS_SUCCESS, or we reach prect->y2 */
-    for (pbox = PIXREGION_BOXPTR(region), pboxEnd = pbox + numRects;
-            pbox != pboxEnd;
-            pbox++)
+    for (; pbox != pboxEnd; pbox++)
     {
 
         if (pbox->y2 <= y)
@@ -1996,7 +2524,29 @@ int rtgui_region_contains_point(rtgui_region_t *region,
         return RT_EOK;
     }
 
-    for (pbox = PIXREGION_BOXPTR(region), pboxEnd = pbox + numRects;
+    /* the lookup of pixels usually hits the same rect as last time */
+    pbox = PIXREGION_BOXPTR(region);
+    if (region->data->hint < numRects && INBOX(&pbox[region->data->hint], x, y))
+    {
+        *box = pbox[region->data->hint];
+        return RT_EOK;
+    }
+
+    if (numRects > GUIENGIN_REGION_BSEARCH_RECTS)
+    {
+        int index = rtgui_region_search(pbox, numRects, x, y);
+
+        if (index < numRects && pbox[index].y1 <= y && pbox[index].x1 <= x)
+        {
+            region->data->hint = index;
+            *box = pbox[index];
+            return RT_EOK;
+        }
+
+        return -RT_ERROR;
+    }
+
+    for (pboxEnd = pbox + numRects;
             pbox != pboxEnd;
             pbox++)
     {
@@ -2006,6 +2556,7 @@ int rtgui_region_contains_point(rtgui_region_t *region,
             break;      /* missed it */
         if (x >= pbox->x2)
             continue;       /* not there yet */
+        region->data->hint = pbox - PIXREGION_BOXPTR(region);
         *box = *pbox;
         return RT_EOK;
     }
@@ -2020,6 +2571,28 @@ int rtgui_region_not_empty(rtgui_region_t *region)
     return(!PIXREGION_NIL(region));
 }
 
+int rtgui_region_is_equal(rtgui_region_t *region1, rtgui_region_t *region2)
+{
+    int num;
+
+    good(region1);
+    good(region2);
+
+    if (PIXREGION_NIL(region1) || PIXREGION_NIL(region2))
+        return (PIXREGION_NIL(region1) && PIXREGION_NIL(region2)) ? RT_EOK : -RT_ERROR;
+
+    num = PIXREGION_NUM_RECTS(region1);
+    if (num != PIXREGION_NUM_RECTS(region2))
+        return -RT_ERROR;
+
+    if (rt_memcmp(PIXREGION_RECTS(region1), PIXREGION_RECTS(region2),
+                  num * sizeof(rtgui_rect_t)) != 0)
+        return -RT_ERROR;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rtgui_region_is_equal);
+
 void rtgui_region_empty(rtgui_region_t *region)
 {
     good(region);
@@ -2097,6 +2670,115 @@ void rtgui_region_draw_clip(rtgui_region_t *region, struct rtgui_dc *dc)
 RTM_EXPORT(rtgui_region_draw_clip);
 #endif
 
+#ifdef GUIENGIN_REGION_SELFTEST
+/*
+ * Differential test of the fast paths of region operations: the results must
+ * be the same as the ones of the general band algorithm, rect by rect.
+ */
+static rt_uint32_t _selftest_seed = 1;
+
+static int _selftest_rand(int n)
+{
+    _selftest_seed = _selftest_seed * 1103515245 + 12345;
+    return (int)((_selftest_seed >> 16) % n);
+}
+
+static void _selftest_rect(rtgui_rect_t *rect)
+{
+    rect->x1 = _selftest_rand(64);
+    rect->y1 = _selftest_rand(64);
+    rect->x2 = rect->x1 + 1 + _selftest_rand(32);
+    rect->y2 = rect->y1 + 1 + _selftest_rand(32);
+}
+
+static void _selftest_region(rtgui_region_t *region)
+{
+    int i, num;
+    rtgui_rect_t rect;
+
+    rtgui_region_init(region);
+    num = 1 + _selftest_rand(8);
+    for (i = 0; i < num; i++)
+    {
+        _selftest_rect(&rect);
+        if (i == 0 || _selftest_rand(3))
+            rtgui_region_union_rect(region, region, &rect);
+        else
+            rtgui_region_subtract_rect(region, region, &rect);
+    }
+}
+
+int rtgui_region_selftest(int count)
+{
+    int i, op, overlap, error = 0;
+    rtgui_region_t reg1, reg2, box, fast, slow;
+
+    for (i = 0; i < count; i++)
+    {
+        _selftest_region(&reg1);
+        _selftest_region(&reg2);
+        rtgui_region_init(&fast);
+        rtgui_region_init(&slow);
+        box.data = RT_NULL;
+        _selftest_rect(&box.extents);
+
+        op = _selftest_rand(3);
+        if (PIXREGION_NIL(&reg1) || PIXREGION_NIL(&reg2))
+        {
+            op = -1;
+        }
+        else if (op == 0)
+        {
+            rtgui_region_intersect_box(&fast, &reg1, &box.extents);
+            rtgui_op(&slow, &reg1, &box, rtgui_region_intersectO,
+                     RTGUI_REGION_STATUS_FAILURE, RTGUI_REGION_STATUS_FAILURE, &overlap);
+            rtgui_set_extents(&slow);
+        }
+        else if (op == 1)
+        {
+            rtgui_region_subtract_box(&fast, &reg1, &box.extents);
+            rtgui_op(&slow, &reg1, &box, rtgui_region_subtractO,
+                     RTGUI_REGION_STATUS_SUCCESS, RTGUI_REGION_STATUS_FAILURE, &overlap);
+            rtgui_set_extents(&slow);
+        }
+        else
+        {
+            /* move reg2 below reg1, they may be adjacent */
+            rtgui_region_translate(&reg2, 0, reg1.extents.y2 - reg2.extents.y1 + _selftest_rand(2));
+            rtgui_region_union_disjoint(&fast, &reg1, &reg2);
+            rtgui_op(&slow, &reg1, &reg2, rtgui_region_unionO,
+                     RTGUI_REGION_STATUS_SUCCESS, RTGUI_REGION_STATUS_SUCCESS, &overlap);
+        }
+
+        if (op >= 0 && (rtgui_region_is_equal(&fast, &slow) != RT_EOK ||
+                        (op < 2 && rtgui_rect_is_equal(&fast.extents, &slow.extents) != RT_EOK)))
+        {
+            rt_kprintf("region selftest: op %d failed\n", op);
+            rtgui_region_dump(&reg1);
+            rtgui_region_dump(op < 2 ? &box : &reg2);
+            rtgui_region_dump(&fast);
+            rtgui_region_dump(&slow);
+            error ++;
+        }
+
+        rtgui_region_fini(&reg1);
+        rtgui_region_fini(&reg2);
+        rtgui_region_fini(&fast);
+        rtgui_region_fini(&slow);
+    }
+    rtgui_region_arena_reset();
+
+    rt_kprintf("region selftest: %d/%d failed\n", error, count);
+    return error;
+}
+RTM_EXPORT(rtgui_region_selftest);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+FINSH_FUNCTION_EXPORT(rtgui_region_selftest, check the fast paths of region operations);
+#endif
+#endif
+
 int rtgui_region_is_flat(rtgui_region_t *region)
 {
     int num;
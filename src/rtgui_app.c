@@ -28,6 +28,7 @@
 
 #include <rtgui/rtgui_system.h>
 #include <rtgui/rtgui_app.h>
+#include <rtgui/trace.h>
 #include <rtgui/widgets/window.h>
 #include <rtgui/widgets/topwin.h>
 
@@ -46,9 +47,19 @@ static void _rtgui_app_constructor(struct rtgui_app *app)
     app->win_acti_cnt   = 0;
     app->exit_code      = 0;
     app->tid            = RT_NULL;
-    app->mq             = RT_NULL;
+    rt_memset(app->lane, 0, sizeof(app->lane));
     app->main_object    = RT_NULL;
     app->on_idle        = RT_NULL;
+    app->idle_tick      = 0;
+    app->idle_done      = RT_TRUE;
+    app->idle_frame     = RT_FALSE;
+    rtgui_frame_clock_init(&app->frame);
+    app->region_arena.data = RT_NULL;
+    app->dither_err     = RT_NULL;
+    app->dither_err_size = 0;
+    app->motion_state   = 0;
+    app->button_head    = 0;
+    app->button_num     = 0;
 }
 
 static void _rtgui_app_destructor(struct rtgui_app *app)
@@ -57,6 +68,13 @@ static void _rtgui_app_destructor(struct rtgui_app *app)
 
     rt_free(app->name);
     app->name = RT_NULL;
+
+    rtgui_region_arena_fini(&app->region_arena);
+    if (app->dither_err != RT_NULL)
+    {
+        rtgui_free(app->dither_err);
+        app->dither_err = RT_NULL;
+    }
 }
 
 DEFINE_CLASS_TYPE(application, "application",
@@ -65,6 +83,37 @@ DEFINE_CLASS_TYPE(application, "application",
                   _rtgui_app_destructor,
                   sizeof(struct rtgui_app));
 
+static const rt_uint16_t _lane_depth[RTGUI_EVENT_LANE_MAX] =
+{
+    GUIENGIN_EVENT_LANE_INPUT_DEPTH,
+    GUIENGIN_EVENT_LANE_TIMER_DEPTH,
+    GUIENGIN_EVENT_LANE_PAINT_DEPTH,
+    GUIENGIN_EVENT_LANE_COMMAND_DEPTH,
+};
+
+static void _rtgui_app_delete_lanes(struct rtgui_app *app)
+{
+    int index;
+
+    for (index = 0; index < RTGUI_EVENT_LANE_MAX; index ++)
+    {
+        if (app->lane[index].mq == RT_NULL)
+            continue;
+
+        /* release the pooled events still in queue */
+        while (rt_mq_recv(app->lane[index].mq, app->event_buffer,
+                          sizeof(union rtgui_event_generic), 0) == RT_EOK)
+        {
+            struct rtgui_event *event = (struct rtgui_event *)app->event_buffer;
+
+            if (event->type == RTGUI_EVENT_REF)
+                rtgui_event_unref(((struct rtgui_event_ref *)event)->event);
+        }
+        rt_mq_delete(app->lane[index].mq);
+        app->lane[index].mq = RT_NULL;
+    }
+}
+
 struct rtgui_app *rtgui_app_create(const char *title)
 {
     rt_thread_t tid = rt_thread_self();
@@ -72,6 +121,7 @@ struct rtgui_app *rtgui_app_create(const char *title)
     struct rtgui_app *srv_app;
     struct rtgui_event_application event;
     char mq_name[RT_NAME_MAX];
+    int index;
 
     RT_ASSERT(tid != RT_NULL);
     RT_ASSERT(title != RT_NULL);
@@ -85,15 +135,23 @@ struct rtgui_app *rtgui_app_create(const char *title)
     RT_ASSERT(tid->user_data == 0);
     app->tid = tid;
 
-    rt_snprintf(mq_name, RT_NAME_MAX, "g%s", title);
-    app->mq = rt_mq_create(mq_name,
-                           sizeof(union rtgui_event_generic), 256,
-                           RT_IPC_FLAG_FIFO);
-    if (app->mq == RT_NULL)
+    RT_ASSERT(GUIENGIN_EVENT_SLOT_SIZE >= sizeof(struct rtgui_event_ref));
+    for (index = 0; index < RTGUI_EVENT_LANE_MAX; index ++)
     {
-        rt_kprintf("create msgq failed.\n");
-        goto __mq_err;
+        rt_snprintf(mq_name, RT_NAME_MAX, "%c%s", "itpg"[index], title);
+        app->lane[index].mq = rt_mq_create(mq_name,
+                                           GUIENGIN_EVENT_SLOT_SIZE, _lane_depth[index],
+                                           RT_IPC_FLAG_FIFO);
+        if (app->lane[index].mq == RT_NULL)
+        {
+            rt_kprintf("create msgq failed.\n");
+            goto __mq_err;
+        }
     }
+    rt_snprintf(mq_name, RT_NAME_MAX, "g%s", title);
+    rt_sem_init(&app->pending, mq_name, 0, RT_IPC_FLAG_FIFO);
+    rt_event_init(&app->ack, mq_name, RT_IPC_FLAG_FIFO);
+    rtgui_timer_wheel_init(&app->timer_wheel, mq_name);
 
     /* set application title */
     app->name = (unsigned char *)rt_strdup((char *)title);
@@ -121,7 +179,11 @@ struct rtgui_app *rtgui_app_create(const char *title)
     }
 
 __err:
+    rtgui_timer_wheel_fini(&app->timer_wheel);
+    rt_sem_detach(&app->pending);
+    rt_event_detach(&app->ack);
 __mq_err:
+    _rtgui_app_delete_lanes(app);
     rtgui_object_destroy(RTGUI_OBJECT(app));
     return RT_NULL;
 }
@@ -132,7 +194,7 @@ RTM_EXPORT(rtgui_app_create);
         RT_ASSERT(app != RT_NULL);              \
         RT_ASSERT(app->tid != RT_NULL);         \
         RT_ASSERT(app->tid->user_data != 0);    \
-        RT_ASSERT(app->mq != RT_NULL);          \
+        RT_ASSERT(app->lane[0].mq != RT_NULL);  \
     } while (0)
 
 void rtgui_app_destroy(struct rtgui_app *app)
@@ -163,7 +225,12 @@ void rtgui_app_destroy(struct rtgui_app *app)
     }
 
     app->tid->user_data = 0;
-    rt_mq_delete(app->mq);
+    /* no more frame events before the lanes are gone */
+    rtgui_frame_clock_fini(&app->frame);
+    rtgui_timer_wheel_fini(&app->timer_wheel);
+    _rtgui_app_delete_lanes(app);
+    rt_sem_detach(&app->pending);
+    rt_event_detach(&app->ack);
     rtgui_object_destroy(RTGUI_OBJECT(app));
 }
 RTM_EXPORT(rtgui_app_destroy);
@@ -185,6 +252,10 @@ void rtgui_app_set_onidle(struct rtgui_app *app, rtgui_idle_func_t onidle)
 {
     _rtgui_application_check(app);
     app->on_idle = onidle;
+    /* run the new callback as soon as the queue is empty */
+    app->idle_tick = rt_tick_get();
+    app->idle_done = (onidle == RT_NULL);
+    app->idle_frame = RT_FALSE;
 }
 RTM_EXPORT(rtgui_app_set_onidle);
 
@@ -239,6 +310,44 @@ rt_inline rt_bool_t _rtgui_application_dest_handle(
     }
 }
 
+/* the ticks to block on the queue before on_idle is due */
+static rt_int32_t _rtgui_app_idle_timeout(struct rtgui_app *app)
+{
+    rt_int32_t delta;
+
+    if (app->on_idle == RT_NULL || app->idle_done)
+        return RT_WAITING_FOREVER;
+
+    delta = (rt_int32_t)(app->idle_tick - rt_tick_get());
+    return delta > 0 ? delta : 0;
+}
+
+static void _rtgui_app_idle(struct rtgui_app *app)
+{
+    rt_int32_t next;
+    rt_tick_t now;
+
+    next = app->on_idle(RTGUI_OBJECT(app), RT_NULL);
+    now = rt_tick_get();
+
+    if (next == RTGUI_IDLE_DONE)
+    {
+        app->idle_done = RT_TRUE;
+    }
+    else if (next == RTGUI_IDLE_FRAME)
+    {
+        /* called in the next RTGUI_EVENT_FRAME */
+        app->idle_done = RT_TRUE;
+        app->idle_frame = RT_TRUE;
+        rtgui_frame_request(app);
+    }
+    else
+    {
+        app->idle_done = RT_FALSE;
+        app->idle_tick = now + (next > 0 ? next : 0);
+    }
+}
+
 rt_bool_t rtgui_app_event_handler(struct rtgui_object *object, rtgui_event_t *event)
 {
     struct rtgui_app *app;
@@ -320,29 +429,18 @@ rt_bool_t rtgui_app_event_handler(struct rtgui_object *object, rtgui_event_t *ev
         break;
 
     case RTGUI_EVENT_TIMER:
-    {
-        rt_base_t level;
-        struct rtgui_timer *timer;
-        struct rtgui_event_timer *etimer = (struct rtgui_event_timer *) event;
-
-        timer = etimer->timer;
-        level = rt_hw_interrupt_disable();
-        timer->pending_cnt--;
-        rt_hw_interrupt_enable(level);
-        RT_ASSERT(timer->pending_cnt >= 0);
-        if (timer->state == RTGUI_TIMER_ST_DESTROY_PENDING)
-        {
-            /* Truly destroy the timer when there is no pending event. */
-            if (timer->pending_cnt == 0)
-                rtgui_timer_destory(timer);
-        }
-        else if (timer->state == RTGUI_TIMER_ST_RUNNING && timer->timeout != RT_NULL)
+        rtgui_timer_wheel_run(&app->timer_wheel);
+        break;
+
+    case RTGUI_EVENT_FRAME:
+        if (app->idle_frame)
         {
-            /* call timeout function */
-            timer->timeout(timer, timer->user_data);
+            app->idle_frame = RT_FALSE;
+            if (app->on_idle != RT_NULL)
+                _rtgui_app_idle(app);
         }
-    }
-    break;
+        rtgui_frame_dispatch(app, (struct rtgui_event_frame *)event);
+        break;
 
     case RTGUI_EVENT_MV_MODEL:
     {
@@ -381,36 +479,57 @@ rt_bool_t rtgui_app_event_handler(struct rtgui_object *object, rtgui_event_t *ev
 }
 RTM_EXPORT(rtgui_app_event_handler);
 
-rt_inline void _rtgui_application_event_loop(struct rtgui_app *app)
+/* handle one event or the idle callback, block at most timeout ticks */
+static void _rtgui_app_step(struct rtgui_app *app, rt_int32_t timeout)
 {
     rt_err_t result;
-    rt_uint16_t current_ref;
+    rt_int32_t idle;
     struct rtgui_event *event;
 
-    _rtgui_application_check(app);
+    idle = _rtgui_app_idle_timeout(app);
+    if (idle != RT_WAITING_FOREVER &&
+        (timeout == RT_WAITING_FOREVER || idle < timeout))
+        timeout = idle;
+
+    result = rtgui_recv_ref(&event, timeout);
+    if (result == RT_EOK)
+    {
+#ifdef GUIENGIN_USING_TRACE
+        rt_uint32_t type = event->type, begin = rtgui_trace_now();
+#endif
+
+        RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), event);
+        rtgui_recv_done(event);
+
+#ifdef GUIENGIN_USING_TRACE
+        rtgui_trace_dispatch(type, begin);
+#endif
+
+        /* the event may bring new work to the idle callback */
+        if (app->idle_done && !app->idle_frame && app->on_idle != RT_NULL)
+        {
+            app->idle_tick = rt_tick_get();
+            app->idle_done = RT_FALSE;
+        }
+    }
+    else if (result == -RT_ETIMEOUT && _rtgui_app_idle_timeout(app) == 0)
+    {
+        _rtgui_app_idle(app);
+    }
+}
+
+rt_inline void _rtgui_application_event_loop(struct rtgui_app *app)
+{
+    rt_uint16_t current_ref;
 
-    /* point to event buffer */
-    event = (struct rtgui_event *)app->event_buffer;
+    _rtgui_application_check(app);
 
     current_ref = ++app->ref_count;
     while (current_ref <= app->ref_count)
     {
         RT_ASSERT(current_ref == app->ref_count);
 
-        if (app->on_idle != RT_NULL)
-        {
-            result = rtgui_recv(event, sizeof(union rtgui_event_generic), 0);
-            if (result == RT_EOK)
-                RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), event);
-            else if (result == -RT_ETIMEOUT)
-                app->on_idle(RTGUI_OBJECT(app), RT_NULL);
-        }
-        else
-        {
-            result = rtgui_recv(event, sizeof(union rtgui_event_generic), RT_WAITING_FOREVER);
-            if (result == RT_EOK)
-                RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), event);
-        }
+        _rtgui_app_step(app, RT_WAITING_FOREVER);
     }
 }
 
@@ -452,9 +571,7 @@ RTM_EXPORT(rtgui_app_activate);
 
 void rtgui_app_sleep(struct rtgui_app *app, int millisecond)
 {
-    rt_err_t result;
     rt_uint16_t current_ref;
-    struct rtgui_event *event;
     rt_tick_t tick, sleep_tick;
     int delta_tick;
 
@@ -465,28 +582,12 @@ void rtgui_app_sleep(struct rtgui_app *app, int millisecond)
     sleep_tick = tick + millisecond;
     delta_tick = millisecond;
 
-    /* point to event buffer */
-    event = (struct rtgui_event *)app->event_buffer;
-
     current_ref = ++app->ref_count;
-    while (current_ref <= app->ref_count && delta_tick)
+    while (current_ref <= app->ref_count && delta_tick > 0)
     {
         RT_ASSERT(current_ref == app->ref_count);
 
-        if (app->on_idle != RT_NULL)
-        {
-            result = rtgui_recv(event, sizeof(union rtgui_event_generic), 0);
-            if (result == RT_EOK)
-                RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), event);
-            else if (result == -RT_ETIMEOUT)
-                app->on_idle(RTGUI_OBJECT(app), RT_NULL);
-        }
-        else
-        {
-            result = rtgui_recv(event, sizeof(union rtgui_event_generic), sleep_tick - rt_tick_get());
-            if (result == RT_EOK)
-                RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), event);
-        }
+        _rtgui_app_step(app, delta_tick);
 
         delta_tick = sleep_tick - rt_tick_get();
     }
@@ -557,3 +658,25 @@ unsigned int rtgui_app_get_win_acti_cnt(void)
 }
 RTM_EXPORT(rtgui_app_get_win_acti_cnt);
 
+
+void rtgui_app_get_lane_stat(struct rtgui_app *app, enum rtgui_event_lane_id id,
+                             struct rtgui_event_lane_stat *stat)
+{
+    rt_base_t level;
+    struct rtgui_event_lane *lane;
+
+    RT_ASSERT(app != RT_NULL);
+    RT_ASSERT(id < RTGUI_EVENT_LANE_MAX);
+    RT_ASSERT(stat != RT_NULL);
+
+    lane = &app->lane[id];
+
+    level = rt_hw_interrupt_disable();
+    stat->sent    = lane->sent;
+    stat->dropped = lane->dropped;
+    stat->depth   = lane->mq->entry;
+    stat->peak    = lane->peak;
+    stat->limit   = lane->mq->max_msgs;
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rtgui_app_get_lane_stat);
@@ -25,6 +25,7 @@
 #include <rtgui/driver.h>
 #include <rtgui/region.h>
 #include <rtgui/rtgui_system.h>
+#include <rtgui/trace.h>
 #include <string.h>
 
 extern const struct rtgui_graphic_driver_ops *rtgui_pixel_device_get_ops(int pixel_format);
@@ -260,7 +261,16 @@ void rtgui_graphic_driver_screen_update(const struct rtgui_graphic_driver *drive
         rect_info.width -= rect_info.x;
         rect_info.height -= rect_info.y;
 
+#ifdef GUIENGIN_USING_TRACE
+        {
+            rt_uint32_t begin = rtgui_trace_now();
+
+            rt_device_control(driver->device, RTGRAPHIC_CTRL_RECT_UPDATE, &rect_info);
+            rtgui_trace_update(begin);
+        }
+#else
         rt_device_control(driver->device, RTGRAPHIC_CTRL_RECT_UPDATE, &rect_info);
+#endif
     }
 }
 RTM_EXPORT(rtgui_graphic_driver_screen_update);
@@ -23,13 +23,17 @@
  * 2016-03-23     Bernard      fix the default font initialization issue.
  */
 
+#include <rthw.h>
 #include <rtgui/rtgui.h>
 #include <rtgui/image.h>
 #include <rtgui/font.h>
 #include <rtgui/event.h>
+#include <rtgui/frame.h>
 #include <rtgui/rtgui_app.h>
 #include <rtgui/rtgui_server.h>
 #include <rtgui/rtgui_system.h>
+#include <rtgui/shape_cache.h>
+#include <rtgui/trace.h>
 #include <rtgui/widgets/window.h>
 
 
@@ -46,6 +50,8 @@ extern struct rtgui_font rtgui_font_asc12;
 static rtgui_rect_t _mainwin_rect;
 static struct rt_mutex _screen_lock;
 
+static void rtgui_system_event_pool_init(void);
+
 int rtgui_system_server_init(void)
 {
     rt_mutex_init(&_screen_lock, "screen", RT_IPC_FLAG_FIFO);
@@ -54,11 +60,18 @@ int rtgui_system_server_init(void)
     rtgui_system_image_init();
     /* init font */
     rtgui_font_system_init();
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+    /* init shape cache */
+    rtgui_system_shape_cache_init();
+#endif
 
     /* init rtgui server */
     rtgui_topwin_init();
     rtgui_server_init();
 
+    rtgui_system_event_pool_init();
+    rtgui_system_frame_init();
+
     /* use driver rect for main window */
     rtgui_graphic_driver_get_rect(rtgui_graphic_driver_get_default(), &_mainwin_rect);
 
@@ -69,45 +82,345 @@ INIT_ENV_EXPORT(rtgui_system_server_init);
 /************************************************************************/
 /* RTGUI Timer                                                          */
 /************************************************************************/
-static void rtgui_time_out(void *parameter)
+#define _WHEEL_SHIFT(level)     ((level) * GUIENGIN_TIMER_WHEEL_BITS)
+#define _WHEEL_RANGE            ((rt_tick_t)1 << _WHEEL_SHIFT(RTGUI_TIMER_WHEEL_LEVEL))
+
+static void _rtgui_wheel_add(struct rtgui_timer_wheel *wheel, rtgui_timer_t *timer)
 {
-    rt_err_t result;
+    int level, index;
+    rt_tick_t expires;
+    rt_int32_t delta;
+
+    expires = timer->expires;
+    delta = (rt_int32_t)(expires - wheel->now);
+    if (delta < 0)
+    {
+        /* already expired, run it on the next tick */
+        expires = wheel->now;
+        delta = 0;
+    }
+    else if ((rt_tick_t)delta >= _WHEEL_RANGE)
+    {
+        /* out of the wheel, it will be placed again when reached */
+        expires = wheel->now + _WHEEL_RANGE - 1;
+        delta = _WHEEL_RANGE - 1;
+    }
+
+    for (level = 0; level < RTGUI_TIMER_WHEEL_LEVEL - 1; level ++)
+    {
+        if ((rt_tick_t)delta < ((rt_tick_t)1 << _WHEEL_SHIFT(level + 1)))
+            break;
+    }
+
+    index = (expires >> _WHEEL_SHIFT(level)) & RTGUI_TIMER_WHEEL_MASK;
+    rt_list_insert_before(&wheel->slot[level][index], &timer->list);
+    wheel->bitmap[level] |= 1ul << index;
+}
+
+/* move the timers of a slot to the lower levels */
+static void _rtgui_wheel_cascade(struct rtgui_timer_wheel *wheel)
+{
+    int level, index;
+    rt_list_t *slot;
     rtgui_timer_t *timer;
+
+    for (level = 1; level < RTGUI_TIMER_WHEEL_LEVEL; level ++)
+    {
+        index = (wheel->now >> _WHEEL_SHIFT(level)) & RTGUI_TIMER_WHEEL_MASK;
+
+        slot = &wheel->slot[level][index];
+        wheel->bitmap[level] &= ~(1ul << index);
+        while (!rt_list_isempty(slot))
+        {
+            timer = rt_list_entry(slot->next, rtgui_timer_t, list);
+            rt_list_remove(&timer->list);
+            _rtgui_wheel_add(wheel, timer);
+        }
+
+        /* the upper level is reached only on its boundary */
+        if (index != 0)
+            break;
+    }
+}
+
+/* the tick of next expiry or cascading */
+static rt_tick_t _rtgui_wheel_next(struct rtgui_timer_wheel *wheel)
+{
+    int level, index, first, distance;
+    rt_tick_t next, best;
+    rt_bool_t found;
+
+    found = RT_FALSE;
+    best = wheel->now;
+    for (level = 0; level < RTGUI_TIMER_WHEEL_LEVEL; level ++)
+    {
+        if (wheel->bitmap[level] == 0)
+            continue;
+
+        /* the slot of current index is cascaded on the boundary only */
+        first = 0;
+        if (level > 0 && (wheel->now & (((rt_tick_t)1 << _WHEEL_SHIFT(level)) - 1)))
+            first = 1;
+
+        for (distance = first; distance < first + RTGUI_TIMER_WHEEL_SIZE; distance ++)
+        {
+            index = ((wheel->now >> _WHEEL_SHIFT(level)) + distance) & RTGUI_TIMER_WHEEL_MASK;
+            if (!(wheel->bitmap[level] & (1ul << index)))
+                continue;
+
+            if (rt_list_isempty(&wheel->slot[level][index]))
+            {
+                /* the timers have been stopped */
+                wheel->bitmap[level] &= ~(1ul << index);
+                continue;
+            }
+
+            next = ((wheel->now >> _WHEEL_SHIFT(level)) + distance) << _WHEEL_SHIFT(level);
+            if (!found || (rt_int32_t)(next - best) < 0)
+                best = next;
+            found = RT_TRUE;
+            break;
+        }
+    }
+
+    return best;
+}
+
+/* wake up the app on the next expiry */
+static void _rtgui_wheel_arm(struct rtgui_timer_wheel *wheel)
+{
+    rt_tick_t next;
+    rt_int32_t delta;
+
+    if (wheel->count == 0)
+    {
+        if (wheel->armed)
+        {
+            wheel->armed = RT_FALSE;
+            rt_timer_stop(&wheel->timer);
+        }
+        return;
+    }
+
+    next = _rtgui_wheel_next(wheel);
+    /* an earlier wakeup only arms again */
+    if (wheel->armed && (rt_int32_t)(wheel->armed_tick - next) <= 0)
+        return;
+
+    delta = (rt_int32_t)(next - rt_tick_get());
+    if (delta < 1)
+        delta = 1;
+
+    rt_timer_stop(&wheel->timer);
+    rt_timer_control(&wheel->timer, RT_TIMER_CTRL_SET_TIME, &delta);
+    wheel->armed_tick = next;
+    wheel->armed = RT_TRUE;
+    rt_timer_start(&wheel->timer);
+}
+
+static void _rtgui_wheel_timeout(void *parameter)
+{
+    rt_base_t level;
+    struct rtgui_app *app;
     rtgui_event_timer_t event;
-    timer = (rtgui_timer_t *)parameter;
+    struct rtgui_timer_wheel *wheel;
+
+    wheel = (struct rtgui_timer_wheel *)parameter;
+    app = RTGUI_CONTAINER_OF(wheel, struct rtgui_app, timer_wheel);
 
-    if (!(timer->state == RTGUI_TIMER_ST_RUNNING))
+    level = rt_hw_interrupt_disable();
+    wheel->armed = RT_FALSE;
+    if (wheel->event_pending)
+    {
+        rt_hw_interrupt_enable(level);
         return;
+    }
+    wheel->event_pending = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
     /*
     * Note: event_timer can not use RTGUI_EVENT_TIMER_INIT to init, for there is no
     * thread context
     */
     event.parent.type = RTGUI_EVENT_TIMER;
+    event.parent.user = 0;
     event.parent.sender = RT_NULL;
+    event.parent.ack = RT_NULL;
 
-    event.timer = timer;
+    /* all the timers due are run on this event */
+    event.timer = RT_NULL;
 
-    result = rtgui_send(timer->app, &(event.parent), sizeof(rtgui_event_timer_t));
-    if (result == RT_EOK)
+    if (rtgui_send(app, &(event.parent), sizeof(rtgui_event_timer_t)) != RT_EOK)
     {
-        timer->pending_cnt++;
+        rt_int32_t delta = RTGUI_TIMER_WHEEL_RETRY;
+
+        /* the queue is full, try again shortly rather than after the last
+         * armed period, an earlier expiry arms again as usual */
+        rt_timer_control(&wheel->timer, RT_TIMER_CTRL_SET_TIME, &delta);
+        level = rt_hw_interrupt_disable();
+        wheel->event_pending = RT_FALSE;
+        wheel->armed_tick = rt_tick_get() + delta;
+        wheel->armed = RT_TRUE;
+        rt_hw_interrupt_enable(level);
+        rt_timer_start(&wheel->timer);
     }
 }
 
+void rtgui_timer_wheel_init(struct rtgui_timer_wheel *wheel, const char *name)
+{
+    int level, index;
+
+    wheel->now = rt_tick_get();
+    wheel->count = 0;
+    for (level = 0; level < RTGUI_TIMER_WHEEL_LEVEL; level ++)
+    {
+        wheel->bitmap[level] = 0;
+        for (index = 0; index < RTGUI_TIMER_WHEEL_SIZE; index ++)
+            rt_list_init(&wheel->slot[level][index]);
+    }
+
+    wheel->armed_tick = 0;
+    wheel->armed = RT_FALSE;
+    wheel->event_pending = RT_FALSE;
+    rt_timer_init(&wheel->timer, name, _rtgui_wheel_timeout, wheel,
+                  1, RT_TIMER_FLAG_ONE_SHOT);
+}
+
+void rtgui_timer_wheel_fini(struct rtgui_timer_wheel *wheel)
+{
+    rt_timer_stop(&wheel->timer);
+    rt_timer_detach(&wheel->timer);
+    wheel->armed = RT_FALSE;
+}
+
+void rtgui_timer_wheel_run(struct rtgui_timer_wheel *wheel)
+{
+    int index;
+    rt_base_t level;
+    rt_tick_t until, next;
+    rt_list_t expired, *slot;
+    rtgui_timer_t *timer;
+
+    level = rt_hw_interrupt_disable();
+    wheel->event_pending = RT_FALSE;
+    rt_hw_interrupt_enable(level);
+
+    until = rt_tick_get();
+    if (wheel->count == 0)
+    {
+        wheel->now = until + 1;
+        return;
+    }
+
+    rt_list_init(&expired);
+    while ((rt_int32_t)(until - wheel->now) >= 0)
+    {
+        index = wheel->now & RTGUI_TIMER_WHEEL_MASK;
+        if (index == 0)
+            _rtgui_wheel_cascade(wheel);
+
+        if (wheel->bitmap[0] == 0)
+        {
+            /* nothing on the lowest level, skip to the next cascading */
+            next = (wheel->now | RTGUI_TIMER_WHEEL_MASK) + 1;
+            if ((rt_int32_t)(until - next) < 0)
+                next = until + 1;
+            wheel->now = next;
+            continue;
+        }
+
+        if (wheel->bitmap[0] & (1ul << index))
+        {
+            wheel->bitmap[0] &= ~(1ul << index);
+
+            slot = &wheel->slot[0][index];
+            while (!rt_list_isempty(slot))
+            {
+                timer = rt_list_entry(slot->next, rtgui_timer_t, list);
+                rt_list_remove(&timer->list);
+                rt_list_insert_before(&expired, &timer->list);
+            }
+        }
+
+        wheel->now ++;
+    }
+
+    /* the timeout functions may start or stop any timer */
+    while (!rt_list_isempty(&expired))
+    {
+        timer = rt_list_entry(expired.next, rtgui_timer_t, list);
+        rt_list_remove(&timer->list);
+        wheel->count --;
+
+        if (timer->flag & RT_TIMER_FLAG_PERIODIC)
+        {
+            timer->expires += timer->init_tick;
+            /* don't catch up the periods missed */
+            if ((rt_int32_t)(timer->expires - until) <= 0)
+                timer->expires = until + timer->init_tick;
+
+            _rtgui_wheel_add(wheel, timer);
+            wheel->count ++;
+        }
+        else
+        {
+            timer->state = RTGUI_TIMER_ST_INIT;
+        }
+
+        if (timer->timeout != RT_NULL)
+            timer->timeout(timer, timer->user_data);
+    }
+
+    _rtgui_wheel_arm(wheel);
+}
+
+/* round up to the coarsest boundary in the slack, so the timers nearby
+ * expire on the same tick */
+static rt_tick_t _rtgui_timer_slack(rtgui_timer_t *timer, rt_tick_t expires)
+{
+    int bit;
+    rt_int32_t slack;
+    rt_tick_t limit, mask;
+
+    slack = timer->slack;
+    if (slack == RTGUI_TIMER_SLACK_AUTO)
+        slack = timer->init_tick >> GUIENGIN_TIMER_SLACK_SHIFT;
+    if (slack <= 0)
+        return expires;
+
+    limit = expires + slack;
+    mask = expires ^ limit;
+    if (mask == 0)
+        return expires;
+
+    /* the highest bit differs */
+    bit = 0;
+    while (mask >>= 1) bit ++;
+    mask = ((rt_tick_t)1 << bit) - 1;
+
+    return limit & ~mask;
+}
+
 rtgui_timer_t *rtgui_timer_create(rt_int32_t time, rt_int32_t flag, rtgui_timeout_func timeout, void *parameter)
 {
     rtgui_timer_t *timer;
 
     timer = (rtgui_timer_t *) rtgui_malloc(sizeof(rtgui_timer_t));
+    if (timer == RT_NULL)
+        return RT_NULL;
+
     timer->app = rtgui_app_self();
-    timer->timeout = timeout;
-    timer->pending_cnt = 0;
+    RT_ASSERT(timer->app != RT_NULL);
+
+    rt_list_init(&timer->list);
+    timer->expires = 0;
+    timer->init_tick = time;
+    timer->slack = RTGUI_TIMER_SLACK_AUTO;
+    timer->flag = (rt_uint8_t)flag;
     timer->state = RTGUI_TIMER_ST_INIT;
+    timer->timeout = timeout;
     timer->user_data = parameter;
 
-    /* init rt-thread timer */
-    rt_timer_init(&(timer->timer), "rtgui", rtgui_time_out, timer, time, (rt_uint8_t)flag);
-
     return timer;
 }
 RTM_EXPORT(rtgui_timer_create);
@@ -116,18 +429,9 @@ void rtgui_timer_destory(rtgui_timer_t *timer)
 {
     RT_ASSERT(timer != RT_NULL);
 
-    /* stop timer firstly */
+    /* no event refers to the timer, free it now */
     rtgui_timer_stop(timer);
-    if (timer->pending_cnt != 0 && timer->app->ref_count != 0)
-    {
-        timer->state = RTGUI_TIMER_ST_DESTROY_PENDING;
-    }
-    else
-    {
-        /* detach rt-thread timer */
-        rt_timer_detach(&(timer->timer));
-        rtgui_free(timer);
-    }
+    rtgui_free(timer);
 }
 RTM_EXPORT(rtgui_timer_destory);
 
@@ -135,37 +439,72 @@ void rtgui_timer_set_timeout(rtgui_timer_t *timer, rt_int32_t time)
 {
     RT_ASSERT(timer != RT_NULL);
 
-    /* start rt-thread timer */
+    timer->init_tick = time;
     if (timer->state == RTGUI_TIMER_ST_RUNNING)
     {
-        rtgui_timer_stop(timer);
-        rt_timer_control(&timer->timer, RT_TIMER_CTRL_SET_TIME, &time);
         rtgui_timer_start(timer);
     }
-    else
-    {
-        rt_timer_control(&timer->timer, RT_TIMER_CTRL_SET_TIME, &time);
-    }
 }
 RTM_EXPORT(rtgui_timer_set_timeout);
 
+void rtgui_timer_set_slack(rtgui_timer_t *timer, rt_int32_t slack)
+{
+    RT_ASSERT(timer != RT_NULL);
+
+    /* take effect on next start */
+    timer->slack = slack;
+}
+RTM_EXPORT(rtgui_timer_set_slack);
+
 void rtgui_timer_start(rtgui_timer_t *timer)
 {
+    struct rtgui_timer_wheel *wheel;
+
     RT_ASSERT(timer != RT_NULL);
+    /* the wheel is not locked, only the app of timer touches it */
+    RT_ASSERT(rtgui_app_self() == timer->app);
+
+    wheel = &timer->app->timer_wheel;
+    if (timer->state == RTGUI_TIMER_ST_RUNNING)
+    {
+        rt_list_remove(&timer->list);
+        wheel->count --;
+    }
+    else if (wheel->count == 0)
+    {
+        /* the wheel has been idle */
+        wheel->now = rt_tick_get();
+    }
 
-    /* start rt-thread timer */
     timer->state = RTGUI_TIMER_ST_RUNNING;
-    rt_timer_start(&(timer->timer));
+    timer->expires = _rtgui_timer_slack(timer, rt_tick_get() + timer->init_tick);
+    _rtgui_wheel_add(wheel, timer);
+    wheel->count ++;
+
+    _rtgui_wheel_arm(wheel);
 }
 RTM_EXPORT(rtgui_timer_start);
 
 void rtgui_timer_stop(rtgui_timer_t *timer)
 {
+    struct rtgui_timer_wheel *wheel;
+
     RT_ASSERT(timer != RT_NULL);
+    /* the wheel is not locked, only the app of timer touches it */
+    RT_ASSERT(rtgui_app_self() == timer->app);
+
+    if (timer->state != RTGUI_TIMER_ST_RUNNING)
+        return;
 
-    /* stop rt-thread timer */
+    wheel = &timer->app->timer_wheel;
+    rt_list_remove(&timer->list);
+    wheel->count --;
     timer->state = RTGUI_TIMER_ST_INIT;
-    rt_timer_stop(&(timer->timer));
+
+    /* the kernel timer is left to expire if there are timers, that is
+     * cheaper than arming it again */
+    if (wheel->count == 0)
+        _rtgui_wheel_arm(wheel);
 }
 RTM_EXPORT(rtgui_timer_stop);
 
@@ -387,7 +726,7 @@ FINSH_FUNCTION_EXPORT(list_guimem, display memory information);
 
 // #define RTGUI_EVENT_DEBUG
 
-#ifdef RTGUI_EVENT_DEBUG
+#if defined(RTGUI_EVENT_DEBUG) || defined(GUIENGIN_USING_TRACE)
 const char *rtgui_event_string[] =
 {
     /* application event */
@@ -439,8 +778,23 @@ const char *rtgui_event_string[] =
     "UNSELECTED",           /* widget unselected    */
     "MV_MODEL",             /* modal chaned in MV   */
     "BUS_NOTIFY_EVENT",
+    "REF",                  /* reference to a pooled event */
+    "FRAME",                /* vsync of frame clock */
+    "INPUT_REQUEST",        /* requests of input stage */
 };
 
+const char *rtgui_event_name(rt_uint32_t type)
+{
+    if (type >= RTGUI_EVENT_COMMAND)
+        return "COMMAND";
+    if (type >= sizeof(rtgui_event_string) / sizeof(rtgui_event_string[0]))
+        return "UNKNOWN";
+
+    return rtgui_event_string[type];
+}
+#endif
+
+#ifdef RTGUI_EVENT_DEBUG
 #define DBG_MSG(x)  rt_kprintf x
 
 static void rtgui_event_dump(struct rtgui_app* app, rtgui_event_t *event)
@@ -448,6 +802,7 @@ static void rtgui_event_dump(struct rtgui_app* app, rtgui_event_t *event)
     char *sender = "(unknown)";
 
     if ((event->type == RTGUI_EVENT_TIMER) ||
+            (event->type == RTGUI_EVENT_FRAME) ||
             (event->type == RTGUI_EVENT_UPDATE_BEGIN) ||
             (event->type == RTGUI_EVENT_MOUSE_MOTION) ||
             (event->type == RTGUI_EVENT_UPDATE_END))
@@ -618,9 +973,303 @@ static void rtgui_event_dump(struct rtgui_app* app, rtgui_event_t *event)
 #define rtgui_event_dump(app, event)
 #endif
 
+/************************************************************************/
+/* RTGUI Event Pool                                                     */
+/************************************************************************/
+/*
+ * A pooled event is prefixed by this header. The message queue only carries
+ * a RTGUI_EVENT_REF pointing to it, so one event can be shared by several
+ * receivers and may be larger than a queue slot.
+ */
+struct rtgui_event_obj
+{
+    rt_uint16_t ref_count;
+    rt_uint16_t pooled;
+    rt_uint32_t size;
+};
+
+#define _EVENT_OBJ(e)       (((struct rtgui_event_obj *)(e)) - 1)
+#define _EVENT_BLOCK_SIZE   RT_ALIGN(sizeof(struct rtgui_event_obj) + sizeof(union rtgui_event_generic), RT_ALIGN_SIZE)
+
+static struct rt_mempool _event_mp;
+static rt_uint8_t _event_mp_inited = 0;
+static rt_uint8_t _event_mp_pool[(_EVENT_BLOCK_SIZE + sizeof(rt_uint8_t *)) * GUIENGIN_EVENT_POOL_NUM];
+
+static void rtgui_system_event_pool_init(void)
+{
+    if (rt_mp_init(&_event_mp, "evpool", _event_mp_pool,
+                   sizeof(_event_mp_pool), _EVENT_BLOCK_SIZE) == RT_EOK)
+        _event_mp_inited = 1;
+}
+
+struct rtgui_event *rtgui_event_alloc(rt_uint32_t type, rt_size_t size)
+{
+    struct rtgui_event_obj *obj = RT_NULL;
+    struct rtgui_event *event;
+
+    RT_ASSERT(size >= sizeof(struct rtgui_event));
+
+    /* the pool may be empty; large events always come from heap */
+    if (_event_mp_inited && size <= sizeof(union rtgui_event_generic))
+    {
+        obj = (struct rtgui_event_obj *)rt_mp_alloc(&_event_mp, 0);
+        if (obj != RT_NULL)
+            obj->pooled = 1;
+    }
+    if (obj == RT_NULL)
+    {
+        obj = (struct rtgui_event_obj *)rtgui_malloc(sizeof(struct rtgui_event_obj) + size);
+        if (obj == RT_NULL)
+            return RT_NULL;
+        obj->pooled = 0;
+    }
+    obj->ref_count = 1;
+    obj->size = size;
+
+    event = (struct rtgui_event *)(obj + 1);
+    rt_memset(event, 0, size);
+    RTGUI_EVENT_INIT(event, type);
+
+    return event;
+}
+RTM_EXPORT(rtgui_event_alloc);
+
+struct rtgui_event *rtgui_event_ref(struct rtgui_event *event)
+{
+    rt_base_t level;
+
+    RT_ASSERT(event != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    RT_ASSERT(_EVENT_OBJ(event)->ref_count != 0);
+    _EVENT_OBJ(event)->ref_count ++;
+    rt_hw_interrupt_enable(level);
+
+    return event;
+}
+RTM_EXPORT(rtgui_event_ref);
+
+void rtgui_event_unref(struct rtgui_event *event)
+{
+    rt_base_t level;
+    rt_uint16_t ref_count;
+    struct rtgui_event_obj *obj;
+
+    RT_ASSERT(event != RT_NULL);
+
+    obj = _EVENT_OBJ(event);
+    level = rt_hw_interrupt_disable();
+    RT_ASSERT(obj->ref_count != 0);
+    ref_count = -- obj->ref_count;
+    rt_hw_interrupt_enable(level);
+
+    if (ref_count != 0)
+        return;
+
+    if (obj->pooled)
+        rt_mp_free(obj);
+    else
+        rtgui_free(obj);
+}
+RTM_EXPORT(rtgui_event_unref);
+
+/* copy an event which does not fit into a queue slot into a pooled one */
+static struct rtgui_event *_rtgui_event_dup(struct rtgui_event *event, rt_size_t event_size)
+{
+    struct rtgui_event *dup;
+
+    dup = rtgui_event_alloc(event->type, event_size);
+    if (dup != RT_NULL)
+        rt_memcpy(dup, event, event_size);
+
+    return dup;
+}
+
 /************************************************************************/
 /* RTGUI IPC APIs                                                       */
 /************************************************************************/
+/*
+ * the lane of app event queue an event goes through.
+ *
+ * The events in one lane keep the order they are sent in. The window state
+ * changes sent to a client go with the clip and paint events, so a window
+ * is never painted with the state before the activation, move or show
+ * notified ahead of the paint. The input lane is taken first, an input
+ * event may be handled before the state change queued ahead of it. The
+ * server takes the window requests in the command lane, in the order the
+ * clients sent them.
+ */
+static enum rtgui_event_lane_id _rtgui_event_lane(struct rtgui_app *app, rt_uint32_t type)
+{
+    switch (type)
+    {
+    case RTGUI_EVENT_MOUSE_MOTION:
+    case RTGUI_EVENT_MOUSE_BUTTON:
+    case RTGUI_EVENT_KBD:
+    case RTGUI_EVENT_TOUCH:
+    case RTGUI_EVENT_GESTURE:
+    case RTGUI_EVENT_INPUT_REQUEST:
+        return RTGUI_EVENT_LANE_INPUT;
+
+    case RTGUI_EVENT_TIMER:
+    case RTGUI_EVENT_FRAME:
+        return RTGUI_EVENT_LANE_TIMER;
+
+    /* the clip is taken before the paint events following it */
+    case RTGUI_EVENT_CLIP_INFO:
+    case RTGUI_EVENT_PAINT:
+    case RTGUI_EVENT_VPAINT_REQ:
+        return RTGUI_EVENT_LANE_PAINT;
+
+    case RTGUI_EVENT_WIN_SHOW:
+    case RTGUI_EVENT_WIN_HIDE:
+    case RTGUI_EVENT_WIN_ACTIVATE:
+    case RTGUI_EVENT_WIN_DEACTIVATE:
+    case RTGUI_EVENT_WIN_CLOSE:
+    case RTGUI_EVENT_WIN_MOVE:
+        if (app != rtgui_get_server())
+            return RTGUI_EVENT_LANE_PAINT;
+        break;
+
+    default:
+        break;
+    }
+
+    return RTGUI_EVENT_LANE_COMMAND;
+}
+
+static rt_err_t _rtgui_lane_send(struct rtgui_app* app, rt_uint32_t type,
+                                 rtgui_event_t *event, rt_size_t size, rt_bool_t urgent)
+{
+    rt_err_t result;
+    rt_base_t level;
+    struct rtgui_event_lane *lane;
+
+#ifdef GUIENGIN_USING_TRACE
+    event->stamp = rtgui_trace_now();
+#endif
+
+    lane = &app->lane[_rtgui_event_lane(app, type)];
+    if (urgent)
+        result = rt_mq_urgent(lane->mq, event, size);
+    else
+        result = rt_mq_send(lane->mq, event, size);
+
+#ifdef GUIENGIN_USING_TRACE
+    rtgui_trace_send(app, type, result);
+#endif
+
+    level = rt_hw_interrupt_disable();
+    if (result == RT_EOK)
+    {
+        lane->sent ++;
+        if (lane->mq->entry > lane->peak)
+            lane->peak = lane->mq->entry;
+    }
+    else
+        lane->dropped ++;
+    rt_hw_interrupt_enable(level);
+
+    /* the token is released after the event is queued, so a receiver
+     * holding a token always finds an event */
+    if (result == RT_EOK)
+        rt_sem_release(&app->pending);
+
+    return result;
+}
+
+static rt_err_t _rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size, rt_bool_t urgent);
+
+/* move the button events held back by server into the input lane, in order */
+static void _rtgui_lane_flush_button(struct rtgui_app *app)
+{
+    rt_base_t level;
+    struct rtgui_event_mouse *event;
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        if (app->button_num == 0)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        /* server only appends behind it */
+        event = &app->button[app->button_head];
+        rt_hw_interrupt_enable(level);
+
+        /* it may not fit into a slot */
+        if (_rtgui_send(app, &(event->parent), sizeof(struct rtgui_event_mouse), RT_FALSE) != RT_EOK)
+            break;
+
+        /* the later buttons are held back until this one is queued */
+        level = rt_hw_interrupt_disable();
+        app->button_head = (app->button_head + 1) % GUIENGIN_INPUT_BUTTON_PENDING;
+        app->button_num --;
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+static rt_err_t _rtgui_lane_recv(struct rtgui_app* app, void *buffer,
+                                 rt_size_t size, rt_int32_t timeout)
+{
+    int index;
+    rt_err_t result;
+
+    result = rt_sem_take(&app->pending, timeout);
+    if (result != RT_EOK)
+        return result;
+
+    for (index = 0; index < RTGUI_EVENT_LANE_MAX; index ++)
+    {
+        if (rt_mq_recv(app->lane[index].mq, buffer, size, 0) == RT_EOK)
+        {
+#ifdef GUIENGIN_USING_TRACE
+            rtgui_trace_recv((rtgui_event_t *)buffer);
+#endif
+            /* there is room in the input lane now */
+            if (index == RTGUI_EVENT_LANE_INPUT && app->button_num != 0)
+                _rtgui_lane_flush_button(app);
+
+            return RT_EOK;
+        }
+    }
+
+    RT_ASSERT(0);
+    return -RT_ERROR;
+}
+
+/* queue a carrier of a pooled event, the reference of caller is taken over */
+static rt_err_t _rtgui_send_carrier(struct rtgui_app* app, rtgui_event_t *event, rt_bool_t urgent)
+{
+    rt_err_t result;
+    struct rtgui_event_ref carrier;
+
+    RTGUI_EVENT_REF_INIT(&carrier);
+    carrier.parent.sender = event->sender;
+    carrier.event = event;
+
+    result = _rtgui_lane_send(app, event->type, &(carrier.parent), sizeof(carrier), urgent);
+    if (result != RT_EOK)
+        rtgui_event_unref(event);
+
+    return result;
+}
+
+static rt_err_t _rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size, rt_bool_t urgent)
+{
+    if (event_size > GUIENGIN_EVENT_SLOT_SIZE)
+    {
+        event = _rtgui_event_dup(event, event_size);
+        if (event == RT_NULL)
+            return -RT_ENOMEM;
+
+        return _rtgui_send_carrier(app, event, urgent);
+    }
+
+    return _rtgui_lane_send(app, event->type, event, event_size, urgent);
+}
+
 rt_err_t rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size)
 {
     rt_err_t result;
@@ -631,7 +1280,7 @@ rt_err_t rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event
 
     rtgui_event_dump(app, event);
 
-    result = rt_mq_send(app->mq, event, event_size);
+    result = _rtgui_send(app, event, event_size, RT_FALSE);
     if (result != RT_EOK)
     {
         if (event->type != RTGUI_EVENT_TIMER)
@@ -652,7 +1301,7 @@ rt_err_t rtgui_send_urgent(struct rtgui_app* app, rtgui_event_t *event, rt_size_
 
     rtgui_event_dump(app, event);
 
-    result = rt_mq_urgent(app->mq, event, event_size);
+    result = _rtgui_send(app, event, event_size, RT_TRUE);
     if (result != RT_EOK)
         rt_kprintf("send ergent event to %s failed\n", app->name);
 
@@ -660,61 +1309,159 @@ rt_err_t rtgui_send_urgent(struct rtgui_app* app, rtgui_event_t *event, rt_size_
 }
 RTM_EXPORT(rtgui_send_urgent);
 
-rt_err_t rtgui_send_sync(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size)
+rt_err_t rtgui_send_ref(struct rtgui_app* app, rtgui_event_t *event)
+{
+    rt_err_t result;
+
+    RT_ASSERT(app != RT_NULL);
+    RT_ASSERT(event != RT_NULL);
+
+    rtgui_event_dump(app, event);
+
+    /* the queue holds its own reference until the event is received */
+    result = _rtgui_send_carrier(app, rtgui_event_ref(event), RT_FALSE);
+    if (result != RT_EOK)
+        rt_kprintf("send event to %s failed\n", app->name);
+
+    return result;
+}
+RTM_EXPORT(rtgui_send_ref);
+
+rt_err_t rtgui_send_async(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size,
+                          struct rtgui_future *future)
 {
     rt_err_t r;
-    rt_base_t ack_buffer, ack_status;
-    struct rt_mailbox ack_mb;
+    struct rtgui_app *self;
 
     RT_ASSERT(app != RT_NULL);
     RT_ASSERT(event != RT_NULL);
     RT_ASSERT(event_size != 0);
+    RT_ASSERT(future != RT_NULL);
 
     rtgui_event_dump(app, event);
 
-    /* init ack mailbox */
-    r = rt_mb_init(&ack_mb, "ack", &ack_buffer, 1, 0);
-    if (r != RT_EOK)
-        goto __return;
+    future->status = RTGUI_STATUS_ERROR;
+    future->done = 0;
 
-    event->ack = &ack_mb;
-    r = rt_mq_send(app->mq, event, event_size);
-    if (r != RT_EOK)
+    /* a gui thread waits all its futures on one event object */
+    self = (struct rtgui_app *)(rt_thread_self()->user_data);
+    if (self != RT_NULL)
+        future->notify = &self->ack;
+    else
     {
-        rt_kprintf("send sync event failed\n");
-        goto __return;
+        rt_event_init(&future->local, "ack", RT_IPC_FLAG_FIFO);
+        future->notify = &future->local;
     }
 
-    r = rt_mb_recv(&ack_mb, (rt_ubase_t *)&ack_status, RT_WAITING_FOREVER);
+    event->ack = future;
+    r = _rtgui_send(app, event, event_size, RT_FALSE);
     if (r != RT_EOK)
-        goto __return;
+    {
+        rt_kprintf("send async event failed\n");
 
-    if (ack_status != RTGUI_STATUS_OK)
-        r = -RT_ERROR;
-    else
-        r = RT_EOK;
+        if (future->notify == &future->local)
+            rt_event_detach(&future->local);
+        future->notify = RT_NULL;
+        future->done = 1;
+    }
 
-__return:
-    /* fini ack mailbox */
-    rt_mb_detach(&ack_mb);
     return r;
 }
+RTM_EXPORT(rtgui_send_async);
+
+rt_int32_t rtgui_future_wait(struct rtgui_future *future)
+{
+    rt_uint32_t recved;
+
+    RT_ASSERT(future != RT_NULL);
+
+    if (future->notify == &future->local)
+    {
+        /* nobody else touches the local one, wait until the receiver
+         * has done with it */
+        rt_event_recv(&future->local, RTGUI_FUTURE_DONE,
+                      RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                      RT_WAITING_FOREVER, &recved);
+        rt_event_detach(&future->local);
+        future->notify = RT_NULL;
+    }
+    else
+    {
+        /* the notification may be for another future of this thread */
+        while (!future->done)
+        {
+            rt_event_recv(future->notify, RTGUI_FUTURE_DONE,
+                          RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                          RT_WAITING_FOREVER, &recved);
+        }
+    }
+
+    return future->status;
+}
+RTM_EXPORT(rtgui_future_wait);
+
+rt_err_t rtgui_send_sync(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size)
+{
+    rt_err_t r;
+    struct rtgui_future future;
+
+    r = rtgui_send_async(app, event, event_size, &future);
+    if (r != RT_EOK)
+        return r;
+
+    if (rtgui_future_wait(&future) != RTGUI_STATUS_OK)
+        return -RT_ERROR;
+
+    return RT_EOK;
+}
 RTM_EXPORT(rtgui_send_sync);
 
 rt_err_t rtgui_ack(rtgui_event_t *event, rt_int32_t status)
 {
+    rt_base_t level;
+    rt_event_t notify;
+    struct rtgui_future *future;
+
     RT_ASSERT(event != RT_NULL);
     RT_ASSERT(event->ack != RT_NULL);
 
-    rt_mb_send(event->ack, status);
+    future = event->ack;
+
+    level = rt_hw_interrupt_disable();
+    notify = future->notify;
+    future->status = status;
+    future->done = 1;
+    rt_hw_interrupt_enable(level);
+
+    rt_event_send(notify, RTGUI_FUTURE_DONE);
 
     return RT_EOK;
 }
 RTM_EXPORT(rtgui_ack);
 
+/* take the latest position of a motion event coalesced by server */
+static void _rtgui_recv_motion(struct rtgui_app *app, rtgui_event_t *event)
+{
+    rt_base_t level;
+    struct rtgui_event_mouse *emouse;
+
+    if (event->type != RTGUI_EVENT_MOUSE_MOTION || !(event->user & RTGUI_MOUSE_COALESCED))
+        return;
+
+    emouse = (struct rtgui_event_mouse *)event;
+
+    level = rt_hw_interrupt_disable();
+    *emouse = app->motion;
+    app->motion_state = 0;
+    rt_hw_interrupt_enable(level);
+
+    event->user &= ~RTGUI_MOUSE_COALESCED;
+}
+
 rt_err_t rtgui_recv(rtgui_event_t *event, rt_size_t event_size, rt_int32_t timeout)
 {
     struct rtgui_app *app;
+    rtgui_event_t *pooled;
     rt_err_t r;
 
     RT_ASSERT(event != RT_NULL);
@@ -723,12 +1470,65 @@ rt_err_t rtgui_recv(rtgui_event_t *event, rt_size_t event_size, rt_int32_t timeo
     app = (struct rtgui_app *)(rt_thread_self()->user_data);
     if (app == RT_NULL) return -RT_ERROR;
 
-    r = rt_mq_recv(app->mq, event, event_size, timeout);
+    r = _rtgui_lane_recv(app, event, event_size, timeout);
+    if (r != RT_EOK)
+        return r;
+
+    if (event->type == RTGUI_EVENT_REF)
+    {
+        /* caller wants its own copy, unwrap the pooled event */
+        pooled = ((struct rtgui_event_ref *)event)->event;
+        if (event_size > _EVENT_OBJ(pooled)->size)
+            event_size = _EVENT_OBJ(pooled)->size;
+        rt_memcpy(event, pooled, event_size);
+        rtgui_event_unref(pooled);
+    }
+    _rtgui_recv_motion(app, event);
 
     return r;
 }
 RTM_EXPORT(rtgui_recv);
 
+rt_err_t rtgui_recv_ref(rtgui_event_t **event, rt_int32_t timeout)
+{
+    struct rtgui_app *app;
+    rtgui_event_t *e;
+    rt_err_t r;
+
+    RT_ASSERT(event != RT_NULL);
+
+    app = (struct rtgui_app *)(rt_thread_self()->user_data);
+    if (app == RT_NULL) return -RT_ERROR;
+
+    e = (rtgui_event_t *)&app->event_buffer[0];
+    r = _rtgui_lane_recv(app, e, sizeof(union rtgui_event_generic), timeout);
+    if (r != RT_EOK)
+        return r;
+
+    /* hand out the pooled event directly, no copy */
+    if (e->type == RTGUI_EVENT_REF)
+        e = ((struct rtgui_event_ref *)e)->event;
+    _rtgui_recv_motion(app, e);
+
+    *event = e;
+    return r;
+}
+RTM_EXPORT(rtgui_recv_ref);
+
+void rtgui_recv_done(rtgui_event_t *event)
+{
+    struct rtgui_app *app;
+
+    RT_ASSERT(event != RT_NULL);
+
+    app = (struct rtgui_app *)(rt_thread_self()->user_data);
+    if (app != RT_NULL && event == (rtgui_event_t *)&app->event_buffer[0])
+        return;
+
+    rtgui_event_unref(event);
+}
+RTM_EXPORT(rtgui_recv_done);
+
 rt_err_t rtgui_recv_filter(rt_uint32_t type, rtgui_event_t *event, rt_size_t event_size)
 {
     rtgui_event_t *e;
@@ -741,12 +1541,14 @@ rt_err_t rtgui_recv_filter(rt_uint32_t type, rtgui_event_t *event, rt_size_t eve
     if (app == RT_NULL)
         return -RT_ERROR;
 
-    e = (rtgui_event_t*)&app->event_buffer[0];
-    while (rt_mq_recv(app->mq, e, sizeof(union rtgui_event_generic), RT_WAITING_FOREVER) == RT_EOK)
+    while (rtgui_recv_ref(&e, RT_WAITING_FOREVER) == RT_EOK)
     {
         if (e->type == type)
         {
+            if (e != (rtgui_event_t *)&app->event_buffer[0] && event_size > _EVENT_OBJ(e)->size)
+                event_size = _EVENT_OBJ(e)->size;
             memcpy(event, e, event_size);
+            rtgui_recv_done(e);
             return RT_EOK;
         }
         else
@@ -756,6 +1558,7 @@ rt_err_t rtgui_recv_filter(rt_uint32_t type, rtgui_event_t *event, rt_size_t eve
                 RTGUI_OBJECT(app)->event_handler(RTGUI_OBJECT(app), e);
             }
         }
+        rtgui_recv_done(e);
     }
 
     return -RT_ERROR;
@@ -22,6 +22,7 @@
  * 2009-10-04     Bernard      first version
  */
 
+#include <rthw.h>
 #include <rtgui/rtgui.h>
 #include <rtgui/event.h>
 #include <rtgui/rtgui_system.h>
@@ -74,12 +75,239 @@ void rtgui_server_handle_monitor_remove(struct rtgui_event_monitor *event)
     rtgui_topwin_remove_monitor_rect(event->wid, &(event->rect));
 }
 
+/*
+ * The motion events are coalesced in app: only one coalesced motion event is
+ * queued, and the later motions on the same window just update the position
+ * in app->motion until the app receives the event. A button event seals the
+ * pending motion, so the motions after the button are not merged into the one
+ * before it, and they are sent by value until the pending one is received.
+ */
+static void _rtgui_server_send_motion(struct rtgui_app *app, struct rtgui_event_mouse *event)
+{
+    rt_base_t level;
+
+    /* it can't overtake the buttons held back, the position comes with the
+     * next motion or button */
+    if (app->button_num != 0)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    if (app->motion_state == RTGUI_MOUSE_MOTION_PENDING && app->motion.wid == event->wid)
+    {
+        /* replace the pending one with the latest position */
+        app->motion = *event;
+        app->motion.parent.user = RTGUI_MOUSE_COALESCED;
+        rt_hw_interrupt_enable(level);
+
+        return;
+    }
+    if (app->motion_state != 0)
+    {
+        /* it can't be merged into the pending one any more */
+        app->motion_state |= RTGUI_MOUSE_MOTION_SEALED;
+        rt_hw_interrupt_enable(level);
+
+        rtgui_send_ref(app, &(event->parent));
+        return;
+    }
+
+    event->parent.user = RTGUI_MOUSE_COALESCED;
+    app->motion = *event;
+    app->motion_state = RTGUI_MOUSE_MOTION_PENDING;
+    rt_hw_interrupt_enable(level);
+
+    if (rtgui_send_ref(app, &(event->parent)) != RT_EOK)
+    {
+        /* nothing is pending in the queue */
+        level = rt_hw_interrupt_disable();
+        app->motion_state = 0;
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+static void _rtgui_server_seal_motion(struct rtgui_app *app)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (app->motion_state != 0)
+        app->motion_state |= RTGUI_MOUSE_MOTION_SEALED;
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * The button events are never dropped, a lost release leaves a press or drag
+ * stuck in the client. If the input lane of app is full, they are held back
+ * in app->button and the app moves them into the lane in order as it takes
+ * the input events, the later buttons and motions of the app wait behind
+ * them. A slot is reserved for the release of each button held down, so a
+ * press is only dropped when there is no room left, and then its release is
+ * dropped too.
+ */
+static rt_uint16_t _input_button_held, _input_button_dropped;
+
+rt_inline rt_uint16_t _rtgui_button_bit(struct rtgui_event_mouse *event)
+{
+    return (rt_uint16_t)(1 << (event->button & 0x0f));
+}
+
+static int _rtgui_button_held_num(void)
+{
+    int num = 0;
+    rt_uint16_t held;
+
+    for (held = _input_button_held; held != 0; held &= held - 1)
+        num ++;
+
+    return num;
+}
+
+static void _rtgui_server_send_button(struct rtgui_app *app, struct rtgui_event_mouse *event)
+{
+    int need, num;
+    rt_base_t level;
+    rt_uint16_t bit;
+
+    bit = _rtgui_button_bit(event);
+    need = 1;
+    if (event->button & RTGUI_MOUSE_BUTTON_UP)
+    {
+        if (_input_button_dropped & bit)
+        {
+            _input_button_dropped &= ~bit;
+            return;
+        }
+        /* takes the slot reserved for it */
+        _input_button_held &= ~bit;
+    }
+    else if (event->button & RTGUI_MOUSE_BUTTON_DOWN)
+    {
+        /* and the one for its release */
+        need = 2;
+    }
+
+    /* the app only takes the held back ones out, it's safe to check */
+    num = app->button_num;
+    if (num == 0 && rtgui_send_ref(app, &(event->parent)) == RT_EOK)
+    {
+        if (event->button & RTGUI_MOUSE_BUTTON_DOWN)
+            _input_button_held |= bit;
+        return;
+    }
+
+    if (num + _rtgui_button_held_num() + need > GUIENGIN_INPUT_BUTTON_PENDING)
+    {
+        rt_kprintf("GUI: app %s is not responding, button 0x%x dropped\n",
+                   (const char *)app->name, event->button);
+        if (event->button & RTGUI_MOUSE_BUTTON_DOWN)
+            _input_button_dropped |= bit;
+        return;
+    }
+    if (event->button & RTGUI_MOUSE_BUTTON_DOWN)
+        _input_button_held |= bit;
+
+    level = rt_hw_interrupt_disable();
+    app->button[(app->button_head + app->button_num) % GUIENGIN_INPUT_BUTTON_PENDING] = *event;
+    app->button_num ++;
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * The server works in two stages. The input stage, in a thread of its own,
+ * routes the input events to the apps by the input map published by the
+ * window tree, and moves the cursor without waiting for the clients drawing.
+ * The server thread manages the windows and updates the screen. The requests
+ * of input stage to the tree, which is to activate the clicked window, are
+ * passed through a single producer single consumer ring, so a slow clip or
+ * screen update never holds the pointer.
+ */
+static rt_mq_t _input_mq = RT_NULL;
+
+union rtgui_input_event
+{
+    struct rtgui_event parent;
+    struct rtgui_event_mouse mouse;
+    struct rtgui_event_kbd kbd;
+    struct rtgui_event_touch touch;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define _input_barrier()    __sync_synchronize()
+#else
+/* volatile is enough on single core */
+#define _input_barrier()
+#endif
+
+#define INPUT_PIPE_MASK     (GUIENGIN_INPUT_PIPE_SIZE - 1)
+
+/* the windows to activate, written by the input stage only */
+static struct rtgui_win *volatile _input_pipe[GUIENGIN_INPUT_PIPE_SIZE];
+static volatile rt_uint16_t _input_pipe_head, _input_pipe_tail;
+/* the server is notified of the requests, only once until it drains them */
+static volatile rt_uint8_t _input_pipe_doorbell;
+
+static void _rtgui_input_request_activate(struct rtgui_win *wid)
+{
+    rt_uint16_t head;
+    struct rtgui_event event;
+
+    head = _input_pipe_head;
+    /* the click is still routed, just the window is not raised */
+    if ((rt_uint16_t)(head - _input_pipe_tail) == GUIENGIN_INPUT_PIPE_SIZE)
+        return;
+
+    _input_pipe[head & INPUT_PIPE_MASK] = wid;
+    _input_barrier();
+    _input_pipe_head = head + 1;
+    _input_barrier();
+
+    if (_input_pipe_doorbell == 0)
+    {
+        _input_pipe_doorbell = 1;
+
+        event.type = RTGUI_EVENT_INPUT_REQUEST;
+        event.user = 0;
+        event.sender = RT_NULL;
+        event.ack = RT_NULL;
+        /* the server drains the ring on every event anyway */
+        if (rtgui_send(rtgui_server_app, &event, sizeof(event)) != RT_EOK)
+            _input_pipe_doorbell = 0;
+    }
+}
+
+static void _rtgui_server_drain_input(void)
+{
+    rt_uint16_t tail;
+    struct rtgui_event_win_activate eact;
+
+    /* the requests after this are rung again */
+    _input_pipe_doorbell = 0;
+    _input_barrier();
+
+    tail = _input_pipe_tail;
+    while (tail != _input_pipe_head)
+    {
+        _input_barrier();
+        eact.wid = _input_pipe[tail & INPUT_PIPE_MASK];
+        _input_barrier();
+        _input_pipe_tail = ++ tail;
+
+        /* the window may be gone already */
+        rtgui_topwin_activate(&eact);
+    }
+}
+
 void rtgui_server_handle_mouse_btn(struct rtgui_event_mouse *event)
 {
-    struct rtgui_topwin *wnd;
+    struct rtgui_input_map *map;
+    struct rtgui_input_target *target;
 
-    /* re-init to server thread */
+    /* re-init on behalf of server */
     RTGUI_EVENT_MOUSE_BUTTON_INIT(event);
+    event->parent.sender = rtgui_server_app;
+
+    /* the cursor is shared with the server and the clients */
+    rtgui_mouse_lock();
 
     /* set cursor position */
     rtgui_mouse_set_position(event->x, event->y);
@@ -97,10 +325,13 @@ void rtgui_server_handle_mouse_btn(struct rtgui_event_mouse *event)
 
             /* move window */
             RTGUI_EVENT_WIN_MOVE_INIT(&ewin);
+            ewin.parent.sender = rtgui_server_app;
             ewin.wid = win;
             ewin.x = rect.x1;
             ewin.y = rect.y1;
 
+            rtgui_mouse_unlock();
+
             /* send to client thread */
             rtgui_send(win->app, &(ewin.parent), sizeof(ewin));
 
@@ -109,83 +340,99 @@ void rtgui_server_handle_mouse_btn(struct rtgui_event_mouse *event)
     }
 #endif
 
+    rtgui_mouse_unlock();
+
+    map = rtgui_input_map_get();
+
     /* get the wnd which contains the mouse */
-    wnd = rtgui_topwin_get_wnd_no_modaled(event->x, event->y);
-    if (wnd == RT_NULL)
+    target = rtgui_input_map_hit(map, event->x, event->y);
+    if (target == RT_NULL)
+    {
+        rtgui_input_map_put(map);
         return;
+    }
 
-    event->wid = wnd->wid;
-    event->win_acti_cnt = rtgui_app_get_win_acti_cnt();
+    event->wid = target->wid;
+    event->win_acti_cnt = target->app->win_acti_cnt;
 
     /* only raise window if the button is pressed down */
-    if (event->button & RTGUI_MOUSE_BUTTON_DOWN &&
-            rtgui_topwin_get_focus() != wnd)
+    if (event->button & RTGUI_MOUSE_BUTTON_DOWN && map->focus != target->wid)
     {
-        rtgui_topwin_activate_topwin(wnd);
+        _rtgui_input_request_activate(target->wid);
     }
 
-    /* send mouse event to thread */
-    while (rtgui_send(wnd->app, (struct rtgui_event *)event, sizeof(struct rtgui_event_mouse)) != RT_EOK)
-    {
-        rt_thread_delay(RT_TICK_PER_SECOND / 50);
-    }
+    /* the motions after this button should be queued after it */
+    _rtgui_server_seal_motion(target->app);
+
+    /* send mouse event to thread, held back if the app is too busy */
+    _rtgui_server_send_button(target->app, event);
+
+    rtgui_input_map_put(map);
 }
 
 void rtgui_server_handle_mouse_motion(struct rtgui_event_mouse *event)
 {
-    /* the topwin contains current mouse */
-    struct rtgui_topwin *win    = RT_NULL;
+    struct rtgui_input_map *map;
+    /* the window contains current mouse */
+    struct rtgui_input_target *target;
 
     /* re-init mouse event */
     RTGUI_EVENT_MOUSE_MOTION_INIT(event);
+    event->parent.sender = rtgui_server_app;
 
-    win = rtgui_topwin_get_wnd_no_modaled(event->x, event->y);
-    if (win != RT_NULL && win->monitor_list.next != RT_NULL)
+    map = rtgui_input_map_get();
+
+    target = rtgui_input_map_hit(map, event->x, event->y);
+    if (target != RT_NULL && target->monitor_num != 0)
     {
-        // FIXME:
+        int index;
+
         /* check whether the monitor exist */
-        if (rtgui_mouse_monitor_contains_point(&(win->monitor_list),
-                                               event->x, event->y) != RT_TRUE)
+        for (index = 0; index < target->monitor_num; index ++)
         {
-            win = RT_NULL;
+            if (rtgui_rect_contains_point(&(target->monitor[index]),
+                                          event->x, event->y) == RT_EOK)
+                break;
         }
+        if (index == target->monitor_num)
+            target = RT_NULL;
     }
 
-    if (win)
+    if (target)
     {
-        event->wid = win->wid;
-        event->win_acti_cnt = rtgui_app_get_win_acti_cnt();
-		
-        rtgui_send(win->wid->app, &(event->parent), sizeof(*event));
+        event->wid = target->wid;
+        event->win_acti_cnt = target->app->win_acti_cnt;
+
+        _rtgui_server_send_motion(target->app, event);
     }
 
+    rtgui_input_map_put(map);
+
     /* move mouse to (x, y) */
-    rtgui_mouse_moveto(event->x, event->y);
+    rtgui_mouse_moveto_nowait(event->x, event->y);
 }
 
 void rtgui_server_handle_kbd(struct rtgui_event_kbd *event)
 {
-    struct rtgui_topwin *wnd;
+    struct rtgui_input_map *map;
 
-    /* re-init to server thread */
+    /* re-init on behalf of server */
     RTGUI_EVENT_KBD_INIT(event);
+    event->parent.sender = rtgui_server_app;
 
     /* todo: handle input method and global shortcut */
 
-    wnd = rtgui_topwin_get_focus();
-    if (wnd != RT_NULL)
+    map = rtgui_input_map_get();
+    if (map != RT_NULL && map->focus != RT_NULL)
     {
-        RT_ASSERT(wnd->flag & WINTITLE_ACTIVATE)
-
         /* send to focus window */
-        event->wid = wnd->wid;
-        event->win_acti_cnt = rtgui_app_get_win_acti_cnt();
+        event->wid = map->focus;
+        event->win_acti_cnt = map->focus_app->win_acti_cnt;
 
         /* send keyboard event to thread */
-        rtgui_send(wnd->app, (struct rtgui_event *)event, sizeof(struct rtgui_event_kbd));
-
-        return;
+        rtgui_send_ref(map->focus_app, &(event->parent));
     }
+    rtgui_input_map_put(map);
 }
 
 void rtgui_server_handle_touch(struct rtgui_event_touch *event)
@@ -220,11 +467,127 @@ void rtgui_server_handle_touch(struct rtgui_event_touch *event)
 //  }
 }
 
+static rt_size_t _rtgui_input_size(rt_uint32_t type)
+{
+    switch (type)
+    {
+    case RTGUI_EVENT_MOUSE_MOTION:
+    case RTGUI_EVENT_MOUSE_BUTTON:
+        return sizeof(struct rtgui_event_mouse);
+    case RTGUI_EVENT_KBD:
+        return sizeof(struct rtgui_event_kbd);
+    case RTGUI_EVENT_TOUCH:
+        return sizeof(struct rtgui_event_touch);
+    default:
+        return 0;
+    }
+}
+
+static rt_err_t _rtgui_input_post(struct rtgui_event *event)
+{
+    return rt_mq_send(_input_mq, event, _rtgui_input_size(event->type));
+}
+
+/**
+ * rtgui input stage thread's entry
+ *
+ * The input events don't fit into a queue slot of app. They are received
+ * into a pooled event, which is passed to the app by reference rather than
+ * copied into the pool again.
+ */
+static void rtgui_input_entry(void *parameter)
+{
+    union rtgui_input_event *event;
+
+    while (1)
+    {
+        event = (union rtgui_input_event *)rtgui_event_alloc(RTGUI_EVENT_MOUSE_MOTION,
+                sizeof(union rtgui_input_event));
+        if (event == RT_NULL)
+        {
+            /* leave the events in queue until there is memory */
+            rt_thread_delay(1);
+            continue;
+        }
+
+        if (rt_mq_recv(_input_mq, event, sizeof(*event), RT_WAITING_FOREVER) != RT_EOK)
+        {
+            rtgui_event_unref(&(event->parent));
+            continue;
+        }
+
+        switch (event->parent.type)
+        {
+        case RTGUI_EVENT_MOUSE_MOTION:
+            rtgui_server_handle_mouse_motion(&event->mouse);
+            break;
+
+        case RTGUI_EVENT_MOUSE_BUTTON:
+            rtgui_server_handle_mouse_btn(&event->mouse);
+            break;
+
+        case RTGUI_EVENT_TOUCH:
+            rtgui_server_handle_touch(&event->touch);
+            break;
+
+        case RTGUI_EVENT_KBD:
+            rtgui_server_handle_kbd(&event->kbd);
+            break;
+
+        default:
+            break;
+        }
+
+        rtgui_event_unref(&(event->parent));
+    }
+}
+
 #ifdef _WIN32_NATIVE
 #include <windows.h>
 #endif
 
-static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
+/*
+ * The window requests change the tree, which is published by the flush. The
+ * acks are held until the flush, so a client returning from rtgui_send_sync
+ * finds the new clip in clip_pending of its window and takes it before
+ * painting, see _rtgui_win_sync_clip.
+ */
+struct rtgui_server_ack
+{
+    struct rtgui_future *future;
+    rt_int32_t status;
+};
+static struct rtgui_server_ack _server_ack[GUIENGIN_SERVER_BATCH_MAX];
+static rt_uint16_t _server_ack_num = 0;
+
+static void _rtgui_server_flush(void)
+{
+    int index;
+    struct rtgui_event event;
+
+    rtgui_topwin_flush();
+
+    for (index = 0; index < _server_ack_num; index ++)
+    {
+        event.ack = _server_ack[index].future;
+        rtgui_ack(&event, _server_ack[index].status);
+    }
+    _server_ack_num = 0;
+}
+
+static void _rtgui_server_ack_later(struct rtgui_event *event, rt_err_t result)
+{
+    /* the batch is flushed before it's full, just in case */
+    if (_server_ack_num == GUIENGIN_SERVER_BATCH_MAX)
+        _rtgui_server_flush();
+
+    _server_ack[_server_ack_num].future = event->ack;
+    _server_ack[_server_ack_num].status = (result == RT_EOK) ?
+                                          RTGUI_STATUS_OK : RTGUI_STATUS_ERROR;
+    _server_ack_num ++;
+}
+
+static rt_bool_t _rtgui_server_dispatch(struct rtgui_object *object,
         struct rtgui_event *event)
 {
     RT_ASSERT(object != RT_NULL);
@@ -235,6 +598,10 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
     {
     case RTGUI_EVENT_APP_CREATE:
     case RTGUI_EVENT_APP_DESTROY:
+        /* the app is freed once acked, the input stage must be done with it */
+        if (event->type == RTGUI_EVENT_APP_DESTROY)
+            rtgui_input_map_sync();
+
         if (rtgui_wm_application != RT_NULL)
         {
             /* forward event to wm application */
@@ -247,25 +614,16 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
         }
         break;
 
-    /* mouse and keyboard event */
+    /* mouse and keyboard event sent to server directly */
     case RTGUI_EVENT_MOUSE_MOTION:
-        /* handle mouse motion event */
-        rtgui_server_handle_mouse_motion((struct rtgui_event_mouse *)event);
-        break;
-
     case RTGUI_EVENT_MOUSE_BUTTON:
-        /* handle mouse button */
-        rtgui_server_handle_mouse_btn((struct rtgui_event_mouse *)event);
-        break;
-
     case RTGUI_EVENT_TOUCH:
-        /* handle touch event */
-        rtgui_server_handle_touch((struct rtgui_event_touch *)event);
+    case RTGUI_EVENT_KBD:
+        _rtgui_input_post(event);
         break;
 
-    case RTGUI_EVENT_KBD:
-        /* handle keyboard event */
-        rtgui_server_handle_kbd((struct rtgui_event_kbd *)event);
+    case RTGUI_EVENT_INPUT_REQUEST:
+        /* drained below */
         break;
 
     /* window event */
@@ -278,46 +636,28 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
 
     case RTGUI_EVENT_WIN_SHOW:
         if (_show_win_hook) _show_win_hook();
-        if (rtgui_topwin_show((struct rtgui_event_win *)event) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_show((struct rtgui_event_win *)event));
         break;
 
     case RTGUI_EVENT_WIN_HIDE:
-        if (rtgui_topwin_hide((struct rtgui_event_win *)event) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_hide((struct rtgui_event_win *)event));
         break;
 
     case RTGUI_EVENT_WIN_MOVE:
-        if (rtgui_topwin_move((struct rtgui_event_win_move *)event) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_move((struct rtgui_event_win_move *)event));
         break;
 
     case RTGUI_EVENT_WIN_MODAL_ENTER:
-        if (rtgui_topwin_modal_enter((struct rtgui_event_win_modal_enter *)event) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_modal_enter((struct rtgui_event_win_modal_enter *)event));
         break;
 
     case RTGUI_EVENT_WIN_ACTIVATE:
         if (_act_win_hook) _act_win_hook();
-        if (rtgui_topwin_activate((struct rtgui_event_win_activate *)event) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_activate((struct rtgui_event_win_activate *)event));
         break;
 
     case RTGUI_EVENT_WIN_DESTROY:
-        if (rtgui_topwin_remove(((struct rtgui_event_win *)event)->wid) == RT_EOK)
-            rtgui_ack(event, RTGUI_STATUS_OK);
-        else
-            rtgui_ack(event, RTGUI_STATUS_ERROR);
+        _rtgui_server_ack_later(event, rtgui_topwin_remove(((struct rtgui_event_win *)event)->wid));
         break;
 
     case RTGUI_EVENT_WIN_RESIZE:
@@ -346,7 +686,7 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
 
     case RTGUI_EVENT_UPDATE_BEGIN:
 #ifdef RTGUI_USING_MOUSE_CURSOR
-        /* hide cursor */
+        /* hide cursor, the client drawing holds the cursor lock */
         rtgui_mouse_hide_cursor();
 #endif
         break;
@@ -373,11 +713,34 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
     return RT_TRUE;
 }
 
+static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
+        struct rtgui_event *event)
+{
+    rt_bool_t result;
+    static rt_uint16_t batch = 0;
+
+    result = _rtgui_server_dispatch(object, event);
+    _rtgui_server_drain_input();
+
+    /* publish the changes of the window tree once the queued requests are
+     * handled, or a flood of events would postpone it for too long */
+    if (!rtgui_app_has_pending(rtgui_server_app) ||
+            ++batch >= GUIENGIN_SERVER_BATCH_MAX)
+    {
+        batch = 0;
+        _rtgui_server_flush();
+    }
+
+    return result;
+}
+
 /**
  * rtgui server thread's entry
  */
 static void rtgui_server_entry(void *parameter)
 {
+    rt_thread_t tid;
+
 #ifdef _WIN32_NATIVE
     /* set the server thread to highest */
     HANDLE hCurrentThread = GetCurrentThread();
@@ -400,6 +763,15 @@ static void rtgui_server_entry(void *parameter)
     rtgui_mouse_show_cursor();
 #endif
 
+    /* the input stage routes the events queued since the server init */
+    tid = rt_thread_create("rtgui_in",
+                           rtgui_input_entry, RT_NULL,
+                           GUIENGIN_INPUT_THREAD_STACK_SIZE,
+                           GUIENGIN_INPUT_THREAD_PRIORITY,
+                           GUIENGINE_SVR_THREAD_TIMESLICE);
+    if (tid != RT_NULL)
+        rt_thread_startup(tid);
+
     rtgui_app_run(rtgui_server_app);
 
     rtgui_app_destroy(rtgui_server_app);
@@ -412,7 +784,11 @@ rt_err_t rtgui_server_post_event(struct rtgui_event *event, rt_size_t size)
 
     if (rtgui_server_app != RT_NULL)
     {
-        result = rtgui_send(rtgui_server_app, event, size);
+        /* the input events go to the input stage directly */
+        if (_rtgui_input_size(event->type) != 0)
+            result = _rtgui_input_post(event);
+        else
+            result = rtgui_send(rtgui_server_app, event, size);
     }
     else
     {
@@ -434,6 +810,21 @@ rt_err_t rtgui_server_post_event_sync(struct rtgui_event *event, rt_size_t size)
     }
 }
 
+rt_err_t rtgui_server_post_event_async(struct rtgui_event *event, rt_size_t size,
+                                       struct rtgui_future *future)
+{
+    if (rtgui_server_app != RT_NULL)
+        return rtgui_send_async(rtgui_server_app, event, size, future);
+    else
+    {
+        rt_kprintf("post when server is not running\n");
+        future->status = RTGUI_STATUS_ERROR;
+        future->done = 1;
+        future->notify = RT_NULL;
+        return -RT_ENOSYS;
+    }
+}
+
 struct rtgui_app* rtgui_get_server(void)
 {
     return rtgui_server_app;
@@ -444,6 +835,14 @@ void rtgui_server_init(void)
 {
     rt_thread_t tid;
 
+    _input_mq = rt_mq_create("rtgui_in", sizeof(union rtgui_input_event),
+                             GUIENGIN_INPUT_QUEUE_DEPTH, RT_IPC_FLAG_FIFO);
+    if (_input_mq == RT_NULL)
+    {
+        rt_kprintf("Create GUI input queue failed.\n");
+        return;
+    }
+
     tid = rt_thread_create("rtgui",
                            rtgui_server_entry, RT_NULL,
                            GUIENGIN_SVR_THREAD_STACK_SIZE,
@@ -0,0 +1,247 @@
+/*
+ * File      : shape_cache.c
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+#include <rtgui/color.h>
+#include <rtgui/rtgui_system.h>
+#include <rtgui/shape_cache.h>
+
+/*
+ * ShapeCache keeps the rendered result of the shapes which are expensive to
+ * rasterize (round corners, anti-aliased circles etc), so the widgets which
+ * paint the same shape on every frame only need a blit.
+ *
+ * The sprites are ARGB888 buffer dc, the pixels outside of shape are
+ * transparent. The cache is a LRU list under a memory budget; the items
+ * referred by rtgui_shape_cache_get are never evicted until they are put.
+ */
+
+#ifdef GUIENGIN_USING_SHAPE_CACHE
+
+static rt_list_t _shape_list = RT_LIST_OBJECT_INIT(_shape_list);
+static struct rt_mutex _shape_lock;
+static struct rtgui_shape_cache_stat _shape_stat;
+
+void rtgui_system_shape_cache_init(void)
+{
+    rt_mutex_init(&_shape_lock, "shape", RT_IPC_FLAG_FIFO);
+
+    _shape_stat.budget = GUIENGIN_SHAPE_CACHE_SIZE;
+}
+
+rt_bool_t rtgui_shape_cache_check(struct rtgui_dc *dc)
+{
+    struct rtgui_graphic_driver *hw_driver;
+
+    if (dc == RT_NULL || _shape_stat.budget == 0)
+        return RT_FALSE;
+
+    /* the pixel alpha blit is only available on these formats */
+    switch (rtgui_dc_get_pixel_format(dc))
+    {
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+    case RTGRAPHIC_PIXEL_FORMAT_RGB888:
+    case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
+        break;
+    default:
+        return RT_FALSE;
+    }
+
+    /* the line blit of pixel device loses the alpha channel */
+    hw_driver = rtgui_graphic_driver_get_default();
+    if (dc->type != RTGUI_DC_BUFFER && hw_driver->framebuffer == RT_NULL)
+        return RT_FALSE;
+
+    return RT_TRUE;
+}
+RTM_EXPORT(rtgui_shape_cache_check);
+
+rt_inline rt_bool_t _shape_key_equal(const struct rtgui_shape_key *a,
+                                     const struct rtgui_shape_key *b)
+{
+    return (a->type == b->type &&
+            a->pixel_format == b->pixel_format &&
+            a->radius == b->radius &&
+            a->width == b->width &&
+            a->height == b->height &&
+            a->fc == b->fc);
+}
+
+static void _shape_item_destroy(struct rtgui_shape_item *item)
+{
+    rt_list_remove(&(item->list));
+
+    _shape_stat.used -= item->size;
+    _shape_stat.count --;
+
+    rtgui_dc_destory(item->sprite);
+    rtgui_free(item);
+}
+
+/* evict the least recently used items until @size bytes are used */
+static void _shape_cache_shrink(rt_uint32_t size)
+{
+    rt_list_t *node, *prev;
+    struct rtgui_shape_item *item;
+
+    for (node = _shape_list.prev; node != &_shape_list && _shape_stat.used > size; node = prev)
+    {
+        prev = node->prev;
+
+        item = rt_list_entry(node, struct rtgui_shape_item, list);
+        if (item->refcount == 0)
+        {
+            _shape_item_destroy(item);
+            _shape_stat.evict ++;
+        }
+    }
+}
+
+struct rtgui_shape_item *rtgui_shape_cache_get(const struct rtgui_shape_key *key,
+                                               rtgui_shape_render_t render)
+{
+    rt_list_t *node;
+    rt_uint32_t size;
+    struct rtgui_shape_item *item;
+
+    RT_ASSERT(key != RT_NULL);
+    RT_ASSERT(render != RT_NULL);
+
+    if (key->width == 0 || key->height == 0)
+        return RT_NULL;
+
+    rt_mutex_take(&_shape_lock, RT_WAITING_FOREVER);
+
+    for (node = _shape_list.next; node != &_shape_list; node = node->next)
+    {
+        item = rt_list_entry(node, struct rtgui_shape_item, list);
+        if (_shape_key_equal(&(item->key), key))
+        {
+            /* move to the head of LRU list */
+            rt_list_remove(&(item->list));
+            rt_list_insert_after(&_shape_list, &(item->list));
+
+            item->refcount ++;
+            _shape_stat.hit ++;
+
+            rt_mutex_release(&_shape_lock);
+            return item;
+        }
+    }
+    _shape_stat.miss ++;
+
+    /* a single sprite should not take more than the half of budget */
+    size = key->width * key->height * rtgui_color_get_bpp(RTGRAPHIC_PIXEL_FORMAT_ARGB888)
+           + sizeof(struct rtgui_dc_buffer) + sizeof(struct rtgui_shape_item);
+    if (size > _shape_stat.budget / 2)
+        goto __exit;
+
+    _shape_cache_shrink(_shape_stat.budget - size);
+    if (_shape_stat.used + size > _shape_stat.budget)
+        goto __exit;
+
+    item = (struct rtgui_shape_item *) rtgui_malloc(sizeof(struct rtgui_shape_item));
+    if (item == RT_NULL)
+        goto __exit;
+
+    item->sprite = rtgui_dc_buffer_create_pixformat(RTGRAPHIC_PIXEL_FORMAT_ARGB888,
+                   key->width, key->height);
+    if (item->sprite == RT_NULL)
+    {
+        rtgui_free(item);
+        goto __exit;
+    }
+    item->key = *key;
+    item->size = size;
+    item->refcount = 1;
+
+    /* the sprite is transparent after creation */
+    render(item->sprite, key);
+
+    rt_list_insert_after(&_shape_list, &(item->list));
+    _shape_stat.used += size;
+    _shape_stat.count ++;
+
+    rt_mutex_release(&_shape_lock);
+    return item;
+
+__exit:
+    rt_mutex_release(&_shape_lock);
+    return RT_NULL;
+}
+RTM_EXPORT(rtgui_shape_cache_get);
+
+void rtgui_shape_cache_put(struct rtgui_shape_item *item)
+{
+    RT_ASSERT(item != RT_NULL);
+
+    rt_mutex_take(&_shape_lock, RT_WAITING_FOREVER);
+    RT_ASSERT(item->refcount > 0);
+    item->refcount --;
+    /* the budget may be reduced while the item is in using */
+    if (item->refcount == 0 && _shape_stat.used > _shape_stat.budget)
+        _shape_cache_shrink(_shape_stat.budget);
+    rt_mutex_release(&_shape_lock);
+}
+RTM_EXPORT(rtgui_shape_cache_put);
+
+void rtgui_shape_cache_set_budget(rt_uint32_t budget)
+{
+    rt_mutex_take(&_shape_lock, RT_WAITING_FOREVER);
+    _shape_stat.budget = budget;
+    _shape_cache_shrink(budget);
+    rt_mutex_release(&_shape_lock);
+}
+RTM_EXPORT(rtgui_shape_cache_set_budget);
+
+void rtgui_shape_cache_flush(void)
+{
+    rt_mutex_take(&_shape_lock, RT_WAITING_FOREVER);
+    _shape_cache_shrink(0);
+    rt_mutex_release(&_shape_lock);
+}
+RTM_EXPORT(rtgui_shape_cache_flush);
+
+void rtgui_shape_cache_get_stat(struct rtgui_shape_cache_stat *stat)
+{
+    RT_ASSERT(stat != RT_NULL);
+
+    rt_mutex_take(&_shape_lock, RT_WAITING_FOREVER);
+    *stat = _shape_stat;
+    rt_mutex_release(&_shape_lock);
+}
+RTM_EXPORT(rtgui_shape_cache_get_stat);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_shape(void)
+{
+    struct rtgui_shape_cache_stat stat;
+
+    rtgui_shape_cache_get_stat(&stat);
+    rt_kprintf("shape cache: %d items, used %d/%d bytes\n", stat.count, stat.used, stat.budget);
+    rt_kprintf("hit: %d, miss: %d, evict: %d\n", stat.hit, stat.miss, stat.evict);
+}
+FINSH_FUNCTION_EXPORT(list_shape, display shape cache information);
+#endif
+
+#endif
@@ -22,6 +22,7 @@
  * 2009-10-16     Bernard      first version
  * 2012-02-25     Grissiom     rewrite topwin implementation
  */
+#include <rthw.h>
 #include <rtgui/widgets/topwin.h>
 #include <rtgui/widgets/mouse.h>
 
@@ -66,9 +67,34 @@ static rt_list_t _rtgui_topwin_list = RT_LIST_OBJECT_INIT(_rtgui_topwin_list);
 static struct rt_semaphore _rtgui_topwin_lock;
 
 static void rtgui_topwin_update_clip(void);
-static void rtgui_topwin_redraw(struct rtgui_rect *rect);
+static void rtgui_topwin_redraw(void);
 static void _rtgui_topwin_activate_next(enum rtgui_topwin_flag);
 
+/*
+ * The changes of the tree are not published right away. They are marked
+ * here and rtgui_topwin_flush publishes them once, after the server has
+ * handled the queued requests.
+ */
+#define TOPWIN_DIRTY_CLIP       0x01
+#define TOPWIN_DIRTY_NOTIFY     0x02
+#define TOPWIN_DIRTY_INPUT      0x04
+static rt_uint8_t _rtgui_topwin_dirty;
+
+/* the hit testing is changed, so is the input map */
+rt_inline void _rtgui_topwin_hit_reset(void)
+{
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_INPUT;
+}
+
+static struct rtgui_input_map *_rtgui_input_map_publish(void);
+static void _rtgui_input_map_unref(struct rtgui_input_map *map);
+
+rt_inline void _rtgui_topwin_invalidate_clip(void)
+{
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_CLIP;
+    _rtgui_topwin_hit_reset();
+}
+
 void rtgui_topwin_init(void)
 {
     /* initialize semaphore */
@@ -148,6 +174,9 @@ rt_err_t rtgui_topwin_add(struct rtgui_event_win_create *event)
 
     topwin->title = RT_NULL;
 
+    topwin->clip = RT_NULL;
+    rtgui_region_init(&topwin->damage);
+
     rtgui_list_init(&topwin->monitor_list);
 
     return RT_EOK;
@@ -285,19 +314,6 @@ static rt_bool_t _rtgui_topwin_could_show(struct rtgui_topwin *topwin)
     return RT_TRUE;
 }
 
-static void _rtgui_topwin_union_region_tree(struct rtgui_topwin *topwin,
-        struct rtgui_region *region)
-{
-    struct rt_list_node *node;
-
-    RT_ASSERT(topwin != RT_NULL);
-
-    rt_list_foreach(node, &topwin->child_list, next)
-    _rtgui_topwin_union_region_tree(get_topwin_from_list(node), region);
-
-    rtgui_region_union_rect(region, region, &topwin->extent);
-}
-
 /* The return value of this function is the next node in tree.
  *
  * As we freed the node in this function, it would be a null reference error of
@@ -326,6 +342,9 @@ static struct rt_list_node *_rtgui_topwin_free_tree(struct rtgui_topwin *topwin)
         rtgui_free(monitor);
     }
 
+    rtgui_region_snapshot_unref(topwin->clip);
+    rtgui_region_fini(&topwin->damage);
+
     rtgui_free(topwin);
     return next_node;
 }
@@ -333,14 +352,14 @@ static struct rt_list_node *_rtgui_topwin_free_tree(struct rtgui_topwin *topwin)
 rt_err_t rtgui_topwin_remove(struct rtgui_win *wid)
 {
     struct rtgui_topwin *topwin, *old_focus;
-    struct rtgui_region region;
 
     /* find the topwin node */
     topwin = rtgui_topwin_search_in_list(wid, &_rtgui_topwin_list);
 
     if (topwin == RT_NULL) return -RT_ERROR;
 
-    rtgui_region_init(&region);
+    /* the tree is going to be freed */
+    _rtgui_topwin_hit_reset();
 
     old_focus = rtgui_topwin_get_focus();
 
@@ -354,14 +373,14 @@ rt_err_t rtgui_topwin_remove(struct rtgui_win *wid)
     }
 
     if (topwin->flag & WINTITLE_SHOWN)
-    {
-        rtgui_topwin_update_clip();
-        /* redraw the old rect */
-        _rtgui_topwin_union_region_tree(topwin, &region);
-        rtgui_topwin_redraw(rtgui_region_extents(&region));
-    }
+        _rtgui_topwin_invalidate_clip();
+
+    /* no new input is routed to the windows, the input stage may still hold
+     * the old map, which is freed by the last holder. The events already
+     * sent are dropped by the app as the window is no longer valid, the app
+     * itself is kept until rtgui_input_map_sync. */
+    _rtgui_input_map_unref(_rtgui_input_map_publish());
 
-    rtgui_region_fini(&region);
     _rtgui_topwin_free_tree(topwin);
 
     return RT_EOK;
@@ -372,20 +391,14 @@ rt_err_t rtgui_topwin_remove(struct rtgui_win *wid)
  * already. */
 static void _rtgui_topwin_only_activate(struct rtgui_topwin *topwin)
 {
-    struct rtgui_event_win event;
-
     RT_ASSERT(topwin != RT_NULL);
 
     if (topwin->flag & WINTITLE_NOFOCUS)
         return;
 
-    /* activate the raised window */
-    RTGUI_EVENT_WIN_ACTIVATE_INIT(&event);
-
-    topwin->flag |= WINTITLE_ACTIVATE;
-
-    event.wid = topwin->wid;
-    rtgui_send(topwin->app, &(event.parent), sizeof(struct rtgui_event_win));
+    /* activate the raised window, it's notified after the clip */
+    topwin->flag |= WINTITLE_ACTIVATE | WINTITLE_NOTIFY;
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_NOTIFY;
 }
 
 /* activate next window in the same layer as flag. The flag has many other
@@ -405,17 +418,12 @@ static void _rtgui_topwin_activate_next(enum rtgui_topwin_flag flag)
  * tree has changed, make sure it has already updated outside. */
 static void _rtgui_topwin_deactivate(struct rtgui_topwin *topwin)
 {
-    struct rtgui_event_win event;
-
     RT_ASSERT(topwin != RT_NULL);
     RT_ASSERT(topwin->app != RT_NULL);
 
-    RTGUI_EVENT_WIN_DEACTIVATE_INIT(&event);
-    event.wid = topwin->wid;
-    rtgui_send(topwin->app,
-               &event.parent, sizeof(struct rtgui_event_win));
-
     topwin->flag &= ~WINTITLE_ACTIVATE;
+    topwin->flag |= WINTITLE_NOTIFY;
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_NOTIFY;
 }
 
 /* Return 1 on the tree is truely moved. If the tree is already in position,
@@ -525,7 +533,8 @@ rt_err_t rtgui_topwin_activate(struct rtgui_event_win_activate *event)
     return rtgui_topwin_activate_topwin(topwin);
 }
 
-static void _rtgui_topwin_draw_tree(struct rtgui_topwin *topwin, struct rtgui_event_paint *epaint)
+/* the tree is repainted as a whole after the clip is published */
+static void _rtgui_topwin_draw_tree(struct rtgui_topwin *topwin)
 {
     struct rt_list_node *node;
 
@@ -533,23 +542,19 @@ static void _rtgui_topwin_draw_tree(struct rtgui_topwin *topwin, struct rtgui_ev
     {
         if (!(get_topwin_from_list(node)->flag & WINTITLE_SHOWN))
             break;
-        _rtgui_topwin_draw_tree(get_topwin_from_list(node), epaint);
+        _rtgui_topwin_draw_tree(get_topwin_from_list(node));
     }
 
-    epaint->wid = topwin->wid;
-    rtgui_send(topwin->app, &(epaint->parent), sizeof(*epaint));
+    topwin->flag |= WINTITLE_REPAINT;
 }
 
 rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
 {
     int tpmoved;
     struct rtgui_topwin *old_focus_topwin;
-    struct rtgui_event_paint epaint;
 
     RT_ASSERT(topwin != RT_NULL);
 
-    RTGUI_EVENT_PAINT_INIT(&epaint);
-
     if (!(topwin->flag & WINTITLE_SHOWN))
         return -RT_ERROR;
 
@@ -560,12 +565,11 @@ rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
          * "raised" but not "activated".
          */
         tpmoved = _rtgui_topwin_raise_tree_from_root(topwin);
-        rtgui_topwin_update_clip();
+        _rtgui_topwin_invalidate_clip();
         if (tpmoved)
-            _rtgui_topwin_draw_tree(_rtgui_topwin_get_root_win(topwin),
-                                    &epaint);
+            _rtgui_topwin_draw_tree(_rtgui_topwin_get_root_win(topwin));
         else
-            _rtgui_topwin_draw_tree(topwin, &epaint);
+            _rtgui_topwin_draw_tree(topwin);
 
         return RT_EOK;
     }
@@ -579,8 +583,9 @@ rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
     RT_ASSERT(old_focus_topwin != topwin);
 
     tpmoved = _rtgui_topwin_raise_tree_from_root(topwin);
-    /* clip before active the window, so we could get right boarder region. */
-    rtgui_topwin_update_clip();
+    /* the clip is published before the activate state, so we could get
+     * right boarder region. */
+    _rtgui_topwin_invalidate_clip();
 
     if (old_focus_topwin != RT_NULL)
     {
@@ -592,10 +597,9 @@ rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
     _rtgui_topwin_only_activate(topwin);
 
     if (tpmoved)
-        _rtgui_topwin_draw_tree(_rtgui_topwin_get_root_win(topwin),
-                                &epaint);
+        _rtgui_topwin_draw_tree(_rtgui_topwin_get_root_win(topwin));
     else
-        _rtgui_topwin_draw_tree(topwin, &epaint);
+        _rtgui_topwin_draw_tree(topwin);
 
     return RT_EOK;
 }
@@ -620,7 +624,7 @@ rt_inline void _rtgui_topwin_preorder_map(struct rtgui_topwin *topwin, void (*fu
 
 rt_inline void _rtgui_topwin_mark_hidden(struct rtgui_topwin *topwin)
 {
-    topwin->flag &= ~WINTITLE_SHOWN;
+    topwin->flag &= ~(WINTITLE_SHOWN | WINTITLE_REPAINT | WINTITLE_MOVED);
     RTGUI_WIDGET_HIDE(topwin->wid);
 }
 
@@ -666,6 +670,8 @@ static void _rtgui_topwin_clear_modal_tree(struct rtgui_topwin *topwin)
     RT_ASSERT(topwin != RT_NULL);
     RT_ASSERT(topwin->parent != RT_NULL);
 
+    _rtgui_topwin_hit_reset();
+
     while (!IS_ROOT_WIN(topwin))
     {
         rt_list_foreach(node, &topwin->parent->child_list, next)
@@ -721,7 +727,7 @@ rt_err_t rtgui_topwin_hide(struct rtgui_event_win *event)
     rt_list_insert_before(containing_list, &topwin->list);
 
     /* update clip info */
-    rtgui_topwin_update_clip();
+    _rtgui_topwin_invalidate_clip();
 
     if (topwin->flag & WINTITLE_MODALING)
     {
@@ -736,9 +742,6 @@ rt_err_t rtgui_topwin_hide(struct rtgui_event_win *event)
 
     topwin->flag &= ~WINTITLE_ACTIVATE;
 
-    /* redraw the old rect */
-    rtgui_topwin_redraw(&(topwin->extent));
-
     return RT_EOK;
 }
 
@@ -776,10 +779,11 @@ rt_err_t rtgui_topwin_move(struct rtgui_event_win_move *event)
     }
 
     /* update windows clip info */
-    rtgui_topwin_update_clip();
+    _rtgui_topwin_invalidate_clip();
 
-    /* update old window coverage area */
-    rtgui_topwin_redraw(&old_rect);
+    /* the moved window repaints itself when it's shown again, only the
+     * windows beneath repaint the area uncovered by it */
+    topwin->flag |= WINTITLE_MOVED;
 
     if (rtgui_rect_is_intersect(&old_rect, &(topwin->extent)) != RT_EOK)
     {
@@ -787,11 +791,7 @@ rt_err_t rtgui_topwin_move(struct rtgui_event_win_move *event)
          * the old rect is not intersect with moved rect,
          * re-paint window
          */
-        struct rtgui_event_paint epaint;
-        RTGUI_EVENT_PAINT_INIT(&epaint);
-        epaint.wid = topwin->wid;
-
-        rtgui_send(topwin->app, &(epaint.parent), sizeof(epaint));
+        topwin->flag |= WINTITLE_REPAINT;
     }
 
     return RT_EOK;
@@ -804,7 +804,6 @@ rt_err_t rtgui_topwin_move(struct rtgui_event_win_move *event)
 void rtgui_topwin_resize(struct rtgui_win *wid, rtgui_rect_t *rect)
 {
     struct rtgui_topwin *topwin;
-    struct rtgui_region region;
 
     /* find in show list */
     topwin = rtgui_topwin_search_in_list(wid, &_rtgui_topwin_list);
@@ -812,20 +811,11 @@ void rtgui_topwin_resize(struct rtgui_win *wid, rtgui_rect_t *rect)
             !(topwin->flag & WINTITLE_SHOWN))
         return;
 
-    /* record the old rect */
-    rtgui_region_init_with_extents(&region, &topwin->extent);
-    /* union the new rect so this is the region we should redraw */
-    rtgui_region_union_rect(&region, &region, rect);
-
     topwin->extent = *rect;
 
-    /* update windows clip info */
-    rtgui_topwin_update_clip();
-
-    /* update old window coverage area */
-    rtgui_topwin_redraw(rtgui_region_extents(&region));
-
-    rtgui_region_fini(&region);
+    /* update windows clip info, the uncovered area and the new area of
+     * the window are redrawn after it */
+    _rtgui_topwin_invalidate_clip();
 }
 
 static struct rtgui_topwin *_rtgui_topwin_get_focus_from_list(struct rt_list_node *list)
@@ -908,15 +898,60 @@ struct rtgui_topwin *rtgui_topwin_get_wnd_no_modaled(int x, int y)
     return _rtgui_topwin_get_wnd_from_tree(&_rtgui_topwin_list, x, y, RT_TRUE);
 }
 
-/* clip region from topwin, and the windows beneath it. */
-rt_inline void _rtgui_topwin_clip_to_region(struct rtgui_topwin *topwin,
+/* the version of the last published clip */
+static rt_uint32_t _rtgui_topwin_clip_version;
+
+/* clip region from topwin, and the windows beneath it. The client's own
+ * region is never touched here: a snapshot of the clip is published to the
+ * window, which adopts it in its own thread on the CLIP_INFO event. Return
+ * RT_FALSE if the clip is not changed and nothing is published. */
+rt_inline rt_bool_t _rtgui_topwin_clip_to_region(struct rtgui_topwin *topwin,
         struct rtgui_region *region)
 {
+    struct rtgui_region clip;
+    struct rtgui_region_snapshot *snapshot;
+
     RT_ASSERT(region != RT_NULL);
     RT_ASSERT(topwin != RT_NULL);
 
-    rtgui_region_reset(&topwin->wid->outer_clip, &topwin->wid->outer_extent);
-    rtgui_region_intersect(&topwin->wid->outer_clip, &topwin->wid->outer_clip, region);
+    rtgui_region_init_with_extents(&clip, &topwin->extent);
+    rtgui_region_intersect(&clip, &clip, region);
+
+    if (topwin->clip != RT_NULL &&
+            rtgui_region_is_equal(&clip, &topwin->clip->region) == RT_EOK)
+    {
+        rtgui_region_fini(&clip);
+        return RT_FALSE;
+    }
+
+    /* the area which is visible now but not in the last clip is damaged */
+    if (topwin->clip != RT_NULL)
+    {
+        struct rtgui_region exposed;
+
+        rtgui_region_init(&exposed);
+        rtgui_region_subtract(&exposed, &clip, &topwin->clip->region);
+        rtgui_region_union(&topwin->damage, &topwin->damage, &exposed);
+        rtgui_region_fini(&exposed);
+    }
+    else
+    {
+        rtgui_region_union(&topwin->damage, &topwin->damage, &clip);
+    }
+
+    snapshot = rtgui_region_snapshot_create(&clip, ++_rtgui_topwin_clip_version);
+    rtgui_region_fini(&clip);
+    if (snapshot == RT_NULL)
+        return RT_FALSE;
+
+    rtgui_region_snapshot_unref(topwin->clip);
+    topwin->clip = rtgui_region_snapshot_ref(snapshot);
+
+    /* the snapshot not adopted yet is out of date now, drop it */
+    snapshot = rtgui_region_snapshot_exchange(&topwin->wid->clip_pending, snapshot);
+    rtgui_region_snapshot_unref(snapshot);
+
+    return RT_TRUE;
 }
 
 static void rtgui_topwin_update_clip(void)
@@ -928,6 +963,8 @@ static void rtgui_topwin_update_clip(void)
      */
     struct rtgui_region region_available;
 
+    _rtgui_topwin_hit_reset();
+
     if (rt_list_isempty(&_rtgui_topwin_list) ||
             !(get_topwin_from_list(_rtgui_topwin_list.next)->flag & WINTITLE_SHOWN))
         return;
@@ -948,31 +985,99 @@ static void rtgui_topwin_update_clip(void)
 
     while (top != RT_NULL)
     {
-        /* clip the topwin */
-        _rtgui_topwin_clip_to_region(top, &region_available);
+        /* clip the topwin, only the changed one is notified */
+        if (_rtgui_topwin_clip_to_region(top, &region_available))
+        {
+            eclip.wid = top->wid;
+            rtgui_send(top->app, &(eclip.parent), sizeof(struct rtgui_event_clip_info));
+        }
 
         /* update available region */
         rtgui_region_subtract_rect(&region_available, &region_available, &top->extent);
 
-        /* send clip event to destination window */
-        eclip.wid = top->wid;
-        rtgui_send(top->app, &(eclip.parent), sizeof(struct rtgui_event_clip_info));
-
         top = _rtgui_topwin_get_next_shown(top);
     }
 
     rtgui_region_fini(&region_available);
+    rtgui_region_arena_reset();
+}
+
+/* send the damage of topwin to its window */
+static void _rtgui_topwin_send_damage(struct rtgui_topwin *topwin)
+{
+    struct rtgui_event_paint epaint;
+    struct rtgui_region_snapshot *snapshot, *pending;
+    rtgui_region_t merged;
+
+    RTGUI_EVENT_PAINT_INIT(&epaint);
+    epaint.wid = topwin->wid;
+
+    /* the whole window is painted, the damage is included */
+    if (topwin->flag & WINTITLE_REPAINT)
+    {
+        rtgui_region_empty(&topwin->damage);
+        rtgui_send(topwin->app, &(epaint.parent), sizeof(epaint));
+        return;
+    }
+
+    /*
+     * The damage not taken yet is replaced by the merged one in place, the
+     * slot is never empty while the paint event of it is in the queue. If
+     * the client takes it before that, the merging is done again.
+     */
+    while (1)
+    {
+        pending = rtgui_region_snapshot_peek(&topwin->wid->damage_pending);
+
+        rtgui_region_init(&merged);
+        rtgui_region_copy(&merged, &topwin->damage);
+        if (pending != RT_NULL)
+            rtgui_region_union(&merged, &merged, &pending->region);
+        epaint.rect = *rtgui_region_extents(&merged);
+        snapshot = rtgui_region_snapshot_create(&merged, 0);
+        rtgui_region_fini(&merged);
+
+        if (snapshot == RT_NULL)
+        {
+            rtgui_region_snapshot_unref(pending);
+            break;
+        }
+
+        if (rtgui_region_snapshot_compare_exchange(&topwin->wid->damage_pending,
+                                                   pending, snapshot))
+        {
+            rtgui_region_empty(&topwin->damage);
+            /* the references of the slot and of peeking */
+            rtgui_region_snapshot_unref(pending);
+            rtgui_region_snapshot_unref(pending);
+
+            /* the paint event of the pending one is still in the queue, it
+             * will take the merged damage */
+            if (pending != RT_NULL)
+                return;
+
+            epaint.parent.user = RTGUI_PAINT_DAMAGE;
+            break;
+        }
+
+        rtgui_region_snapshot_unref(snapshot);
+        rtgui_region_snapshot_unref(pending);
+    }
+    /* otherwise, repaint the whole window */
+    rtgui_region_empty(&topwin->damage);
+
+    if (rtgui_send(topwin->app, &(epaint.parent), sizeof(epaint)) != RT_EOK)
+    {
+        /* nobody will take it */
+        rtgui_region_snapshot_unref(rtgui_region_snapshot_exchange(&topwin->wid->damage_pending, RT_NULL));
+    }
 }
 
-static void _rtgui_topwin_redraw_tree(struct rt_list_node *list,
-                                      struct rtgui_rect *rect,
-                                      struct rtgui_event_paint *epaint)
+static void _rtgui_topwin_redraw_tree(struct rt_list_node *list)
 {
     struct rt_list_node *node;
 
     RT_ASSERT(list != RT_NULL);
-    RT_ASSERT(rect != RT_NULL);
-    RT_ASSERT(epaint != RT_NULL);
 
     /* skip the hidden windows */
     rt_list_foreach(node, list, prev)
@@ -987,25 +1092,273 @@ static void _rtgui_topwin_redraw_tree(struct rt_list_node *list,
 
         topwin = get_topwin_from_list(node);
 
-        //FIXME: intersect with clip?
-        if (rtgui_rect_is_intersect(rect, &(topwin->extent)) == RT_EOK)
+        if (topwin->flag & WINTITLE_MOVED)
+            rtgui_region_empty(&topwin->damage);
+        if ((topwin->flag & WINTITLE_REPAINT) || rtgui_region_not_empty(&topwin->damage))
+            _rtgui_topwin_send_damage(topwin);
+        topwin->flag &= ~(WINTITLE_REPAINT | WINTITLE_MOVED);
+
+        _rtgui_topwin_redraw_tree(&topwin->child_list);
+    }
+}
+
+/* send the damage collected by clip updating to the windows */
+static void rtgui_topwin_redraw(void)
+{
+    _rtgui_topwin_redraw_tree(&_rtgui_topwin_list);
+}
+
+static void _rtgui_topwin_notify_tree(struct rt_list_node *list)
+{
+    struct rt_list_node *node;
+    struct rtgui_event_win event;
+
+    rt_list_foreach(node, list, next)
+    {
+        struct rtgui_topwin *topwin = get_topwin_from_list(node);
+
+        if (topwin->flag & WINTITLE_NOTIFY)
         {
-            epaint->wid = topwin->wid;
-            // < XY do !!! >
-            //rtgui_send(topwin->app, &(epaint->parent), sizeof(*epaint));
+            topwin->flag &= ~WINTITLE_NOTIFY;
+
+            if (topwin->flag & WINTITLE_ACTIVATE)
+                RTGUI_EVENT_WIN_ACTIVATE_INIT(&event);
+            else
+                RTGUI_EVENT_WIN_DEACTIVATE_INIT(&event);
+            event.wid = topwin->wid;
+            rtgui_send(topwin->app, &(event.parent), sizeof(struct rtgui_event_win));
         }
 
-        _rtgui_topwin_redraw_tree(&topwin->child_list, rect, epaint);
+        _rtgui_topwin_notify_tree(&topwin->child_list);
     }
 }
 
-static void rtgui_topwin_redraw(struct rtgui_rect *rect)
+void rtgui_topwin_flush(void)
 {
-    struct rtgui_event_paint epaint;
-    RTGUI_EVENT_PAINT_INIT(&epaint);
-    epaint.wid = RT_NULL;
+    rt_uint8_t dirty;
+
+    dirty = _rtgui_topwin_dirty;
+    _rtgui_topwin_dirty = 0;
+
+    if (dirty & TOPWIN_DIRTY_CLIP)
+        rtgui_topwin_update_clip();
+    /* the windows get the new clip before the activate state and paint */
+    if (dirty & TOPWIN_DIRTY_NOTIFY)
+        _rtgui_topwin_notify_tree(&_rtgui_topwin_list);
+    /* the focus is changed with the activate state */
+    if (dirty & (TOPWIN_DIRTY_INPUT | TOPWIN_DIRTY_NOTIFY))
+        _rtgui_input_map_unref(_rtgui_input_map_publish());
+    if (dirty & (TOPWIN_DIRTY_CLIP | TOPWIN_DIRTY_NOTIFY))
+        rtgui_topwin_redraw();
+}
+
+/*
+ * The input map is the copy of the tree for the input stage of server, which
+ * hit tests in its own thread. It's published as a whole and refcounted like
+ * the clip snapshots, the input stage holds a reference while routing.
+ */
+static struct rtgui_input_map *_rtgui_input_map = RT_NULL;
+/* the input stage holds one map at most, the grace is bumped on each put */
+static volatile rt_uint8_t _rtgui_input_map_busy = 0;
+static volatile rt_uint32_t _rtgui_input_map_grace = 0;
+
+/* mirror _rtgui_topwin_get_wnd_from_tree, the map is counted if it's NULL */
+static void _rtgui_input_map_walk(struct rt_list_node *list,
+                                  struct rtgui_input_map *map,
+                                  rtgui_rect_t *monitor,
+                                  int *target_num, int *monitor_num)
+{
+    struct rt_list_node *node;
+    struct rtgui_list_node *mnode;
+    struct rtgui_topwin *topwin;
+    struct rtgui_input_target *target = RT_NULL;
+
+    rt_list_foreach(node, list, next)
+    {
+        topwin = get_topwin_from_list(node);
+        if (!(topwin->flag & WINTITLE_SHOWN))
+            break;
+
+        _rtgui_input_map_walk(&topwin->child_list, map, monitor,
+                              target_num, monitor_num);
+
+        if (topwin->flag & WINTITLE_MODALED)
+            break;
+
+        if (map != RT_NULL)
+        {
+            target = &map->target[*target_num];
+            target->wid = topwin->wid;
+            target->app = topwin->app;
+            target->extent = topwin->extent;
+            /* the published clips are out of date until the next flush */
+            target->clip = RT_NULL;
+            if (topwin->clip != RT_NULL && !(_rtgui_topwin_dirty & TOPWIN_DIRTY_CLIP))
+                target->clip = rtgui_region_snapshot_ref(topwin->clip);
+            target->monitor = &monitor[*monitor_num];
+            target->monitor_num = 0;
+        }
+        (*target_num) ++;
+
+        rtgui_list_foreach(mnode, &(topwin->monitor_list))
+        {
+            if (map != RT_NULL)
+            {
+                monitor[*monitor_num] = rtgui_list_entry(mnode,
+                                        struct rtgui_mouse_monitor, list)->rect;
+                target->monitor_num ++;
+            }
+            (*monitor_num) ++;
+        }
+    }
+}
+
+/* publish the map of current tree and return the old one */
+static struct rtgui_input_map *_rtgui_input_map_publish(void)
+{
+    int target_num = 0, monitor_num = 0;
+    rt_base_t level;
+    struct rtgui_topwin *focus;
+    struct rtgui_input_map *map, *old;
+
+    _rtgui_input_map_walk(&_rtgui_topwin_list, RT_NULL, RT_NULL,
+                          &target_num, &monitor_num);
+
+    map = (struct rtgui_input_map *) rtgui_malloc(sizeof(struct rtgui_input_map) +
+            target_num * sizeof(struct rtgui_input_target) +
+            monitor_num * sizeof(rtgui_rect_t));
+    if (map != RT_NULL)
+    {
+        map->refcount = 1;
+        map->target = (struct rtgui_input_target *)(map + 1);
+        map->target_num = target_num;
+        map->hit = 0;
+
+        focus = rtgui_topwin_get_focus();
+        map->focus = focus ? focus->wid : RT_NULL;
+        map->focus_app = focus ? focus->app : RT_NULL;
+
+        target_num = monitor_num = 0;
+        _rtgui_input_map_walk(&_rtgui_topwin_list, map,
+                              (rtgui_rect_t *)(map->target + map->target_num),
+                              &target_num, &monitor_num);
+    }
+    else
+    {
+        /* no input is routed rather than to the stale windows, try again on
+         * next flush */
+        _rtgui_topwin_dirty |= TOPWIN_DIRTY_INPUT;
+    }
+
+    level = rt_hw_interrupt_disable();
+    old = _rtgui_input_map;
+    _rtgui_input_map = map;
+    rt_hw_interrupt_enable(level);
+
+    return old;
+}
+
+struct rtgui_input_map *rtgui_input_map_get(void)
+{
+    rt_base_t level;
+    struct rtgui_input_map *map;
+
+    level = rt_hw_interrupt_disable();
+    map = _rtgui_input_map;
+    if (map != RT_NULL)
+        map->refcount ++;
+    _rtgui_input_map_busy = 1;
+    rt_hw_interrupt_enable(level);
+
+    return map;
+}
+
+void rtgui_input_map_put(struct rtgui_input_map *map)
+{
+    rt_base_t level;
+
+    _rtgui_input_map_unref(map);
+
+    level = rt_hw_interrupt_disable();
+    _rtgui_input_map_busy = 0;
+    _rtgui_input_map_grace ++;
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * Wait for the input stage to put the map it holds, which may be published
+ * before the last change of the tree. The apps referenced by the old maps
+ * are safe to free after this.
+ */
+void rtgui_input_map_sync(void)
+{
+    rt_base_t level;
+    rt_uint8_t busy;
+    rt_uint32_t grace;
+
+    level = rt_hw_interrupt_disable();
+    busy = _rtgui_input_map_busy;
+    grace = _rtgui_input_map_grace;
+    rt_hw_interrupt_enable(level);
+
+    /* the input stage never waits for the server thread */
+    while (busy && grace == _rtgui_input_map_grace)
+        rt_thread_delay(1);
+}
+
+static void _rtgui_input_map_unref(struct rtgui_input_map *map)
+{
+    int index;
+    rt_base_t level;
+    rt_uint32_t refcount;
 
-    _rtgui_topwin_redraw_tree(&_rtgui_topwin_list, rect, &epaint);
+    if (map == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    refcount = -- map->refcount;
+    rt_hw_interrupt_enable(level);
+
+    if (refcount == 0)
+    {
+        for (index = 0; index < map->target_num; index ++)
+            rtgui_region_snapshot_unref(map->target[index].clip);
+        rtgui_free(map);
+    }
+}
+
+/*
+ * The published clips of the shown windows don't overlap and are in the same
+ * order as the targets, so a point in the clip of the last hit target hits it
+ * again. The map is used by the input stage only, the hit is not locked.
+ */
+struct rtgui_input_target *rtgui_input_map_hit(struct rtgui_input_map *map, int x, int y)
+{
+    int index;
+    rtgui_rect_t box;
+    struct rtgui_input_target *target;
+
+    if (map == RT_NULL)
+        return RT_NULL;
+
+    if (map->hit < map->target_num)
+    {
+        target = &map->target[map->hit];
+        if (target->clip != RT_NULL &&
+                rtgui_region_contains_point(&(target->clip->region), x, y, &box) == RT_EOK)
+            return target;
+    }
+
+    for (index = 0; index < map->target_num; index ++)
+    {
+        if (rtgui_rect_contains_point(&(map->target[index].extent), x, y) == RT_EOK)
+        {
+            map->hit = index;
+            return &map->target[index];
+        }
+    }
+
+    return RT_NULL;
 }
 
 /* a window enter modal mode will modal all the sibling window and parent
@@ -1024,6 +1377,8 @@ rt_err_t rtgui_topwin_modal_enter(struct rtgui_event_win_modal_enter *event)
     if (IS_ROOT_WIN(topwin))
         return RT_EOK;
 
+    _rtgui_topwin_hit_reset();
+
     parent_top = topwin->parent;
 
     /* modal window should be on top already */
@@ -1064,6 +1419,7 @@ void rtgui_topwin_append_monitor_rect(struct rtgui_win *wid, rtgui_rect_t *rect)
 
     /* append rect to top window monitor rect list */
     rtgui_mouse_monitor_append(&(win->monitor_list), rect);
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_INPUT;
 }
 
 void rtgui_topwin_remove_monitor_rect(struct rtgui_win *wid, rtgui_rect_t *rect)
@@ -1081,6 +1437,7 @@ void rtgui_topwin_remove_monitor_rect(struct rtgui_win *wid, rtgui_rect_t *rect)
 
     /* remove rect from top window monitor rect list */
     rtgui_mouse_monitor_remove(&(win->monitor_list), rect);
+    _rtgui_topwin_dirty |= TOPWIN_DIRTY_INPUT;
 }
 
 static struct rtgui_object* _get_obj_in_topwin(struct rtgui_topwin *topwin,
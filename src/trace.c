@@ -0,0 +1,435 @@
+/*
+ * File      : trace.c
+ * This file is part of RT-Thread GUI Engine
+ * COPYRIGHT (C) 2006 - 2017, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     guiengine    first version
+ */
+#include <rthw.h>
+#include <rtgui/rtgui.h>
+#include <rtgui/event.h>
+#include <rtgui/trace.h>
+#include <rtgui/filerw.h>
+#include <rtgui/rtgui_app.h>
+#include <rtgui/rtgui_system.h>
+#include <rtgui/widgets/window.h>
+
+#ifdef GUIENGIN_USING_TRACE
+
+#define TRACE_MASK      (GUIENGIN_TRACE_RECORDS - 1)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define _trace_fetch_add(ptr, value)    __sync_fetch_and_add((ptr), (value))
+#define _trace_barrier()                __sync_synchronize()
+#else
+static rt_uint32_t _trace_fetch_add(volatile rt_uint32_t *ptr, rt_uint32_t value)
+{
+    rt_base_t level;
+    rt_uint32_t old;
+
+    level = rt_hw_interrupt_disable();
+    old = *ptr;
+    *ptr = old + value;
+    rt_hw_interrupt_enable(level);
+
+    return old;
+}
+/* volatile is enough on single core */
+#define _trace_barrier()
+#endif
+
+static struct rtgui_trace_record _trace_ring[GUIENGIN_TRACE_RECORDS];
+/* seq 0 marks the slots not written */
+static volatile rt_uint32_t _trace_head = 1;
+static volatile rt_bool_t _trace_on = RT_FALSE;
+
+/* the counts are exact, the max may miss a racing update */
+static struct rtgui_trace_hist _trace_wait[RTGUI_TRACE_EVENT_TYPES];
+static struct rtgui_trace_hist _trace_dispatch[RTGUI_TRACE_EVENT_TYPES];
+
+static rt_uint32_t _rtgui_trace_tick_clock(void)
+{
+    return rt_tick_get() * (1000000 / RT_TICK_PER_SECOND);
+}
+
+static rtgui_trace_clock_t _trace_clock = _rtgui_trace_tick_clock;
+
+void rtgui_trace_set_clock(rtgui_trace_clock_t clock)
+{
+    _trace_clock = clock ? clock : _rtgui_trace_tick_clock;
+}
+RTM_EXPORT(rtgui_trace_set_clock);
+
+rt_uint32_t rtgui_trace_now(void)
+{
+    return _trace_clock();
+}
+
+void rtgui_trace_start(void)
+{
+    _trace_on = RT_TRUE;
+}
+RTM_EXPORT(rtgui_trace_start);
+
+void rtgui_trace_stop(void)
+{
+    _trace_on = RT_FALSE;
+}
+RTM_EXPORT(rtgui_trace_stop);
+
+void rtgui_trace_reset(void)
+{
+    int index;
+
+    for (index = 0; index < GUIENGIN_TRACE_RECORDS; index ++)
+        _trace_ring[index].seq = 0;
+    _trace_head = 1;
+
+    rt_memset(_trace_wait, 0, sizeof(_trace_wait));
+    rt_memset(_trace_dispatch, 0, sizeof(_trace_dispatch));
+}
+RTM_EXPORT(rtgui_trace_reset);
+
+rt_inline int _rtgui_trace_type(rt_uint32_t type)
+{
+    return type < RTGUI_TRACE_EVENT_TYPES - 1 ? type : RTGUI_TRACE_EVENT_TYPES - 1;
+}
+
+static void _rtgui_trace_hist(struct rtgui_trace_hist *hist, rt_uint32_t time)
+{
+    int bucket;
+    rt_uint32_t value;
+
+    bucket = 0;
+    value = time >> 1;
+    while (value != 0 && bucket < RTGUI_TRACE_BUCKETS - 1)
+    {
+        value >>= 1;
+        bucket ++;
+    }
+
+    _trace_fetch_add(&hist->count, 1);
+    _trace_fetch_add(&hist->bucket[bucket], 1);
+    if (time > hist->max)
+        hist->max = time;
+}
+
+static void _rtgui_trace_record(rt_uint8_t kind, rt_uint32_t type, rt_uint32_t ts,
+                                rt_uint32_t dur, const char *name)
+{
+    rt_uint32_t seq;
+    struct rtgui_trace_record *record;
+
+    seq = _trace_fetch_add(&_trace_head, 1);
+    if (seq == 0)
+        seq = _trace_fetch_add(&_trace_head, 1);
+
+    record = &_trace_ring[seq & TRACE_MASK];
+    record->seq = 0;
+    _trace_barrier();
+
+    record->ts = ts;
+    record->dur = dur;
+    record->thread = rt_thread_self();
+    if (name == RT_NULL && record->thread != RT_NULL)
+        name = record->thread->name;
+    if (name != RT_NULL)
+        rt_strncpy(record->name, name, RT_NAME_MAX);
+    else
+        record->name[0] = '\0';
+    record->event = type;
+    record->kind = kind;
+
+    _trace_barrier();
+    record->seq = seq;
+}
+
+void rtgui_trace_send(struct rtgui_app *app, rt_uint32_t type, rt_err_t result)
+{
+    if (!_trace_on)
+        return;
+
+    _rtgui_trace_record(result == RT_EOK ? RTGUI_TRACE_SEND : RTGUI_TRACE_DROP,
+                        type, _trace_clock(), 0, (const char *)app->name);
+}
+
+void rtgui_trace_recv(struct rtgui_event *event)
+{
+    rt_uint32_t type, now;
+
+    if (!_trace_on)
+        return;
+
+    type = event->type;
+    if (type == RTGUI_EVENT_REF)
+        type = ((struct rtgui_event_ref *)event)->event->type;
+
+    now = _trace_clock();
+    _rtgui_trace_hist(&_trace_wait[_rtgui_trace_type(type)], now - event->stamp);
+    _rtgui_trace_record(RTGUI_TRACE_RECV, type, event->stamp, now - event->stamp, RT_NULL);
+}
+
+void rtgui_trace_dispatch(rt_uint32_t type, rt_uint32_t begin)
+{
+    rt_uint32_t now;
+
+    if (!_trace_on)
+        return;
+
+    now = _trace_clock();
+    _rtgui_trace_hist(&_trace_dispatch[_rtgui_trace_type(type)], now - begin);
+    _rtgui_trace_record(RTGUI_TRACE_DISPATCH, type, begin, now - begin, RT_NULL);
+}
+
+void rtgui_trace_draw(struct rtgui_win *win, rt_bool_t begin)
+{
+    const char *title;
+
+    if (!_trace_on)
+        return;
+
+    /* the name is the window drawn in */
+    title = (win != RT_NULL && win->title != RT_NULL) ? win->title : "";
+    _rtgui_trace_record(begin ? RTGUI_TRACE_DRAW_BEGIN : RTGUI_TRACE_DRAW_END,
+                        0, _trace_clock(), 0, title);
+}
+
+void rtgui_trace_update(rt_uint32_t begin)
+{
+    rt_uint32_t now;
+
+    if (!_trace_on)
+        return;
+
+    now = _trace_clock();
+    _rtgui_trace_record(RTGUI_TRACE_UPDATE, 0, begin, now - begin, RT_NULL);
+}
+
+void rtgui_trace_get_hist(rt_uint32_t type, struct rtgui_trace_hist *wait,
+                          struct rtgui_trace_hist *dispatch)
+{
+    int index;
+
+    index = _rtgui_trace_type(type);
+    if (wait != RT_NULL)
+        *wait = _trace_wait[index];
+    if (dispatch != RT_NULL)
+        *dispatch = _trace_dispatch[index];
+}
+RTM_EXPORT(rtgui_trace_get_hist);
+
+/* the writer of export, to file or console */
+struct rtgui_trace_writer
+{
+    struct rtgui_filerw *file;
+    char line[160];
+    rt_bool_t first;
+
+    /* the threads named already */
+    rt_thread_t named[8];
+    int named_num;
+};
+
+static void _rtgui_trace_write(struct rtgui_trace_writer *writer)
+{
+    if (writer->file != RT_NULL)
+        rtgui_filerw_write(writer->file, writer->line, 1, rt_strlen(writer->line));
+    else
+        rt_kprintf("%s", writer->line);
+}
+
+static void _rtgui_trace_export_record(struct rtgui_trace_writer *writer,
+                                       struct rtgui_trace_record *record)
+{
+    const char *sep;
+    char name[RT_NAME_MAX + 1];
+
+    rt_memcpy(name, record->name, RT_NAME_MAX);
+    name[RT_NAME_MAX] = '\0';
+
+    sep = writer->first ? "" : ",\n";
+    writer->first = RT_FALSE;
+
+    switch (record->kind)
+    {
+    case RTGUI_TRACE_SEND:
+    case RTGUI_TRACE_DROP:
+        rt_snprintf(writer->line, sizeof(writer->line),
+                    "%s{\"name\":\"%s%s\",\"cat\":\"send\",\"ph\":\"i\",\"s\":\"t\","
+                    "\"ts\":%u,\"pid\":1,\"tid\":%u,\"args\":{\"to\":\"%s\"}}",
+                    sep, record->kind == RTGUI_TRACE_DROP ? "drop " : "",
+                    rtgui_event_name(record->event), record->ts,
+                    (rt_uint32_t)(rt_ubase_t)record->thread, name);
+        break;
+
+    case RTGUI_TRACE_RECV:
+    case RTGUI_TRACE_DISPATCH:
+        rt_snprintf(writer->line, sizeof(writer->line),
+                    "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,"
+                    "\"pid\":1,\"tid\":%u}",
+                    sep, rtgui_event_name(record->event),
+                    record->kind == RTGUI_TRACE_RECV ? "queue" : "dispatch",
+                    record->ts, record->dur, (rt_uint32_t)(rt_ubase_t)record->thread);
+        break;
+
+    case RTGUI_TRACE_DRAW_BEGIN:
+    case RTGUI_TRACE_DRAW_END:
+        rt_snprintf(writer->line, sizeof(writer->line),
+                    "%s{\"name\":\"draw\",\"cat\":\"dc\",\"ph\":\"%s\",\"ts\":%u,"
+                    "\"pid\":1,\"tid\":%u,\"args\":{\"win\":\"%s\"}}",
+                    sep, record->kind == RTGUI_TRACE_DRAW_BEGIN ? "B" : "E",
+                    record->ts, (rt_uint32_t)(rt_ubase_t)record->thread, name);
+        break;
+
+    case RTGUI_TRACE_UPDATE:
+        rt_snprintf(writer->line, sizeof(writer->line),
+                    "%s{\"name\":\"screen_update\",\"cat\":\"driver\",\"ph\":\"X\","
+                    "\"ts\":%u,\"dur\":%u,\"pid\":1,\"tid\":%u}",
+                    sep, record->ts, record->dur, (rt_uint32_t)(rt_ubase_t)record->thread);
+        break;
+
+    default:
+        return;
+    }
+    _rtgui_trace_write(writer);
+
+    /* name the thread by the records in it, the others are named by the app
+     * sent to or the window drawn in */
+    if (record->kind == RTGUI_TRACE_RECV || record->kind == RTGUI_TRACE_DISPATCH ||
+            record->kind == RTGUI_TRACE_UPDATE)
+    {
+        int index;
+
+        for (index = 0; index < writer->named_num; index ++)
+        {
+            if (writer->named[index] == record->thread)
+                return;
+        }
+        if (writer->named_num == sizeof(writer->named) / sizeof(writer->named[0]))
+            return;
+        writer->named[writer->named_num ++] = record->thread;
+
+        rt_snprintf(writer->line, sizeof(writer->line),
+                    ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":\"%s\"}}",
+                    (rt_uint32_t)(rt_ubase_t)record->thread, name);
+        _rtgui_trace_write(writer);
+    }
+}
+
+rt_err_t rtgui_trace_export(const char *filename)
+{
+    rt_uint32_t seq, head;
+    struct rtgui_trace_record record;
+    struct rtgui_trace_writer writer;
+
+    writer.file = RT_NULL;
+    writer.first = RT_TRUE;
+    writer.named_num = 0;
+    if (filename != RT_NULL)
+    {
+#ifdef GUIENGINE_USING_DFS_FILERW
+        writer.file = rtgui_filerw_create_file(filename, "wb");
+#endif
+        if (writer.file == RT_NULL)
+            return -RT_ERROR;
+    }
+
+    rt_strncpy(writer.line, "{\"traceEvents\":[\n", sizeof(writer.line));
+    _rtgui_trace_write(&writer);
+
+    /* the records written meanwhile are skipped, the old ones are
+     * overwritten */
+    head = _trace_head;
+    seq = head > GUIENGIN_TRACE_RECORDS ? head - GUIENGIN_TRACE_RECORDS : 1;
+    for (; seq != head; seq ++)
+    {
+        if (_trace_ring[seq & TRACE_MASK].seq != seq)
+            continue;
+
+        record = _trace_ring[seq & TRACE_MASK];
+        _trace_barrier();
+        if (record.seq != seq || _trace_ring[seq & TRACE_MASK].seq != seq)
+            continue;
+
+        _rtgui_trace_export_record(&writer, &record);
+    }
+
+    rt_strncpy(writer.line, "\n],\"displayTimeUnit\":\"ms\"}\n", sizeof(writer.line));
+    _rtgui_trace_write(&writer);
+
+    if (writer.file != RT_NULL)
+        rtgui_filerw_close(writer.file);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rtgui_trace_export);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void gui_trace(int on)
+{
+    if (on)
+    {
+        rtgui_trace_reset();
+        rtgui_trace_start();
+    }
+    else
+        rtgui_trace_stop();
+}
+FINSH_FUNCTION_EXPORT(gui_trace, usage: gui_trace(1) to start and gui_trace(0) to stop);
+
+void gui_trace_dump(const char *filename)
+{
+    if (rtgui_trace_export(filename) != RT_EOK)
+        rt_kprintf("export trace to %s failed\n", filename);
+}
+FINSH_FUNCTION_EXPORT(gui_trace_dump, usage: gui_trace_dump(filename) or gui_trace_dump(0) to console);
+
+static void _rtgui_trace_print_hist(const char *what, rt_uint32_t type, struct rtgui_trace_hist *hist)
+{
+    int bucket;
+
+    rt_kprintf("%-14s %-8s n %-6d max %-7dus |", rtgui_event_name(type),
+               what, hist->count, hist->max);
+    for (bucket = 0; bucket < RTGUI_TRACE_BUCKETS; bucket ++)
+        rt_kprintf(" %d", hist->bucket[bucket]);
+    rt_kprintf("\n");
+}
+
+void gui_trace_hist(void)
+{
+    rt_uint32_t type;
+
+    rt_kprintf("bucket n counts below 2^(n+1)us, the last counts the rest\n");
+    for (type = 0; type < RTGUI_TRACE_EVENT_TYPES; type ++)
+    {
+        rt_uint32_t event_type;
+
+        event_type = type < RTGUI_TRACE_EVENT_TYPES - 1 ? type : RTGUI_EVENT_COMMAND;
+        if (_trace_wait[type].count)
+            _rtgui_trace_print_hist("wait", event_type, &_trace_wait[type]);
+        if (_trace_dispatch[type].count)
+            _rtgui_trace_print_hist("dispatch", event_type, &_trace_dispatch[type]);
+    }
+}
+FINSH_FUNCTION_EXPORT(gui_trace_hist, display queue wait and dispatch time of events);
+#endif
+
+#endif
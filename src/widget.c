@@ -47,6 +47,7 @@ static void _rtgui_widget_constructor(rtgui_widget_t *widget)
     widget->gc.font = rtgui_font_default();
     widget->gc.textstyle = RTGUI_TEXTSTYLE_NORMAL;
     widget->gc.textalign = RTGUI_ALIGN_LEFT | RTGUI_ALIGN_TOP;
+    widget->gc.dither = RTGUI_DITHER_NONE;
     widget->align = RTGUI_ALIGN_LEFT | RTGUI_ALIGN_TOP;
 
     /* clear the garbage value of extent and clip */
@@ -54,6 +55,8 @@ static void _rtgui_widget_constructor(rtgui_widget_t *widget)
     memset(&(widget->extent_visiable), 0x0, sizeof(widget->extent_visiable));
     widget->min_width = widget->min_height = 0;
     rtgui_region_init_with_extents(&widget->clip, &widget->extent);
+    widget->clip_gen = widget->tree_gen = 0;
+    widget->opaque = RT_NULL;
 
     /* set parent and toplevel root */
     widget->parent        = RT_NULL;
@@ -82,12 +85,22 @@ static void _rtgui_widget_destructor(rtgui_widget_t *widget)
     {
         /* remove widget from parent's children list */
         rtgui_list_remove(&(RTGUI_CONTAINER(widget->parent)->children), &(widget->sibling));
+        rtgui_widget_invalidate_clip(widget->parent);
 
         widget->parent = RT_NULL;
     }
 
+    /* don't paint it in the frame */
+    rtgui_frame_cancel(widget);
+
     /* fini clip region */
     rtgui_region_fini(&(widget->clip));
+    if (widget->opaque != RT_NULL)
+    {
+        rtgui_region_fini(widget->opaque);
+        rtgui_free(widget->opaque);
+        widget->opaque = RT_NULL;
+    }
 }
 
 DEFINE_CLASS_TYPE(widget, "widget",
@@ -141,17 +154,10 @@ void rtgui_widget_set_rect(rtgui_widget_t *widget, const rtgui_rect_t *rect)
 
     /* reset clip info */
     rtgui_region_init_with_extents(&(widget->clip), rect);
+    rtgui_widget_invalidate_clip(widget);
     if ((widget->parent != RT_NULL) && (widget->toplevel != RT_NULL))
     {
-        if ((void*)widget->parent == (void*)widget->toplevel)
-        {
-            rtgui_win_update_clip(widget->toplevel);
-        }
-        else
-        {
-            /* update widget clip */
-            rtgui_widget_update_clip(widget->parent);
-        }
+        rtgui_win_update_clip(widget->toplevel);
     }
 
     /* move to a logic position if it's a container widget */
@@ -218,6 +224,45 @@ void rtgui_widget_set_minheight(rtgui_widget_t *widget, int height)
 }
 RTM_EXPORT(rtgui_widget_set_minheight);
 
+/*
+ * A no transparent widget hides the whole extent from its parent. The widget
+ * which doesn't paint some part of its extent, such as the corners of a round
+ * button, could set the opaque part here, then the parent only paints under
+ * the rest of the extent. The region is copied, in logic coordinates of the
+ * widget and it should be set again if the widget is resized.
+ */
+void rtgui_widget_set_opaque(rtgui_widget_t *widget, rtgui_region_t *region)
+{
+    RT_ASSERT(widget != RT_NULL);
+
+    if (region == RT_NULL)
+    {
+        if (widget->opaque == RT_NULL)
+            return;
+
+        rtgui_region_fini(widget->opaque);
+        rtgui_free(widget->opaque);
+        widget->opaque = RT_NULL;
+    }
+    else
+    {
+        if (widget->opaque == RT_NULL)
+        {
+            widget->opaque = (rtgui_region_t *)rtgui_malloc(sizeof(rtgui_region_t));
+            /* no memory, the whole extent is opaque */
+            if (widget->opaque == RT_NULL)
+                return;
+
+            rtgui_region_init(widget->opaque);
+        }
+
+        rtgui_region_copy(widget->opaque, region);
+    }
+
+    rtgui_widget_invalidate_clip(widget);
+}
+RTM_EXPORT(rtgui_widget_set_opaque);
+
 static void _widget_move(struct rtgui_widget* widget, int dx, int dy)
 {
     struct rtgui_list_node *node;
@@ -234,11 +279,14 @@ static void _widget_move(struct rtgui_widget* widget, int dx, int dy)
         rtgui_rect_intersect(&(widget->parent->extent_visiable), &(widget->extent_visiable));
 
     /* reset clip info */
-    rtgui_region_init_with_extents(&(widget->clip), &(widget->extent));
+    rtgui_region_reset(&(widget->clip), &(widget->extent));
+    widget->clip_gen = 0;
 
     /* move each child */
     if (RTGUI_IS_CONTAINER(widget))
     {
+        RTGUI_CONTAINER(widget)->cover_gen = 0;
+        rtgui_container_invalidate_hit(RTGUI_CONTAINER(widget));
         rtgui_list_foreach(node, &(RTGUI_CONTAINER(widget)->children))
         {
             child = rtgui_list_entry(node, rtgui_widget_t, sibling);
@@ -253,34 +301,16 @@ static void _widget_move(struct rtgui_widget* widget, int dx, int dy)
  */
 void rtgui_widget_move_to_logic(rtgui_widget_t *widget, int dx, int dy)
 {
-    rtgui_rect_t rect;
-    rtgui_widget_t *parent;
-
     if (widget == RT_NULL)
         return;
 
-    /* give clip of this widget back to parent */
-    parent = widget->parent;
-    if (parent != RT_NULL)
-    {
-        /* get the parent rect, even if it's a transparent parent. */
-        rect = parent->extent_visiable;
-    }
-
-    /* we should find out the none-transparent parent */
-    while (parent != RT_NULL && parent->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) parent = parent->parent;
-    if (parent != RT_NULL)
-    {
-        /* reset clip info */
-        rtgui_region_init_with_extents(&(widget->clip), &(widget->extent));
-        rtgui_region_intersect_rect(&(widget->clip), &(widget->clip), &rect);
+    /* move this widget (and its children if it's a container) to destination
+     * point. If it's not moved, the visible extents are checked in clip update */
+    if (dx != 0 || dy != 0 || widget->parent == RT_NULL)
+        _widget_move(widget, dx, dy);
 
-        /* give back the extent */
-        rtgui_region_union(&(parent->clip), &(parent->clip), &(widget->clip));
-    }
-
-    /* move this widget (and its children if it's a container) to destination point */
-    _widget_move(widget, dx, dy);
+    /* the parent gets back the old extent in clip update */
+    rtgui_widget_invalidate_clip(widget);
     /* update this widget */
     rtgui_widget_update_clip(widget);
 }
@@ -501,6 +531,10 @@ rt_bool_t rtgui_widget_onupdate_toplvl(struct rtgui_object *object, struct rtgui
     eup = (struct rtgui_event_update_toplvl *)event;
 
     widget->toplevel = eup->toplvl;
+    /* the generations of another window are meaningless */
+    widget->clip_gen = 0;
+    if (RTGUI_IS_CONTAINER(widget))
+        RTGUI_CONTAINER(widget)->cover_gen = 0;
 
     return RT_FALSE;
 }
@@ -529,61 +563,203 @@ rt_bool_t rtgui_widget_event_handler(struct rtgui_object *object, rtgui_event_t
 RTM_EXPORT(rtgui_widget_event_handler);
 
 /*
- * This function updates the clip info of widget
+ * The clip of widgets is memoized under the generation of window. When the
+ * geometry or visibility of a widget is changed, it's marked dirty and the
+ * path to the window is stamped with a new generation, then the clip update
+ * only walks into the stamped subtrees and recomputes the dirty widgets and
+ * the ones whose visible extent is changed.
+ *
+ * note: since the layout widget introduction, the sibling widget should not
+ * intersect. So the clip of a container is its visible extent subtracts the
+ * visible extents (or the opaque parts) of the opaque children (the cover),
+ * in any order.
  */
-void rtgui_widget_update_clip(rtgui_widget_t *widget)
+void rtgui_widget_invalidate_clip(rtgui_widget_t *widget)
 {
-    rtgui_rect_t rect;
-    struct rtgui_list_node *node;
+    rt_uint32_t gen;
     rtgui_widget_t *parent;
 
-    /* no widget or widget is hide, no update clip */
-    if (widget == RT_NULL || RTGUI_WIDGET_IS_HIDE(widget) || widget->parent == RT_NULL || rtgui_widget_is_in_animation(widget))
-        return;
+    RT_ASSERT(widget != RT_NULL);
+
+    widget->clip_gen = 0;
+    if (RTGUI_IS_CONTAINER(widget))
+    {
+        RTGUI_CONTAINER(widget)->cover_gen = 0;
+        rtgui_container_invalidate_hit(RTGUI_CONTAINER(widget));
+    }
+    if (widget->parent != RT_NULL && RTGUI_IS_CONTAINER(widget->parent))
+        rtgui_container_invalidate_hit(RTGUI_CONTAINER(widget->parent));
 
+    /* the cover of the no transparent parent is changed */
     parent = widget->parent;
-    /* reset visiable extent */
-    widget->extent_visiable = widget->extent;
-    rtgui_rect_intersect(&(parent->extent_visiable), &(widget->extent_visiable));
+    while (parent != RT_NULL && parent->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) parent = parent->parent;
+    if (parent != RT_NULL && RTGUI_IS_CONTAINER(parent))
+        RTGUI_CONTAINER(parent)->cover_gen = 0;
 
-    rect = parent->extent_visiable;
-    /* reset clip to extent */
-    rtgui_region_reset(&(widget->clip), &(widget->extent));
-    /* limit widget extent in parent extent */
-    rtgui_region_intersect_rect(&(widget->clip), &(widget->clip), &rect);
+    /* a child being added takes the toplevel of its parent after this */
+    for (parent = widget; parent != RT_NULL && parent->toplevel == RT_NULL; parent = parent->parent);
+    /* not in a window, the whole tree is clipped when it's added to one */
+    if (parent == RT_NULL)
+        return;
 
-    /* get the no transparent parent */
-    while (parent != RT_NULL && parent->flag & RTGUI_WIDGET_FLAG_TRANSPARENT)
-    {
-        parent = parent->parent;
-    }
-    if (parent != RT_NULL)
+    gen = ++ parent->toplevel->clip_gen;
+    for (parent = widget->parent; parent != RT_NULL; parent = parent->parent)
+        parent->tree_gen = gen;
+}
+RTM_EXPORT(rtgui_widget_invalidate_clip);
+
+static void _container_collect_cover(rtgui_container_t *container, rtgui_region_t *cover)
+{
+    struct rtgui_list_node *node;
+    rtgui_widget_t *child;
+
+    rtgui_list_foreach(node, &(container->children))
     {
-        /* give my clip back to parent */
-        rtgui_region_union(&(parent->clip), &(parent->clip), &(widget->clip));
+        child = rtgui_list_entry(node, rtgui_widget_t, sibling);
+        if (RTGUI_WIDGET_IS_HIDE(child) || (child->flag & RTGUI_WIDGET_FLAG_IN_ANIM))
+            continue;
 
-        /* subtract widget clip in parent clip */
-        if (!(widget->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) && RTGUI_IS_CONTAINER(parent))
+        if (!(child->flag & RTGUI_WIDGET_FLAG_TRANSPARENT))
         {
-            rtgui_region_subtract_rect(&(parent->clip), &(parent->clip), &(widget->extent_visiable));
+            /* the visible extent is inverted if it's out of parent */
+            if (child->extent_visiable.x1 < child->extent_visiable.x2 &&
+                child->extent_visiable.y1 < child->extent_visiable.y2)
+            {
+                if (child->opaque == RT_NULL)
+                    rtgui_region_union_rect(cover, cover, &(child->extent_visiable));
+                else
+                {
+                    rtgui_region_t part;
+
+                    /* only the opaque part hides me, I paint under the rest */
+                    rtgui_region_init(&part);
+                    rtgui_region_copy(&part, child->opaque);
+                    rtgui_region_translate(&part, child->extent.x1, child->extent.y1);
+                    rtgui_region_intersect_rect(&part, &part, &(child->extent_visiable));
+                    rtgui_region_union(cover, cover, &part);
+                    rtgui_region_fini(&part);
+                }
+            }
         }
+        else if (RTGUI_IS_CONTAINER(child))
+            /* the opaque children of a transparent container clip me */
+            _container_collect_cover(RTGUI_CONTAINER(child), cover);
     }
+}
+
+static rt_bool_t _widget_update_clip(rtgui_widget_t *widget, rt_uint32_t gen);
+
+/* returns RT_TRUE if the cover of container is rebuilt */
+static rt_bool_t _container_update_clip(rtgui_container_t *container, rt_uint32_t gen)
+{
+    struct rtgui_list_node *node;
+    rtgui_widget_t *child;
+    rt_bool_t changed = RT_FALSE;
+
+    rtgui_list_foreach(node, &(container->children))
+    {
+        child = rtgui_list_entry(node, rtgui_widget_t, sibling);
+        if (_widget_update_clip(child, gen))
+            changed = RT_TRUE;
+    }
+
+    /* the transparent container doesn't clip its children */
+    if (RTGUI_WIDGET(container)->flag & RTGUI_WIDGET_FLAG_TRANSPARENT)
+        return changed;
+
+    if (changed || container->cover_gen == 0)
+    {
+        rtgui_region_empty(&(container->cover));
+        _container_collect_cover(container, &(container->cover));
+        container->cover_gen = gen;
+
+        return RT_TRUE;
+    }
+
+    return RT_FALSE;
+}
+
+/* returns RT_TRUE if the visible extent of widget or its children is changed */
+static rt_bool_t _widget_update_clip(rtgui_widget_t *widget, rt_uint32_t gen)
+{
+    rtgui_rect_t rect;
+    rt_bool_t changed, children = RT_FALSE;
 
-    /*
-     * note: since the layout widget introduction, the sibling widget should not intersect.
-     */
+    if (RTGUI_WIDGET_IS_HIDE(widget) || (widget->flag & RTGUI_WIDGET_FLAG_IN_ANIM))
+        return RT_FALSE;
+
+    rect = widget->extent;
+    rtgui_rect_intersect(&(widget->parent->extent_visiable), &rect);
+    changed = widget->clip_gen == 0 ||
+              rtgui_rect_is_equal(&rect, &(widget->extent_visiable)) != RT_EOK;
+    /* nothing is changed in this subtree */
+    if (!changed && widget->tree_gen <= widget->clip_gen)
+        return RT_FALSE;
+
+    /* reset visiable extent */
+    widget->extent_visiable = rect;
 
-    /* if it's a container object, update the clip info of children */
     if (RTGUI_IS_CONTAINER(widget))
+        children = _container_update_clip(RTGUI_CONTAINER(widget), gen);
+
+    if (changed || (children && !(widget->flag & RTGUI_WIDGET_FLAG_TRANSPARENT)))
     {
-        rtgui_widget_t *child;
-        rtgui_list_foreach(node, &(RTGUI_CONTAINER(widget)->children))
+        if (rect.x1 >= rect.x2 || rect.y1 >= rect.y2)
         {
-            child = rtgui_list_entry(node, rtgui_widget_t, sibling);
+            /* out of parent, the inverted extent is not a valid region */
+            rtgui_region_empty(&(widget->clip));
+        }
+        else
+        {
+            /* reset clip to extent */
+            rtgui_region_reset(&(widget->clip), &(widget->extent));
+            /* limit widget extent in parent extent */
+            rtgui_region_intersect_rect(&(widget->clip), &(widget->clip), &rect);
+        }
 
-            rtgui_widget_update_clip(child);
+        if (RTGUI_IS_CONTAINER(widget) && !(widget->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) &&
+            rtgui_region_not_empty(&(RTGUI_CONTAINER(widget)->cover)))
+        {
+            rtgui_region_subtract(&(widget->clip), &(widget->clip),
+                                  &(RTGUI_CONTAINER(widget)->cover));
         }
     }
+    widget->clip_gen = gen;
+
+    /* the changes in a transparent container clip its parent */
+    return changed || (children && (widget->flag & RTGUI_WIDGET_FLAG_TRANSPARENT));
+}
+
+void rtgui_widget_clip_children(rtgui_widget_t *widget)
+{
+    rt_uint32_t gen;
+
+    RT_ASSERT(widget != RT_NULL);
+    RT_ASSERT(RTGUI_IS_CONTAINER(widget));
+
+    gen = widget->toplevel != RT_NULL ? widget->toplevel->clip_gen : 0;
+    _container_update_clip(RTGUI_CONTAINER(widget), gen);
+    if (rtgui_region_not_empty(&(RTGUI_CONTAINER(widget)->cover)))
+    {
+        rtgui_region_subtract(&(widget->clip), &(widget->clip),
+                              &(RTGUI_CONTAINER(widget)->cover));
+    }
+    widget->clip_gen = gen;
+}
+RTM_EXPORT(rtgui_widget_clip_children);
+
+/*
+ * This function updates the clip info of widget
+ */
+void rtgui_widget_update_clip(rtgui_widget_t *widget)
+{
+    /* no widget or widget is hide, no update clip */
+    if (widget == RT_NULL || RTGUI_WIDGET_IS_HIDE(widget) || widget->parent == RT_NULL || rtgui_widget_is_in_animation(widget))
+        return;
+
+    rtgui_widget_invalidate_clip(widget);
+    if (widget->toplevel != RT_NULL)
+        rtgui_win_update_clip(widget->toplevel);
 }
 RTM_EXPORT(rtgui_widget_update_clip);
 
@@ -632,6 +808,7 @@ void rtgui_widget_hide(struct rtgui_widget *widget)
     }
 
     RTGUI_WIDGET_HIDE(widget);
+    rtgui_widget_invalidate_clip(widget);
 }
 RTM_EXPORT(rtgui_widget_hide);
 
@@ -709,7 +886,12 @@ void rtgui_widget_clip_parent(rtgui_widget_t *widget)
     while (parent != RT_NULL && parent->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) parent = parent->parent;
 
     /* clip the widget extern from parent */
-    if (parent != RT_NULL) rtgui_region_subtract(&(parent->clip), &(parent->clip), &(widget->clip));
+    if (parent != RT_NULL)
+    {
+        rtgui_region_subtract(&(parent->clip), &(parent->clip), &(widget->clip));
+        /* the patched clip is recomputed in next clip update */
+        rtgui_widget_invalidate_clip(parent);
+    }
 }
 RTM_EXPORT(rtgui_widget_clip_parent);
 
@@ -722,7 +904,11 @@ void rtgui_widget_clip_return(rtgui_widget_t *widget)
     while (parent != RT_NULL && parent->flag & RTGUI_WIDGET_FLAG_TRANSPARENT) parent = parent->parent;
 
     /* give clip back to parent */
-    if (parent != RT_NULL) rtgui_region_union(&(parent->clip), &(parent->clip), &(widget->clip));
+    if (parent != RT_NULL)
+    {
+        rtgui_region_union(&(parent->clip), &(parent->clip), &(widget->clip));
+        rtgui_widget_invalidate_clip(parent);
+    }
 }
 RTM_EXPORT(rtgui_widget_clip_return);
 
@@ -743,6 +929,65 @@ void rtgui_widget_update(rtgui_widget_t *widget)
 }
 RTM_EXPORT(rtgui_widget_update);
 
+rt_bool_t rtgui_widget_is_damaged(rtgui_widget_t *widget)
+{
+    struct rtgui_win *win;
+
+    RT_ASSERT(widget != RT_NULL);
+
+    /* the whole window is painting */
+    win = widget->toplevel;
+    if (win == RT_NULL || win->damage == RT_NULL)
+        return RT_TRUE;
+
+    /* only the visible part counts if the clip is up to date */
+    if (widget->clip_gen != 0 && widget->parent != RT_NULL)
+    {
+        if (widget->extent_visiable.x1 >= widget->extent_visiable.x2 ||
+            widget->extent_visiable.y1 >= widget->extent_visiable.y2)
+            return RT_FALSE;
+
+        return rtgui_region_contains_rectangle(&win->damage->region,
+                                               &widget->extent_visiable) != RTGUI_REGION_OUT;
+    }
+
+    return rtgui_region_contains_rectangle(&win->damage->region, &widget->extent) != RTGUI_REGION_OUT;
+}
+RTM_EXPORT(rtgui_widget_is_damaged);
+
+void rtgui_widget_fill_damage(rtgui_widget_t *widget, struct rtgui_dc *dc)
+{
+    int index, num;
+    struct rtgui_win *win;
+    rtgui_rect_t rect, *damage;
+
+    RT_ASSERT(widget != RT_NULL);
+    RT_ASSERT(dc != RT_NULL);
+
+    rtgui_widget_get_rect(widget, &rect);
+
+    win = widget->toplevel;
+    if (win == RT_NULL || win->damage == RT_NULL)
+    {
+        rtgui_dc_fill_rect(dc, &rect);
+        return;
+    }
+
+    /* the damage is in screen coordinate */
+    num = rtgui_region_num_rects(&win->damage->region);
+    damage = rtgui_region_rects(&win->damage->region);
+    for (index = 0; index < num; index ++)
+    {
+        rtgui_rect_t part = damage[index];
+
+        rtgui_rect_move(&part, -widget->extent.x1, -widget->extent.y1);
+        rtgui_rect_intersect(&rect, &part);
+        if (part.x1 < part.x2 && part.y1 < part.y2)
+            rtgui_dc_fill_rect(dc, &part);
+    }
+}
+RTM_EXPORT(rtgui_widget_fill_damage);
+
 rtgui_widget_t *rtgui_widget_get_next_sibling(rtgui_widget_t *widget)
 {
     rtgui_widget_t *sibling = RT_NULL;
@@ -816,3 +1061,77 @@ void rtgui_widget_dump(rtgui_widget_t *widget)
 }
 #endif
 
+#ifdef GUIENGIN_WIDGET_SELFTEST
+/*
+ * Add a child to a nested container of a shown window, the child must be
+ * clipped in the next clip update of the window.
+ */
+int rtgui_widget_selftest(void)
+{
+    int error = 0;
+    struct rtgui_win *win;
+    rtgui_container_t *outer, *box;
+    rtgui_widget_t *child;
+    rtgui_rect_t rect = {0, 0, 100, 100};
+    rtgui_rect_t child_rect = {10, 10, 30, 30};
+    rtgui_rect_t hit;
+
+    win = RTGUI_WIN(rtgui_widget_create(RTGUI_WIN_TYPE));
+    outer = rtgui_container_create();
+    box = rtgui_container_create();
+    child = rtgui_widget_create(RTGUI_WIDGET_TYPE);
+    if (win == RT_NULL || outer == RT_NULL || box == RT_NULL || child == RT_NULL)
+    {
+        rt_kprintf("widget selftest: out of memory\n");
+        if (child != RT_NULL) rtgui_widget_destroy(child);
+        if (box != RT_NULL) rtgui_widget_destroy(RTGUI_WIDGET(box));
+        if (outer != RT_NULL) rtgui_widget_destroy(RTGUI_WIDGET(outer));
+        if (win != RT_NULL) rtgui_widget_destroy(RTGUI_WIDGET(win));
+        return 1;
+    }
+
+    /* a shown window with the clip published by server */
+    win->outer_extent = rect;
+    rtgui_region_init_with_extents(&win->outer_clip, &rect);
+    rtgui_widget_set_rect(RTGUI_WIDGET(win), &rect);
+    RTGUI_WIDGET_UNHIDE(win);
+    RTGUI_WIDGET(win)->flag |= RTGUI_WIDGET_FLAG_SHOWN;
+    win->flag |= RTGUI_WIN_FLAG_CONNECTED;
+
+    rtgui_widget_set_rect(RTGUI_WIDGET(outer), &rect);
+    rtgui_widget_set_rect(RTGUI_WIDGET(box), &rect);
+    rtgui_container_add_child(RTGUI_CONTAINER(win), RTGUI_WIDGET(outer));
+    rtgui_container_add_child(outer, RTGUI_WIDGET(box));
+
+    rtgui_widget_set_rect(child, &child_rect);
+    rtgui_container_add_child(box, child);
+    if (child->clip_gen == 0 ||
+        rtgui_rect_is_equal(&child->extent_visiable, &child_rect) != RT_EOK ||
+        rtgui_rect_is_equal(&child->clip.extents, &child_rect) != RT_EOK)
+    {
+        rt_kprintf("widget selftest: the child added to a nested container is not clipped\n");
+        error ++;
+    }
+    /* the child covers a part of container */
+    if (rtgui_region_contains_point(&RTGUI_WIDGET(box)->clip, 15, 15, &hit) == RT_EOK ||
+        rtgui_region_contains_point(&RTGUI_WIDGET(box)->clip, 50, 50, &hit) != RT_EOK)
+    {
+        rt_kprintf("widget selftest: the container is not clipped by the child\n");
+        error ++;
+    }
+
+    /* closed as rtgui_win_destroy does, no request is sent to server */
+    win->flag &= ~RTGUI_WIN_FLAG_CONNECTED;
+    win->flag |= RTGUI_WIN_FLAG_CLOSED;
+    rtgui_widget_destroy(RTGUI_WIDGET(win));
+
+    rt_kprintf("widget selftest: %d failed\n", error);
+    return error;
+}
+RTM_EXPORT(rtgui_widget_selftest);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+FINSH_FUNCTION_EXPORT(rtgui_widget_selftest, check the clip update of widget tree);
+#endif
+#endif
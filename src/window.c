@@ -34,6 +34,7 @@
 static rt_bool_t _rtgui_win_deal_close(struct rtgui_win *win,
                                        struct rtgui_event *event,
                                        rt_bool_t force_close);
+static void _rtgui_win_sync_clip(struct rtgui_win *win);
 
 static void _rtgui_win_constructor(rtgui_win_t *win)
 {
@@ -43,6 +44,12 @@ static void _rtgui_win_constructor(rtgui_win_t *win)
     /* init win property */
     win->update = 0;
     win->drawing = 0;
+    /* the generation 0 is reserved for the dirty clip */
+    win->clip_gen = 1;
+    win->clip_pending = RT_NULL;
+    win->clip = RT_NULL;
+    win->damage_pending = RT_NULL;
+    win->damage = RT_NULL;
 
     RTGUI_WIDGET(win)->flag |= RTGUI_WIDGET_FLAG_FOCUSABLE;
     win->parent_window = RT_NULL;
@@ -105,31 +112,49 @@ static void _rtgui_win_destructor(rtgui_win_t *win)
         win->title = RT_NULL;
     }
     rtgui_region_fini(&win->outer_clip);
+    rtgui_region_snapshot_unref(rtgui_region_snapshot_exchange(&win->clip_pending, RT_NULL));
+    rtgui_region_snapshot_unref(win->clip);
+    win->clip = RT_NULL;
+    rtgui_region_snapshot_unref(rtgui_region_snapshot_exchange(&win->damage_pending, RT_NULL));
     /* release external clip info */
     win->drawing = 0;
 }
 
-static rt_bool_t _rtgui_win_create_in_server(struct rtgui_win *win)
+static rt_err_t _rtgui_win_post_create(struct rtgui_win *win, struct rtgui_future *future)
 {
-    if (!(win->flag & RTGUI_WIN_FLAG_CONNECTED))
+    struct rtgui_event_win_create ecreate;
+    RTGUI_EVENT_WIN_CREATE_INIT(&ecreate);
+
+    /* send win create event to server */
+    ecreate.parent_window = win->parent_window;
+    ecreate.wid           = win;
+    ecreate.parent.user   = win->style;
+
+    return rtgui_server_post_event_async(RTGUI_EVENT(&ecreate),
+                                         sizeof(struct rtgui_event_win_create),
+                                         future);
+}
+
+static rt_bool_t _rtgui_win_create_done(struct rtgui_win *win, struct rtgui_future *future)
+{
+    if (rtgui_future_wait(future) != RTGUI_STATUS_OK)
     {
-        struct rtgui_event_win_create ecreate;
-        RTGUI_EVENT_WIN_CREATE_INIT(&ecreate);
+        rt_kprintf("create win: %s failed\n", win->title);
+        return RT_FALSE;
+    }
 
-        /* send win create event to server */
-        ecreate.parent_window = win->parent_window;
-        ecreate.wid           = win;
-        ecreate.parent.user   = win->style;
+    win->flag |= RTGUI_WIN_FLAG_CONNECTED;
+    return RT_TRUE;
+}
 
-        if (rtgui_server_post_event_sync(RTGUI_EVENT(&ecreate),
-                                         sizeof(struct rtgui_event_win_create)
-                                        ) != RT_EOK)
-        {
-            rt_kprintf("create win: %s failed\n", win->title);
-            return RT_FALSE;
-        }
+static rt_bool_t _rtgui_win_create_in_server(struct rtgui_win *win)
+{
+    if (!(win->flag & RTGUI_WIN_FLAG_CONNECTED))
+    {
+        struct rtgui_future future;
 
-        win->flag |= RTGUI_WIN_FLAG_CONNECTED;
+        _rtgui_win_post_create(win, &future);
+        return _rtgui_win_create_done(win, &future);
     }
 
     return RT_TRUE;
@@ -387,8 +412,10 @@ RTM_EXPORT(rtgui_win_enter_modal);
 rt_base_t rtgui_win_do_show(struct rtgui_win *win)
 {
     rt_base_t exit_code = -1;
+    rt_bool_t connecting;
     struct rtgui_app *app;
     struct rtgui_event_win_show eshow;
+    struct rtgui_future fcreate, fshow;
 
     RTGUI_EVENT_WIN_SHOW_INIT(&eshow);
     eshow.wid = win;
@@ -399,23 +426,32 @@ rt_base_t rtgui_win_do_show(struct rtgui_win *win)
     win->flag &= ~RTGUI_WIN_FLAG_CLOSED;
     win->flag &= ~RTGUI_WIN_FLAG_CB_PRESSED;
 
-    /* if it does not register into server, create it in server */
-    if (!(win->flag & RTGUI_WIN_FLAG_CONNECTED))
-    {
-        if (_rtgui_win_create_in_server(win) == RT_FALSE)
-            return exit_code;
-    }
+    /* if it does not register into server, create it in server. The show
+     * request is queued behind it, so both take one round-trip. */
+    connecting = !(win->flag & RTGUI_WIN_FLAG_CONNECTED);
+    if (connecting)
+        _rtgui_win_post_create(win, &fcreate);
 
     /* set window unhidden before notify the server */
     rtgui_widget_show(RTGUI_WIDGET(win));
 
-    if (rtgui_server_post_event_sync(RTGUI_EVENT(&eshow),
-                                     sizeof(struct rtgui_event_win_show)) != RT_EOK)
+    rtgui_server_post_event_async(RTGUI_EVENT(&eshow),
+                                  sizeof(struct rtgui_event_win_show), &fshow);
+
+    if (connecting && _rtgui_win_create_done(win, &fcreate) == RT_FALSE)
+    {
+        rtgui_future_wait(&fshow);
+        rtgui_widget_hide(RTGUI_WIDGET(win));
+        return exit_code;
+    }
+
+    if (rtgui_future_wait(&fshow) != RTGUI_STATUS_OK)
     {
         /* It could not be shown if a parent window is hidden. */
         rtgui_widget_hide(RTGUI_WIDGET(win));
         return exit_code;
     }
+    _rtgui_win_sync_clip(win);
 
     if (win->focused_widget == RT_NULL)
         rtgui_widget_focus(RTGUI_WIDGET(win));
@@ -502,12 +538,18 @@ RTM_EXPORT(rtgui_win_hide);
 
 rt_err_t rtgui_win_activate(struct rtgui_win *win)
 {
+    rt_err_t result;
     struct rtgui_event_win_activate eact;
     RTGUI_EVENT_WIN_ACTIVATE_INIT(&eact);
     eact.wid = win;
 
-    return rtgui_server_post_event_sync(RTGUI_EVENT(&eact),
-                                        sizeof(eact));
+    result = rtgui_server_post_event_sync(RTGUI_EVENT(&eact),
+                                          sizeof(eact));
+    /* the window of other app takes the clip on its own thread */
+    if (result == RT_EOK && win->app == rtgui_app_self())
+        _rtgui_win_sync_clip(win);
+
+    return result;
 }
 RTM_EXPORT(rtgui_win_activate);
 
@@ -562,6 +604,7 @@ void rtgui_win_move(struct rtgui_win *win, int x, int y)
         {
             return;
         }
+        _rtgui_win_sync_clip(win);
     }
 
     rtgui_widget_show(RTGUI_WIDGET(win));
@@ -572,7 +615,6 @@ RTM_EXPORT(rtgui_win_move);
 static rt_bool_t rtgui_win_ondraw(struct rtgui_win *win)
 {
     struct rtgui_dc *dc;
-    struct rtgui_rect rect;
     struct rtgui_event_paint event;
 
     /* begin drawing */
@@ -580,10 +622,8 @@ static rt_bool_t rtgui_win_ondraw(struct rtgui_win *win)
     if (dc == RT_NULL)
         return RT_FALSE;
 
-    /* get window rect */
-    rtgui_widget_get_rect(RTGUI_WIDGET(win), &rect);
     /* fill area */
-    rtgui_dc_fill_rect(dc, &rect);
+    rtgui_widget_fill_damage(RTGUI_WIDGET(win), dc);
 
     /* widget drawing */
 
@@ -601,9 +641,6 @@ static rt_bool_t rtgui_win_ondraw(struct rtgui_win *win)
 
 void rtgui_win_update_clip(struct rtgui_win *win)
 {
-    struct rtgui_container *cnt;
-    struct rtgui_list_node *node;
-
     if (win == RT_NULL)
         return;
 
@@ -629,17 +666,44 @@ void rtgui_win_update_clip(struct rtgui_win *win)
         rtgui_region_copy(&RTGUI_WIDGET(win)->clip, &win->outer_clip);
     }
 
-    /* update the clip info of each child */
-    cnt = RTGUI_CONTAINER(win);
-    rtgui_list_foreach(node, &(cnt->children))
-    {
-        rtgui_widget_t *child = rtgui_list_entry(node, rtgui_widget_t, sibling);
+    /* update the clip info of the changed children */
+    rtgui_widget_clip_children(RTGUI_WIDGET(win));
 
-        rtgui_widget_update_clip(child);
-    }
+    rtgui_region_arena_reset();
 }
 RTM_EXPORT(rtgui_win_update_clip);
 
+/* take the latest clip published by server into outer_clip */
+static rt_bool_t _rtgui_win_adopt_clip(struct rtgui_win *win)
+{
+    struct rtgui_region_snapshot *snapshot;
+
+    snapshot = rtgui_region_snapshot_exchange(&win->clip_pending, RT_NULL);
+    /* already adopted on an earlier CLIP_INFO event */
+    if (snapshot == RT_NULL)
+        return RT_FALSE;
+
+    if (win->clip != RT_NULL && win->clip->version >= snapshot->version)
+    {
+        rtgui_region_snapshot_unref(snapshot);
+        return RT_FALSE;
+    }
+
+    rtgui_region_snapshot_unref(win->clip);
+    win->clip = snapshot;
+    rtgui_region_copy(&win->outer_clip, &snapshot->region);
+
+    return RT_TRUE;
+}
+
+/* the clip is published before the request is acked, take it at once
+ * rather than painting with the old one until CLIP_INFO is handled */
+static void _rtgui_win_sync_clip(struct rtgui_win *win)
+{
+    if (_rtgui_win_adopt_clip(win))
+        rtgui_win_update_clip(win);
+}
+
 static rt_bool_t _win_handle_mouse_btn(struct rtgui_win *win, struct rtgui_event *eve)
 {
     /* check whether has widget which handled mouse event before.
@@ -747,14 +811,36 @@ rt_bool_t rtgui_win_event_handler(struct rtgui_object *object, struct rtgui_even
 
     case RTGUI_EVENT_CLIP_INFO:
         /* update win clip */
-        rtgui_win_update_clip(win);
+        if (_rtgui_win_adopt_clip(win))
+            rtgui_win_update_clip(win);
         break;
 
     case RTGUI_EVENT_PAINT:
-        if (win->_title_wgt)
+    {
+        struct rtgui_region_snapshot *damage;
+
+        /* a whole window painting covers the pending damage too */
+        damage = rtgui_region_snapshot_exchange(&win->damage_pending, RT_NULL);
+        if (event->user & RTGUI_PAINT_DAMAGE)
+        {
+            /* painted on an earlier event */
+            if (damage == RT_NULL)
+                break;
+            win->damage = damage;
+        }
+        else
+        {
+            rtgui_region_snapshot_unref(damage);
+        }
+
+        if (win->_title_wgt && rtgui_widget_is_damaged(RTGUI_WIDGET(win->_title_wgt)))
             rtgui_widget_update(RTGUI_WIDGET(win->_title_wgt));
         rtgui_win_ondraw(win);
+
+        win->damage = RT_NULL;
+        rtgui_region_snapshot_unref(damage);
         break;
+    }
 
 #ifdef GUIENGIN_USING_VFRAMEBUFFER
     case RTGUI_EVENT_VPAINT_REQ:
@@ -980,6 +1066,9 @@ struct rtgui_dc *rtgui_win_get_drawing(rtgui_win_t * win)
         rtgui_region_fini(&region);
         rtgui_region_fini(&clip_region);
 
+        /* restore the clip published by server */
+        if (win->clip != RT_NULL)
+            rtgui_region_copy(&win->outer_clip, &win->clip->region);
         rtgui_win_update_clip(win);
     }
     else